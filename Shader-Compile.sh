@@ -34,18 +34,28 @@ echo " ---> Colour-Mandelbulb.vert"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Mandelbulb/Colour-Mandelbulb.vert -o ./Assets/Shaders/Mandelbulb/Colour-Mandelbulb.vert.sprv
 echo " ---> Colour-Mandelbulb.frag"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Mandelbulb/Colour-Mandelbulb.frag -o ./Assets/Shaders/Mandelbulb/Colour-Mandelbulb.frag.sprv
+echo " ---> Colour-Mandelbulb.frag (3D SDF shading)"
+./Third-Party/glslc/linux-x86_64/glslc -DFRACRENDER_SDF_3D_SHADING ./Source/Shaders/Mandelbulb/Colour-Mandelbulb.frag -o ./Assets/Shaders/Mandelbulb/Colour-Mandelbulb-SDF-3D.frag.sprv
 
 # Geometry, no SDF:
 echo " ---> Geometry-Mandelbulb.vert"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Mandelbulb/Geometry-Mandelbulb.vert -o ./Assets/Shaders/Mandelbulb/Geometry-Mandelbulb.vert.sprv
 echo " ---> Geometry-Mandelbulb.frag"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Mandelbulb/Geometry-Mandelbulb.frag -o ./Assets/Shaders/Mandelbulb/Geometry-Mandelbulb.frag.sprv
+echo " ---> Geometry-Mandelbulb.comp"
+./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Mandelbulb/Geometry-Mandelbulb.comp -o ./Assets/Shaders/Mandelbulb/Geometry-Mandelbulb.comp.sprv
 
 # Geometry, 3D SDF:
 echo " ---> Geometry-Mandelbulb-SDF-3D.vert"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Mandelbulb/Geometry-Mandelbulb-SDF-3D.vert -o ./Assets/Shaders/Mandelbulb/Geometry-Mandelbulb-SDF-3D.vert.sprv
 echo " ---> Geometry-Mandelbulb-SDF-3D.frag"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Mandelbulb/Geometry-Mandelbulb-SDF-3D.frag -o ./Assets/Shaders/Mandelbulb/Geometry-Mandelbulb-SDF-3D.frag.sprv
+echo " ---> Geometry-Mandelbulb-SDF-3D.frag (3D texture)"
+./Third-Party/glslc/linux-x86_64/glslc -DFRACRENDER_SDF_3D_TEXTURE ./Source/Shaders/Mandelbulb/Geometry-Mandelbulb-SDF-3D.frag -o ./Assets/Shaders/Mandelbulb/Geometry-Mandelbulb-SDF-3D-Texture.frag.sprv
+
+# 3D SDF calculation (compute):
+echo " ---> Bake-Mandelbulb-SDF-3D.comp"
+./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Mandelbulb/Bake-Mandelbulb-SDF-3D.comp -o ./Assets/Shaders/Mandelbulb/Bake-Mandelbulb-SDF-3D.comp.sprv
 
 # Geometry, Temporal Cache:
 echo " ---> Geometry-Mandelbulb-Temporal-Cache.vert"
@@ -72,12 +82,20 @@ echo " ---> Geometry-Hall-Of-Pillars.vert"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars.vert -o ./Assets/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars.vert.sprv
 echo " ---> Geometry-Hall-Of-Pillars.frag"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars.frag -o ./Assets/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars.frag.sprv
+echo " ---> Geometry-Hall-Of-Pillars.comp"
+./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars.comp -o ./Assets/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars.comp.sprv
 
 # Geometry, 3D SDF:
 echo " ---> Geometry-Hall-Of-Pillars-SDF-3D.vert"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars-SDF-3D.vert -o ./Assets/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars-SDF-3D.vert.sprv
 echo " ---> Geometry-Hall-Of-Pillars-SDF-3D.frag"
 ./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars-SDF-3D.frag -o ./Assets/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars-SDF-3D.frag.sprv
+echo " ---> Geometry-Hall-Of-Pillars-SDF-3D.frag (3D texture)"
+./Third-Party/glslc/linux-x86_64/glslc -DFRACRENDER_SDF_3D_TEXTURE ./Source/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars-SDF-3D.frag -o ./Assets/Shaders/Hall-Of-Pillars/Geometry-Hall-Of-Pillars-SDF-3D-Texture.frag.sprv
+
+# 3D SDF calculation (compute):
+echo " ---> Bake-Hall-Of-Pillars-SDF-3D.comp"
+./Third-Party/glslc/linux-x86_64/glslc ./Source/Shaders/Hall-Of-Pillars/Bake-Hall-Of-Pillars-SDF-3D.comp -o ./Assets/Shaders/Hall-Of-Pillars/Bake-Hall-Of-Pillars-SDF-3D.comp.sprv
 
 # Geometry, Temporal Cache:
 echo " ---> Geometry-Hall-Of-Pillars-Temporal-Cache.vert"
@@ -55,13 +55,9 @@ int main(int argc, char **argv)
 	// Run animation function once to get correct number of animation frames:
 	animation_update_function(&program_state);
 
-	// Initialize 3D SDF:
+	// 3D SDF is set up along with Vulkan, to fit in the device's memory:
 	FracRenderSDF3D sdf_3d;
-	set_up_sdf_3d(&program_state, &sdf_3d);
-
-	// Initialize scene UBO:
-	FracRenderVulkanSceneUniform scene_uniform;
-	set_up_scene_uniform(&program_state, &sdf_3d, &scene_uniform);
+	memset(&sdf_3d, 0, sizeof(FracRenderSDF3D));
 
 	// Declare Vulkan structs:
 	FracRenderVulkanBase base;
@@ -84,6 +80,10 @@ int main(int argc, char **argv)
 		return -1;
 	}
 
+	// Initialize scene UBO:
+	FracRenderVulkanSceneUniform scene_uniform;
+	set_up_scene_uniform(&program_state, &sdf_3d, &scene_uniform);
+
 	// Debug print functions:
 	#ifdef FRACRENDER_DEBUG
 		// Print iterations of the Mandelbrot set:
@@ -97,6 +97,45 @@ int main(int argc, char **argv)
 		//			pipeline, framebuffers, commands, performance);
 	#endif
 
+	// Recalculate 3D SDF in the background for the parameter animation:
+	FracRenderVulkanSDF3DRebake sdf_3d_rebake;
+	if (initialize_vulkan_sdf_3d_rebake(&device, &descriptors, &commands, &program_state,
+						&sdf_3d, &sdf_3d_rebake) != 0)
+	{
+		destroy_vulkan_sdf_3d_rebake(&device, &commands, &sdf_3d_rebake);
+		destroy_vulkan_structs(&base, &device, &swapchain, &descriptors, &pipeline,
+						&framebuffers, &commands, &performance);
+		destroy_sdf_3d(&sdf_3d);
+		return -1;
+	}
+
+	// Move 3D SDF clipmap cascades with the camera:
+	FracRenderVulkanSDF3DClipmap sdf_3d_clipmap;
+	if (initialize_vulkan_sdf_3d_clipmap(&device, &commands, &program_state, &sdf_3d,
+							&sdf_3d_clipmap) != 0)
+	{
+		destroy_vulkan_sdf_3d_clipmap(&device, &commands, &sdf_3d_clipmap);
+		destroy_vulkan_sdf_3d_rebake(&device, &commands, &sdf_3d_rebake);
+		destroy_vulkan_structs(&base, &device, &swapchain, &descriptors, &pipeline,
+						&framebuffers, &commands, &performance);
+		destroy_sdf_3d(&sdf_3d);
+		return -1;
+	}
+
+	// Refine a coarse 3D SDF in the background:
+	FracRenderVulkanSDF3DProgressive sdf_3d_progressive;
+	if (initialize_vulkan_sdf_3d_progressive(&device, &descriptors, &commands, &program_state,
+						&sdf_3d, &sdf_3d_progressive) != 0)
+	{
+		destroy_vulkan_sdf_3d_progressive(&device, &commands, &sdf_3d_progressive);
+		destroy_vulkan_sdf_3d_clipmap(&device, &commands, &sdf_3d_clipmap);
+		destroy_vulkan_sdf_3d_rebake(&device, &commands, &sdf_3d_rebake);
+		destroy_vulkan_structs(&base, &device, &swapchain, &descriptors, &pipeline,
+						&framebuffers, &commands, &performance);
+		destroy_sdf_3d(&sdf_3d);
+		return -1;
+	}
+
 	// 3D SDF buffer has been copied to GPU memory so destroy CPU structure:
 	if (program_state.optimize == 0) { destroy_sdf_3d(&sdf_3d); }
 
@@ -107,6 +146,9 @@ int main(int argc, char **argv)
 		performance_file = fopen(program_state.performance_file_name, "w");
 		if (!performance_file)
 		{
+			destroy_vulkan_sdf_3d_progressive(&device, &commands, &sdf_3d_progressive);
+			destroy_vulkan_sdf_3d_clipmap(&device, &commands, &sdf_3d_clipmap);
+			destroy_vulkan_sdf_3d_rebake(&device, &commands, &sdf_3d_rebake);
 			destroy_vulkan_structs(&base, &device, &swapchain, &descriptors, &pipeline,
 							&framebuffers, &commands, &performance);
 			return -1;
@@ -123,20 +165,23 @@ int main(int argc, char **argv)
 		}
 	}
 
-	// Set GLFW callback functions (no mouse movement for 2D Mandelbrot):
-	glfwSetKeyCallback(base.window, &glfw_callback_key_press);
-	if (program_state.fractal_type != -1)
+	if (base.window)
 	{
-		glfwSetCursorPosCallback(base.window, &glfw_callback_mouse_position);
-	}
+		// Set GLFW callback functions (no mouse movement for 2D Mandelbrot):
+		glfwSetKeyCallback(base.window, &glfw_callback_key_press);
+		if (program_state.fractal_type != -1)
+		{
+			glfwSetCursorPosCallback(base.window, &glfw_callback_mouse_position);
+		}
 
-	// Set GLFW user pointer to point to the program state:
-	glfwSetWindowUserPointer(base.window, &program_state);
+		// Set GLFW user pointer to point to the program state:
+		glfwSetWindowUserPointer(base.window, &program_state);
+	}
 
-	// Print title, optimization and fractal info, and keyboard controls:
+	// Print title, optimization and fractal info, and keyboard controls (if there's a window):
 	print_title();
 	print_fractal_and_optimization_type(&program_state);
-	print_controls();
+	if (base.window) { print_controls(); }
 
 	// Tracking swapchain and performance measurements:
 	int recreate_swapchain = -1;	// 0 = Yes, -1 = No.
@@ -164,6 +209,9 @@ int main(int argc, char **argv)
 			fprintf(stderr, "Error: Incompatible arguments. If performance"
 				" is set to 1, animation should not be off!\n");
 			fclose(performance_file);
+			destroy_vulkan_sdf_3d_progressive(&device, &commands, &sdf_3d_progressive);
+			destroy_vulkan_sdf_3d_clipmap(&device, &commands, &sdf_3d_clipmap);
+			destroy_vulkan_sdf_3d_rebake(&device, &commands, &sdf_3d_rebake);
 			destroy_vulkan_structs(&base, &device, &swapchain, &descriptors, &pipeline,
 							&framebuffers, &commands, &performance);
 			return -1;
@@ -181,14 +229,25 @@ int main(int argc, char **argv)
 			program_state.max_animation_frames, max_values);
 	}
 
-	// Main loop:
-	while(!glfwWindowShouldClose(base.window))
+	// Frames rendered so far, and the clock to time them by without a window:
+	uint64_t frames_rendered = 0;
+	if (!base.window) { program_state.last_update = get_headless_time(); }
+
+	// Main loop (steps until stopped, without a window):
+	while((!base.window) || (!glfwWindowShouldClose(base.window)))
 	{
-		// Get current time and deltaT, and poll GLFW events and movement keys:
-		program_state.current_update = glfwGetTime();
+		if (base.window)
+		{
+			// Get current time and deltaT, and poll GLFW events and movement keys:
+			program_state.current_update = glfwGetTime();
+			poll_movement_keys(base.window);
+			glfwPollEvents();
+		}
+		else
+		{
+			program_state.current_update = get_headless_time();
+		}
 		program_state.delta_t = program_state.current_update - program_state.last_update;
-		poll_movement_keys(base.window);
-		glfwPollEvents();
 
 		// Check recreate_swapchain flag:
 		if (recreate_swapchain == 0)
@@ -233,6 +292,11 @@ int main(int argc, char **argv)
 				// Update G-buffer descriptors:
 				update_vulkan_g_buffer_descriptors(&device,
 						&framebuffers, &descriptors);
+				if (pipeline.compute_geometry == 1)
+				{
+					update_g_buffer_storage_descriptor(&device,
+						&framebuffers, &descriptors);
+				}
 
 				if (program_state.optimize == 1)
 				{
@@ -258,6 +322,14 @@ int main(int argc, char **argv)
 			if (recreate_vulkan_g_buffer(&device, &swapchain,
 				&pipeline, &framebuffers, program_state.optimize) != 0) { break; }
 
+			// Recreate "render finished" semaphores, one per swapchain image:
+			if (recreate_render_finished_semaphores(&device, &swapchain,
+							&commands) != 0) { break; }
+
+			// Recreate pre-recorded command buffers, to be recorded again:
+			if (recreate_prerecorded_command_buffers(&device, &swapchain,
+							&commands) != 0) { break; }
+
 			// If extent changed, recreate pipelines:
 			if (changed_extent == 0)
 			{
@@ -268,27 +340,46 @@ int main(int argc, char **argv)
 			recreate_swapchain = -1;
 		}
 
-		// Get next swapchain image:
+		// Wait for the frame slot about to be reused, so its command buffer, semaphore and
+		// queries are free (other frames in flight carry on):
+		uint32_t frame_slot = commands.current_frame;
+		if (vkWaitForFences(device.logical_device, 1, &commands.fences[frame_slot],
+							VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to get frame slot %d!\n", frame_slot);
+			break;
+		}
+
+		// Get next swapchain image (offscreen images are used in turn):
 		uint32_t image_index = 0;
-		VkResult acquisition_result = vkAcquireNextImageKHR(
-			device.logical_device,
-			swapchain.swapchain,
-			UINT64_MAX,
-			commands.image_available,
-			VK_NULL_HANDLE,
-			&image_index
-		);
-
-		// See if swapchain needs recreating:
-		if ((acquisition_result == VK_SUBOPTIMAL_KHR) ||
-			(acquisition_result == VK_ERROR_OUT_OF_DATE_KHR))
+		VkResult acquisition_result = VK_SUCCESS;
+		if (swapchain.headless == 1)
+		{
+			image_index = frames_rendered % swapchain.num_swapchain_images;
+		}
+		else
+		{
+			acquisition_result = vkAcquireNextImageKHR(
+				device.logical_device,
+				swapchain.swapchain,
+				UINT64_MAX,
+				commands.image_available[frame_slot],
+				VK_NULL_HANDLE,
+				&image_index
+			);
+		}
+
+		// See if swapchain needs recreating. A suboptimal image was still acquired, and
+		// signals the frame slot's semaphore, so it is drawn and presented first:
+		if (acquisition_result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
 			recreate_swapchain = 0;
 			continue;
 		}
+		else if (acquisition_result == VK_SUBOPTIMAL_KHR) { recreate_swapchain = 0; }
 
 		// See if next image was acquired:
-		if (acquisition_result != VK_SUCCESS)
+		else if (acquisition_result != VK_SUCCESS)
 		{
 			fprintf(stderr, "Error: Unable to get next swapchain image!\n");
 			break;
@@ -297,37 +388,57 @@ int main(int argc, char **argv)
 		// Update scene uniform:
 		update_scene_uniform(&base, &device, &swapchain, &scene_uniform, &program_state);
 
-		// Wait for a command buffer to be available:
-		if (vkWaitForFences(device.logical_device, 1, &commands.fences[image_index],
-							VK_TRUE, UINT64_MAX) != VK_SUCCESS)
-		{
-			fprintf(stderr, "Error: Unable to get command buffer %d!\n", image_index);
-			break;
-		}
-
-		// Reset fence:
+		// Reset fence (only once the frame is sure to be submitted):
 		if (vkResetFences(device.logical_device, 1,
-			&commands.fences[image_index]) != VK_SUCCESS)
+			&commands.fences[frame_slot]) != VK_SUCCESS)
 		{
-			fprintf(stderr, "Error: Unable to reset fence %d!\n", image_index);
+			fprintf(stderr, "Error: Unable to reset fence %d!\n", frame_slot);
 			break;
 		}
 
-		// Record commands:
-		if (record_commands(&swapchain, &descriptors, &pipeline, &framebuffers, &commands,
-			&performance, &scene_uniform, &program_state, image_index) != 0) { break; }
+		// Write scene uniform into the frame slot's slice of the ring:
+		write_scene_uniform(&descriptors, &scene_uniform, frame_slot);
+
+		// Record commands (pre-recorded ones only when something they use has changed):
+		if (prepare_commands(&swapchain, &descriptors, &pipeline, &framebuffers, &commands,
+			&performance, &program_state, frame_slot, image_index) != 0) { break; }
 
-		// Submit commands:
-		if (submit_commands(&device, &commands, image_index) != 0) { break; }
+		// Submit commands, and move on to the next frame slot:
+		if (submit_commands(&device, &swapchain, &commands, frame_slot,
+							image_index) != 0) { break; }
+		commands.current_frame = (frame_slot + 1) % commands.num_frames_in_flight;
 
-		// Present results. Return value of 1 means swapchain needs recreating:
-		int present_result = present_results(&device, &swapchain, &commands, image_index);
-		if (present_result == -1) { break; }
-		else if (present_result == 1) { recreate_swapchain = 0; }
+		if (swapchain.headless == 1)
+		{
+			// Dump every Nth frame instead of presenting it:
+			if ((program_state.dump_frames > 0) &&
+				((frames_rendered % program_state.dump_frames) == 0))
+			{
+				if (dump_headless_image(&device, &swapchain, &commands, frame_slot,
+					image_index, frames_rendered) != 0) { break; }
+			}
+		}
+		else
+		{
+			// Present results. Return value of 1 means swapchain needs recreating:
+			int present_result = present_results(&device, &swapchain, &commands,
+									image_index);
+			if (present_result == -1) { break; }
+			else if (present_result == 1) { recreate_swapchain = 0; }
+		}
+		frames_rendered++;
 
 		// Update the time:
 		program_state.last_update = program_state.current_update;
 
+		// Calculate voxels the camera has brought into view, and show them when ready:
+		if (update_vulkan_sdf_3d_clipmap(&device, &descriptors, &program_state,
+						&scene_uniform, &sdf_3d_clipmap) != 0) { break; }
+
+		// Swap in the next level of a coarse 3D SDF when it is ready:
+		if (update_vulkan_sdf_3d_progressive(&device, &descriptors, &scene_uniform,
+							&sdf_3d_progressive) != 0) { break; }
+
 		/****************************
 		 * PERFORMANCE MEASUREMENTS *
 		 ****************************/
@@ -343,11 +454,15 @@ int main(int argc, char **argv)
 			animation_update_function(&program_state);
 			program_state.animation_frames++;
 
+			// Swap in the 3D SDF for the new parameter when it is ready:
+			if (update_vulkan_sdf_3d_rebake(&device, &descriptors, &program_state,
+							&sdf_3d_rebake) != 0) { break; }
+
 			// Get geometry render pass execution time:
 			if (program_state.performance == 1)
 			{
 				get_shader_time(multi_shader_time[values_captured],
-					program_state.animation_frames, image_index,
+					program_state.animation_frames, frame_slot,
 					1, &device, &performance);
 			}
 
@@ -381,7 +496,7 @@ int main(int argc, char **argv)
 		if ((program_state.performance == 0) && (warm_up > 1000))
 		{
 			get_shader_time(shader_time, (100 * values_captured) +
-				program_state.frames, image_index, 0, &device, &performance);
+				program_state.frames, frame_slot, 0, &device, &performance);
 		}
 
 		// Get frame rate and change window title:
@@ -391,14 +506,18 @@ int main(int argc, char **argv)
 			program_state.frame_time /= 100.0;
 			double frame_rate = 1.0 / program_state.frame_time;
 
-			// Change window title to display frame rate:
+			// Change window title to display frame rate (printed without a window):
 			char window_title[32];
 			if (sprintf(window_title, "Fractal Renderer - %.2lf", frame_rate) < 0)
 			{
 				fprintf(stderr, "Error: Failed to change window title!\n");
 				break;
 			}
-			glfwSetWindowTitle(base.window, window_title);
+			if (base.window) { glfwSetWindowTitle(base.window, window_title); }
+			else if (program_state.performance == -1)
+			{
+				printf("Frame rate: %.2lf\n", frame_rate);
+			}
 
 			// Write out performance measurements:
 			if ((program_state.performance == 0) && (warm_up > 1000))
@@ -445,11 +564,24 @@ int main(int argc, char **argv)
 				warm_up++;
 			}
 		}
+
+		// Stop once enough frames have been rendered:
+		if ((program_state.max_frames > 0) &&
+			(frames_rendered >= (uint64_t)program_state.max_frames))
+		{
+			printf("\nRendered %lu frames.\n\n", frames_rendered);
+			break;
+		}
 	}
 
 	// Wait for Vulkan commands to finish:
 	vkDeviceWaitIdle(device.logical_device);
 
+	// Stop recalculating 3D SDF:
+	destroy_vulkan_sdf_3d_progressive(&device, &commands, &sdf_3d_progressive);
+	destroy_vulkan_sdf_3d_clipmap(&device, &commands, &sdf_3d_clipmap);
+	destroy_vulkan_sdf_3d_rebake(&device, &commands, &sdf_3d_rebake);
+
 	// Destroy Vulkan structs:
 	destroy_vulkan_structs(&base, &device, &swapchain, &descriptors, &pipeline, &framebuffers,
 									&commands, &performance);
@@ -0,0 +1,229 @@
+#include "SDF-3D-Bricks.h"
+
+// Calculate brick pool 3D SDF:
+int create_sdf_3d_bricks(FracRenderSDF3D *sdf_3d)
+{
+	if ((sdf_3d->levels <= FRACRENDER_SDF_3D_BRICK_LEVELS) || (sdf_3d->levels > 10))
+	{
+		fprintf(stderr, "Error: Brick pool 3D SDF needs 4 to 10 levels!\n");
+		return -1;
+	}
+
+	// Split the cells into groups. Each task walks down the cube at the split level:
+	FracRenderSDF3DBrickBuild build;
+	build.sdf_3d		= sdf_3d;
+	build.cell_level	= sdf_3d->levels - FRACRENDER_SDF_3D_BRICK_LEVELS;
+	build.num_cells		= pow(8, build.cell_level);
+	build.split_level	= 3;
+	if (build.split_level >= build.cell_level) { build.split_level = build.cell_level - 1; }
+	build.num_tasks		= pow(8, build.split_level);
+	build.tasks_completed	= 0;
+
+	build.cells = malloc((size_t)build.num_cells * sizeof(uint32_t));
+	build.task_bricks = calloc(build.num_tasks, sizeof(uint32_t));
+	if ((!build.cells) || (!build.task_bricks))
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for brick pool 3D SDF cells!\n");
+		free(build.cells);
+		free(build.task_bricks);
+		return -1;
+	}
+
+	printf(" ---> Calculating distance values (brick pool).\n");
+	printf("      - Threads: %d.\n", sdf_3d->num_threads);
+	printf("      - Instruction set: %s.\n",
+		get_sdf_3d_instruction_set_name(sdf_3d->instruction_set));
+	printf("      - Cells: %u (%u voxels each).\n", build.num_cells,
+					1u << (3 * FRACRENDER_SDF_3D_BRICK_LEVELS));
+
+	struct timespec start_time;
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	// Find the cells which need a brick:
+	int result = run_work_pool(sdf_3d->num_threads, build.num_tasks,
+					find_sdf_3d_bricks_task, &build);
+
+	// Each group's bricks follow the last group's:
+	size_t num_bricks = 0;
+	for (uint32_t i = 0; i < build.num_tasks; i++)
+	{
+		uint32_t task_bricks = build.task_bricks[i];
+		build.task_bricks[i] = num_bricks;
+		num_bricks += task_bricks;
+	}
+
+	size_t memory_required = ((size_t)build.num_cells + (num_bricks * 512)) * sizeof(uint32_t);
+	if ((result == 0) && (memory_required > sdf_3d->memory_budget))
+	{
+		fprintf(stderr, "Error: Brick pool 3D SDF tried to allocate more than the memory"
+			" budget (%lu MB)!\n", sdf_3d->memory_budget / (1024 * 1024));
+		result = -1;
+	}
+
+	if (result == 0)
+	{
+		sdf_3d->num_node_entries = memory_required / sizeof(uint32_t);
+		sdf_3d->nodes = malloc(memory_required);
+		if (!sdf_3d->nodes)
+		{
+			fprintf(stderr, "Error: Unable to allocate memory for 3D SDF bricks!\n");
+			result = -1;
+		}
+	}
+
+	// Calculate the bricks:
+	if (result == 0)
+	{
+		printf("      - Bricks: %lu (%.1lf%% of cells).\n", num_bricks,
+				100.0 * (double)num_bricks / (double)build.num_cells);
+		printf("      --->   0.0%%.\n");
+
+		result = run_work_pool(sdf_3d->num_threads, build.num_tasks,
+						fill_sdf_3d_bricks_task, &build);
+	}
+
+	free(build.cells);
+	free(build.task_bricks);
+
+	if (result != 0) { return -1; }
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	double seconds = (double)(end_time.tv_sec - start_time.tv_sec) +
+			((double)(end_time.tv_nsec - start_time.tv_nsec) / 1000000000.0);
+
+	double dense_memory = pow(8, sdf_3d->levels) * sizeof(float);
+	printf("      - Time taken: %.3lf seconds.\n", seconds);
+	printf("      - Memory used: %lu bytes (%lu MB).\n", memory_required,
+						memory_required / (1024 * 1024));
+	printf("      - Dense SDF would use: %.0lf MB (%.1lfx more).\n",
+		dense_memory / (1024 * 1024), dense_memory / (double)memory_required);
+
+	return 0;
+}
+
+// Find the cells of one group the surface may pass through, and count them (work pool task):
+int find_sdf_3d_bricks_task(void *build_data, uint32_t task_index)
+{
+	FracRenderSDF3DBrickBuild *build = build_data;
+
+	// Walk down to the group's cube:
+	float size;
+	FracRenderVector3 centre;
+	get_sdf_3d_cube(build->sdf_3d, build->split_level, task_index, &size, &centre);
+
+	uint32_t num_bricks = 0;
+	find_sdf_3d_brick_cells(build, build->split_level, task_index, size, centre, &num_bricks);
+	build->task_bricks[task_index] = num_bricks;
+
+	return 0;
+}
+
+// Walk down a cube (size is half the cube's length) to the cells, filling in their entries:
+void find_sdf_3d_brick_cells(FracRenderSDF3DBrickBuild *build, uint32_t level, uint32_t code,
+				float size, FracRenderVector3 centre, uint32_t *num_bricks)
+{
+	FracRenderSDF3D *sdf_3d = build->sdf_3d;
+
+	FracRenderVector3x8 positions;
+	get_sdf_3d_sub_cube_centres(size / 2.f, centre, &positions);
+
+	// Above the cells, every sub-cube is walked down, as its cells are all indexed:
+	if ((level + 1) < build->cell_level)
+	{
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			FracRenderVector3 sub_centre = initialize_vector_3(positions.x[i],
+							positions.y[i], positions.z[i]);
+			find_sdf_3d_brick_cells(build, level + 1, (code * 8) + i, size / 2.f,
+								sub_centre, num_bricks);
+		}
+		return;
+	}
+
+	// Sub-cubes are the cells:
+	float distances[8];
+	sdf_3d->batch_distance_function(&positions, sdf_3d->parameter, distances);
+
+	float half_diagonal = sqrt(3.f) * (size / 2.f);
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		float distance_estimate = distances[i];
+
+		// Only outside, as estimates inside the fractal don't bound the distance (as in
+		// create_sdf_3d_sparse_node):
+		if (distance_estimate > half_diagonal)
+		{
+			// To guarantee underestimate, take away half length of diagonal of cell:
+			build->cells[(code * 8) + i] =
+				encode_sdf_3d_sparse_leaf(distance_estimate - half_diagonal);
+		}
+		else
+		{
+			build->cells[(code * 8) + i] = 1;
+			(*num_bricks)++;
+		}
+	}
+}
+
+// Calculate the bricks of one group, in order (work pool task):
+int fill_sdf_3d_bricks_task(void *build_data, uint32_t task_index)
+{
+	FracRenderSDF3DBrickBuild *build = build_data;
+	FracRenderSDF3D *sdf_3d = build->sdf_3d;
+
+	// Cells of the group are consecutive in Morton order:
+	uint32_t cells_per_task = build->num_cells / build->num_tasks;
+	uint32_t first_cell = task_index * cells_per_task;
+	uint32_t brick = build->task_bricks[task_index];
+	uint32_t *voxels = &sdf_3d->nodes[build->num_cells];
+
+	for (uint32_t cell = first_cell; cell < (first_cell + cells_per_task); cell++)
+	{
+		uint32_t entry = build->cells[cell];
+		if (entry & 1)
+		{
+			float size;
+			FracRenderVector3 centre;
+			get_sdf_3d_cube(sdf_3d, build->cell_level, cell, &size, &centre);
+			fill_sdf_3d_brick(sdf_3d, size, centre, &voxels[(size_t)brick * 512]);
+
+			entry = encode_sdf_3d_sparse_node(brick);
+			brick++;
+		}
+
+		sdf_3d->nodes[cell] = entry;
+	}
+
+	print_sdf_3d_progress(&build->tasks_completed, build->num_tasks);
+
+	return 0;
+}
+
+// Calculate the 512 voxels of a brick (size is half the cell's length):
+void fill_sdf_3d_brick(FracRenderSDF3D *sdf_3d, float size, FracRenderVector3 centre,
+								uint32_t *voxels)
+{
+	// Two levels of sub-cubes, then the voxels, all in Morton order. Voxels are stored as they
+	// are in the dense layout:
+	FracRenderVector3x8 positions;
+	get_sdf_3d_sub_cube_centres(size / 2.f, centre, &positions);
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		FracRenderVector3x8 sub_positions;
+		FracRenderVector3 sub_centre = initialize_vector_3(positions.x[i], positions.y[i],
+								positions.z[i]);
+		get_sdf_3d_sub_cube_centres(size / 4.f, sub_centre, &sub_positions);
+
+		for (uint32_t j = 0; j < 8; j++)
+		{
+			float leaves[8];
+			FracRenderVector3 leaf_centre = initialize_vector_3(sub_positions.x[j],
+						sub_positions.y[j], sub_positions.z[j]);
+			create_sdf_3d_leaves(sdf_3d, size / 8.f, leaf_centre, leaves);
+
+			memcpy(&voxels[(i * 64) + (j * 8)], leaves, sizeof(leaves));
+		}
+	}
+}
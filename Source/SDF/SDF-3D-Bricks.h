@@ -0,0 +1,83 @@
+#ifndef FRACRENDER_SDF_3D_BRICKS_H
+#define FRACRENDER_SDF_3D_BRICKS_H
+
+/******************************************************************************************
+ * Brick pool 3D SDF, with full resolution voxels only where the surface may pass through *
+ *****************************************************************************************/
+
+// Library includes:
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local includes:
+#include "../Utility/Vectors.h"
+#include "../Utility/Work-Pool.h"
+#include "SDF-3D.h"
+#include "SDF-3D-Sparse.h"
+
+/*
+ * The cube is split into cells of 8x8x8 voxels (3 levels above max resolution). Layout of the
+ * buffer (read as uint by the SDF shaders):
+ * - One entry per cell, indexed by the cell's Morton code (the voxel's Morton code >> 9).
+ * - Entry with lowest bit set: (index of brick << 1) | 1. The brick's 512 voxel distances
+ *   follow the cells, as float bits, at cells + (brick * 512) + (voxel's Morton code & 511).
+ * - Entry with lowest bit clear: distance for the whole cell, as for sparse octree leaves.
+ *
+ * Cells get a brick if the surface may pass through them, so memory follows the surface area
+ * and the fractal's inside instead of the whole volume, and the whole cell can be stepped over
+ * anywhere else. Estimates inside the fractal don't bound the distance, so every cell there
+ * gets a brick.
+ */
+
+// Levels of voxels in each brick (8x8x8):
+#define FRACRENDER_SDF_3D_BRICK_LEVELS 3
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// SDF being calculated:
+	FracRenderSDF3D *sdf_3d;
+
+	// Level of the cells, and their entries while the bricks are counted (1 = Needs a brick):
+	uint32_t cell_level;
+	uint32_t num_cells;
+	uint32_t *cells;
+
+	// Level at which the cells are split into independent groups (one per task), and the
+	// bricks counted in each group, then the index of each group's first brick:
+	uint32_t split_level;
+	uint32_t num_tasks;
+	uint32_t *task_bricks;
+
+	// Progress:
+	uint32_t tasks_completed;
+} FracRenderSDF3DBrickBuild;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Calculate brick pool 3D SDF:
+int create_sdf_3d_bricks(FracRenderSDF3D *sdf_3d);
+
+// Find the cells of one group the surface may pass through, and count them (work pool task):
+int find_sdf_3d_bricks_task(void *build_data, uint32_t task_index);
+
+// Walk down a cube (size is half the cube's length) to the cells, filling in their entries:
+void find_sdf_3d_brick_cells(FracRenderSDF3DBrickBuild *build, uint32_t level, uint32_t code,
+				float size, FracRenderVector3 centre, uint32_t *num_bricks);
+
+// Calculate the bricks of one group, in order (work pool task):
+int fill_sdf_3d_bricks_task(void *build_data, uint32_t task_index);
+
+// Calculate the 512 voxels of a brick (size is half the cell's length):
+void fill_sdf_3d_brick(FracRenderSDF3D *sdf_3d, float size, FracRenderVector3 centre,
+								uint32_t *voxels);
+
+#endif
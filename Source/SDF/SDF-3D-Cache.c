@@ -0,0 +1,225 @@
+#include "SDF-3D-Cache.h"
+
+// Try to load 3D SDF from the cache (0 = loaded, -1 = not in cache):
+int load_sdf_3d_cache(FracRenderSDF3D *sdf_3d)
+{
+	char file_name[256];
+	get_sdf_3d_cache_file_name(sdf_3d, file_name, 256);
+
+	// No file means it hasn't been calculated before:
+	int file = open(file_name, O_RDONLY);
+	if (file < 0) { return -1; }
+
+	printf("----------------------------------------");
+	printf("----------------------------------------\n");
+	printf("Loading 3D SDF from cache...\n");
+	printf(" ---> File: %s.\n", file_name);
+
+	struct stat file_info;
+	if ((fstat(file, &file_info) != 0) ||
+		((size_t)file_info.st_size <= sizeof(FracRenderSDF3DCacheHeader)))
+	{
+		close(file);
+		printf("Warning: 3D SDF cache file is too small. Recalculating.\n\n");
+		return -1;
+	}
+
+	// Map the whole file. The data is read straight from the page cache when uploading:
+	size_t mapping_size = file_info.st_size;
+	void *mapping = mmap(NULL, mapping_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (mapping == MAP_FAILED)
+	{
+		printf("Warning: Unable to map 3D SDF cache file. Recalculating.\n\n");
+		return -1;
+	}
+
+	// Check the header describes this SDF:
+	const FracRenderSDF3DCacheHeader *header = mapping;
+	FracRenderSDF3DCacheHeader expected;
+	get_sdf_3d_cache_header(sdf_3d, &expected);
+
+	size_t data_size = mapping_size - sizeof(FracRenderSDF3DCacheHeader);
+	const char *data = (const char *)mapping + sizeof(FracRenderSDF3DCacheHeader);
+
+	size_t expected_size;
+	if ((sdf_3d->layout == 1) || (sdf_3d->layout == 3))
+	{
+		expected_size = (size_t)header->num_node_entries * 4;
+	}
+	else { expected_size = get_sdf_3d_data_size(sdf_3d); }
+
+	if ((memcmp(header, &expected, offsetof(FracRenderSDF3DCacheHeader, num_voxels)) != 0) ||
+		(header->num_voxels != sdf_3d->num_voxels) ||
+		(header->data_size != data_size) || (data_size != expected_size))
+	{
+		munmap(mapping, mapping_size);
+		printf("Warning: 3D SDF cache file doesn't match. Recalculating.\n\n");
+		return -1;
+	}
+
+	if (get_sdf_3d_cache_hash(data, data_size) != header->hash)
+	{
+		munmap(mapping, mapping_size);
+		printf("Warning: 3D SDF cache file is corrupted. Recalculating.\n\n");
+		return -1;
+	}
+
+	// Use the mapped data in place of calculated voxels or nodes:
+	sdf_3d->cache_mapping		= mapping;
+	sdf_3d->cache_mapping_size	= mapping_size;
+	if ((sdf_3d->layout == 1) || (sdf_3d->layout == 3))
+	{
+		sdf_3d->num_node_entries	= header->num_node_entries;
+		sdf_3d->nodes			= (uint32_t *)data;
+	}
+	else { sdf_3d->voxels = (void *)data; }
+
+	printf("      - Memory mapped: %lu bytes (%lu MB).\n", data_size,
+						data_size / (1024 * 1024));
+
+	printf("... Done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Save calculated 3D SDF to the cache:
+int save_sdf_3d_cache(FracRenderSDF3D *sdf_3d)
+{
+	char file_name[256];
+	char temporary_name[264];
+	get_sdf_3d_cache_file_name(sdf_3d, file_name, 256);
+	snprintf(temporary_name, 264, "%s.tmp", file_name);
+
+	printf("----------------------------------------");
+	printf("----------------------------------------\n");
+	printf("Saving 3D SDF to cache...\n");
+	printf(" ---> File: %s.\n", file_name);
+
+	if ((mkdir(FRACRENDER_SDF_3D_CACHE_DIRECTORY, 0755) != 0) && (errno != EEXIST))
+	{
+		fprintf(stderr, "Error: Unable to create directory for 3D SDF cache!\n");
+		return -1;
+	}
+
+	FracRenderSDF3DCacheHeader header;
+	get_sdf_3d_cache_header(sdf_3d, &header);
+	const void *data	= get_sdf_3d_data(sdf_3d);
+	header.data_size	= get_sdf_3d_data_size(sdf_3d);
+	header.hash		= get_sdf_3d_cache_hash(data, header.data_size);
+
+	// Write to a temporary file and rename it, so a half-written file is never loaded:
+	FILE *file = fopen(temporary_name, "wb");
+	if (!file)
+	{
+		fprintf(stderr, "Error: Unable to open 3D SDF cache file for writing!\n");
+		return -1;
+	}
+
+	int result = 0;
+	if ((fwrite(&header, sizeof(FracRenderSDF3DCacheHeader), 1, file) != 1) ||
+		(fwrite(data, 1, header.data_size, file) != header.data_size))
+	{
+		result = -1;
+	}
+	if (fclose(file) != 0) { result = -1; }
+
+	if ((result != 0) || (rename(temporary_name, file_name) != 0))
+	{
+		remove(temporary_name);
+		fprintf(stderr, "Error: Unable to write 3D SDF cache file!\n");
+		return -1;
+	}
+
+	printf("      - Written: %lu bytes (%lu MB).\n", header.data_size,
+					header.data_size / (1024 * 1024));
+
+	printf("... Done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Fill in the header describing a 3D SDF:
+void get_sdf_3d_cache_header(FracRenderSDF3D *sdf_3d, FracRenderSDF3DCacheHeader *header)
+{
+	memset(header, 0, sizeof(FracRenderSDF3DCacheHeader));
+	memcpy(header->magic, "FRSDF3D", 8);
+	header->version		= FRACRENDER_SDF_3D_CACHE_VERSION;
+
+	header->fractal_type	= sdf_3d->fractal_type;
+	header->levels		= sdf_3d->levels;
+	header->layout		= sdf_3d->layout;
+	header->format		= sdf_3d->format;
+	header->cull		= sdf_3d->cull;
+	header->transform	= sdf_3d->transform;
+	header->symmetry	= sdf_3d->symmetry;
+	header->shading		= sdf_3d->shading;
+	header->size		= sdf_3d->size;
+	header->centre[0]	= sdf_3d->centre.x;
+	header->centre[1]	= sdf_3d->centre.y;
+	header->centre[2]	= sdf_3d->centre.z;
+
+	header->parameter	= sdf_3d->parameter;
+
+	header->num_voxels		= sdf_3d->num_voxels;
+	header->num_node_entries	= sdf_3d->num_node_entries;
+}
+
+// Get file name of the cache for a 3D SDF:
+void get_sdf_3d_cache_file_name(FracRenderSDF3D *sdf_3d, char *file_name, size_t length)
+{
+	// Readable part, then a hash of the whole description (the centre can be anywhere):
+	FracRenderSDF3DCacheHeader header;
+	get_sdf_3d_cache_header(sdf_3d, &header);
+	uint64_t description_hash = get_sdf_3d_cache_hash(&header,
+				offsetof(FracRenderSDF3DCacheHeader, num_voxels));
+
+	const char *fractal_name = "Mandelbulb";
+	if (sdf_3d->fractal_type == 1) { fractal_name = "Hall-Of-Pillars"; }
+	const char *layout_name = "Dense";
+	if (sdf_3d->layout == 1) { layout_name = "Sparse"; }
+	else if (sdf_3d->layout == 3) { layout_name = "Bricks"; }
+	else if (sdf_3d->symmetry > 0) { layout_name = "Folded"; }
+
+	snprintf(file_name, length, "%s/%s-%u-%s-%d-%016llx.sdf",
+		FRACRENDER_SDF_3D_CACHE_DIRECTORY, fractal_name, sdf_3d->levels, layout_name,
+		sdf_3d->format, (unsigned long long)description_hash);
+}
+
+// Hash of the data (64-bit FNV-1a, 8 bytes at a time):
+uint64_t get_sdf_3d_cache_hash(const void *data, size_t size)
+{
+	const unsigned char *bytes = data;
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	// Whole words, then any bytes left over:
+	size_t i = 0;
+	for (; (i + 8) <= size; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, &bytes[i], 8);
+		hash ^= word;
+		hash *= 0x100000001b3ull;
+	}
+	for (; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+// Unmap a loaded cache file:
+void unmap_sdf_3d_cache(FracRenderSDF3D *sdf_3d)
+{
+	munmap(sdf_3d->cache_mapping, sdf_3d->cache_mapping_size);
+	sdf_3d->cache_mapping		= NULL;
+	sdf_3d->cache_mapping_size	= 0;
+	sdf_3d->voxels			= NULL;
+	sdf_3d->nodes			= NULL;
+}
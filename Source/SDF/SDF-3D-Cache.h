@@ -0,0 +1,86 @@
+#ifndef FRACRENDER_SDF_3D_CACHE_H
+#define FRACRENDER_SDF_3D_CACHE_H
+
+/**********************************************************************
+ * On-disk cache of calculated 3D SDFs, memory-mapped on the next run *
+ **********************************************************************/
+
+// Library includes:
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Local includes:
+#include "SDF-3D.h"
+
+/*
+ * File layout: one FracRenderSDF3DCacheHeader, then the data exactly as uploaded to the GPU
+ * (see get_sdf_3d_data). A file is only used if every field of its header matches the SDF being
+ * set up and the hash of the data is correct. Bump the version whenever the layout of the data
+ * or the distance estimators change, so old files are recalculated.
+ */
+
+#define FRACRENDER_SDF_3D_CACHE_DIRECTORY "./SDF-Cache"
+#define FRACRENDER_SDF_3D_CACHE_VERSION 10
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// File identification:
+	char magic[8];
+	uint32_t version;
+
+	// SDF description:
+	int32_t fractal_type;
+	uint32_t levels;
+	int32_t layout;
+	int32_t format;
+	int32_t cull;
+	int32_t transform;
+	uint32_t symmetry;
+	int32_t shading;
+	float size;
+	float centre[3];
+
+	// Distance estimator parameter (power for Mandelbulb, fold scale for Hall of Pillars):
+	float parameter;
+
+	// Data (voxels, octree nodes, or cells and bricks):
+	uint32_t num_voxels;
+	uint32_t num_node_entries;
+	uint64_t data_size;
+	uint64_t hash;
+} FracRenderSDF3DCacheHeader;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Try to load 3D SDF from the cache (0 = loaded, -1 = not in cache):
+int load_sdf_3d_cache(FracRenderSDF3D *sdf_3d);
+
+// Save calculated 3D SDF to the cache:
+int save_sdf_3d_cache(FracRenderSDF3D *sdf_3d);
+
+// Fill in the header describing a 3D SDF:
+void get_sdf_3d_cache_header(FracRenderSDF3D *sdf_3d, FracRenderSDF3DCacheHeader *header);
+
+// Get file name of the cache for a 3D SDF:
+void get_sdf_3d_cache_file_name(FracRenderSDF3D *sdf_3d, char *file_name, size_t length);
+
+// Hash of the data (64-bit FNV-1a, 8 bytes at a time):
+uint64_t get_sdf_3d_cache_hash(const void *data, size_t size);
+
+// Unmap a loaded cache file:
+void unmap_sdf_3d_cache(FracRenderSDF3D *sdf_3d);
+
+#endif
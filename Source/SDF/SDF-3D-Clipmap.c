@@ -0,0 +1,374 @@
+#include "SDF-3D-Clipmap.h"
+
+// Calculate all clipmap cascades, centred on the SDF centre:
+int create_sdf_3d_clipmap(FracRenderSDF3D *sdf_3d)
+{
+	if ((sdf_3d->levels < 1) || (sdf_3d->num_cascades < 1))
+	{
+		fprintf(stderr, "Error: 3D SDF clipmap needs at least 1 level and 1 cascade!\n");
+		return -1;
+	}
+
+	// Allocate memory for all cascades:
+	printf(" ---> Allocating memory.\n");
+	size_t memory_required = (size_t)sdf_3d->num_voxels * sizeof(float);
+	sdf_3d->voxels = malloc(memory_required);
+	printf("      - Cascades: %d of %d^3 voxels.\n", sdf_3d->num_cascades,
+							1 << sdf_3d->levels);
+	printf("      - Memory allocated: %lu bytes (%lu MB).\n", memory_required,
+						memory_required / (1024 * 1024));
+
+	if (!sdf_3d->voxels)
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for 3D SDF clipmap!\n");
+		return -1;
+	}
+
+	// Every voxel of every window is new:
+	FracRenderSDF3DClipmapUpdate update;
+	set_up_sdf_3d_clipmap_update(sdf_3d, &update);
+	for (uint32_t i = 0; i < sdf_3d->num_cascades; i++)
+	{
+		get_sdf_3d_cascade_window(sdf_3d, i, sdf_3d->centre, &update.cascades[i]);
+		add_sdf_3d_clipmap_regions(&update, i, NULL, &update.cascades[i]);
+	}
+
+	printf(" ---> Calculating distance values (clipmap).\n");
+	printf("      - Threads: %d.\n", sdf_3d->num_threads);
+	printf("      - Instruction set: %s.\n",
+		get_sdf_3d_instruction_set_name(sdf_3d->instruction_set));
+	printf("      - Smallest voxel: %.3f.\n", update.cascades[0].voxel_size);
+	printf("      --->   0.0%%.\n");
+
+	struct timespec start_time;
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	if (run_sdf_3d_clipmap_update(&update) != 0) { return -1; }
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	double seconds = (double)(end_time.tv_sec - start_time.tv_sec) +
+			((double)(end_time.tv_nsec - start_time.tv_nsec) / 1000000000.0);
+	if (seconds <= 0.0) { seconds = 1e-9; }
+
+	printf("      - Time taken: %.3lf seconds.\n", seconds);
+	printf("      - Voxels per second: %.0lf.\n", (double)sdf_3d->num_voxels / seconds);
+
+	// The snapped windows are centred close to, but not exactly on, the SDF centre:
+	memcpy(sdf_3d->cascades, update.cascades, sizeof(update.cascades));
+	sdf_3d->centre = get_sdf_3d_clipmap_centre(sdf_3d);
+
+	return 0;
+}
+
+// Get the window of a cascade centred on a position:
+void get_sdf_3d_cascade_window(FracRenderSDF3D *sdf_3d, uint32_t cascade,
+			FracRenderVector3 position, FracRenderSDF3DCascade *window)
+{
+	int32_t resolution = 1 << sdf_3d->levels;
+
+	// The biggest cascade is the size of the main cube, and they halve from there:
+	window->voxel_size = (2.f * sdf_3d->size) / (float)resolution;
+	window->voxel_size = ldexpf(window->voxel_size, (int)cascade + 1 - sdf_3d->num_cascades);
+
+	window->origin[0] = (int32_t)floorf(position.x / window->voxel_size) - (resolution / 2);
+	window->origin[1] = (int32_t)floorf(position.y / window->voxel_size) - (resolution / 2);
+	window->origin[2] = (int32_t)floorf(position.z / window->voxel_size) - (resolution / 2);
+}
+
+// Start an update. Cascades to calculate are added to it with add_sdf_3d_clipmap_regions:
+void set_up_sdf_3d_clipmap_update(FracRenderSDF3D *sdf_3d,
+				FracRenderSDF3DClipmapUpdate *update)
+{
+	update->sdf_3d			= sdf_3d;
+	memcpy(update->cascades, sdf_3d->cascades, sizeof(update->cascades));
+	update->num_regions		= 0;
+	update->changed_cascades	= 0;
+	update->num_tasks		= 0;
+	update->num_voxels		= 0;
+	update->tasks_completed		= 0;
+	update->quiet			= 0;
+	update->cancelled		= 0;
+}
+
+// Add the voxels a cascade's new window has, but the old one doesn't (all if there is no old one):
+void add_sdf_3d_clipmap_regions(FracRenderSDF3DClipmapUpdate *update, uint32_t cascade,
+	const FracRenderSDF3DCascade *old_window, const FracRenderSDF3DCascade *new_window)
+{
+	int32_t resolution = 1 << update->sdf_3d->levels;
+
+	// Windows which don't overlap at all (or no old window) mean a whole new cascade:
+	int overlap = (old_window != NULL);
+	for (int i = 0; (i < 3) && overlap; i++)
+	{
+		if (abs(new_window->origin[i] - old_window->origin[i]) >= resolution)
+		{
+			overlap = 0;
+		}
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		FracRenderSDF3DClipmapRegion region;
+		region.cascade = cascade;
+
+		// One slab along each axis the window moved. Axes already done are limited to the
+		// overlap, so no voxel is calculated twice:
+		for (int i = 0; i < 3; i++)
+		{
+			region.min[i] = new_window->origin[i];
+			region.max[i] = new_window->origin[i] + resolution;
+			if (!overlap) { continue; }
+
+			int32_t old_min = old_window->origin[i];
+			int32_t old_max = old_window->origin[i] + resolution;
+			if (i < axis)
+			{
+				if (old_min > region.min[i]) { region.min[i] = old_min; }
+				if (old_max < region.max[i]) { region.max[i] = old_max; }
+			}
+			else if (i == axis)
+			{
+				if (new_window->origin[i] > old_min) { region.min[i] = old_max; }
+				else { region.max[i] = old_min; }
+			}
+		}
+
+		if ((region.min[0] < region.max[0]) && (region.min[1] < region.max[1]) &&
+			(region.min[2] < region.max[2]))
+		{
+			region.first_task = update->num_tasks;
+			update->regions[update->num_regions] = region;
+			update->num_regions++;
+			update->num_tasks += region.max[2] - region.min[2];
+			update->num_voxels += (uint64_t)(region.max[0] - region.min[0]) *
+				(region.max[1] - region.min[1]) * (region.max[2] - region.min[2]);
+		}
+
+		// Without an overlap, the first box is the whole window:
+		if (!overlap) { break; }
+	}
+
+	update->cascades[cascade] = *new_window;
+	update->changed_cascades |= 1u << cascade;
+}
+
+// Calculate all voxels added to an update:
+int run_sdf_3d_clipmap_update(FracRenderSDF3DClipmapUpdate *update)
+{
+	return run_work_pool(update->sdf_3d->num_threads, update->num_tasks,
+					create_sdf_3d_clipmap_task, update);
+}
+
+// Calculate one plane of a box (work pool task):
+int create_sdf_3d_clipmap_task(void *update_data, uint32_t task_index)
+{
+	FracRenderSDF3DClipmapUpdate *update = update_data;
+	FracRenderSDF3D *sdf_3d = update->sdf_3d;
+	float *voxels = sdf_3d->voxels;
+
+	if (__atomic_load_n(&update->cancelled, __ATOMIC_RELAXED) != 0) { return -1; }
+
+	// Find the box, and the plane in it:
+	uint32_t region_index = 0;
+	while (((region_index + 1) < update->num_regions) &&
+		(update->regions[region_index + 1].first_task <= task_index))
+	{
+		region_index++;
+	}
+	FracRenderSDF3DClipmapRegion *region = &update->regions[region_index];
+	FracRenderSDF3DCascade *window = &update->cascades[region->cascade];
+	int32_t z = region->min[2] + (int32_t)(task_index - region->first_task);
+
+	float voxel_size = window->voxel_size;
+	float half_diagonal = sqrt(3.f) * (voxel_size / 2.f);
+
+	// Go along each row, 8 voxels at a time (repeating the last one to fill a batch):
+	for (int32_t y = region->min[1]; y < region->max[1]; y++)
+	{
+		for (int32_t x = region->min[0]; x < region->max[0]; x += 8)
+		{
+			int32_t count = region->max[0] - x;
+			if (count > 8) { count = 8; }
+
+			FracRenderVector3x8 positions;
+			for (int32_t i = 0; i < 8; i++)
+			{
+				int32_t voxel_x = x + ((i < count) ? i : (count - 1));
+				positions.x[i] = ((float)voxel_x + 0.5f) * voxel_size;
+				positions.y[i] = ((float)y + 0.5f) * voxel_size;
+				positions.z[i] = ((float)z + 0.5f) * voxel_size;
+			}
+
+			float distances[8];
+			sdf_3d->batch_distance_function(&positions, sdf_3d->parameter, distances);
+
+			for (int32_t i = 0; i < count; i++)
+			{
+				// Take away half the diagonal, to guarantee underestimate:
+				float distance_estimate = distances[i];
+				distance_estimate -= (distance_estimate / fabs(distance_estimate)) *
+									half_diagonal;
+				voxels[get_sdf_3d_clipmap_index(sdf_3d, region->cascade,
+							x + i, y, z)] = distance_estimate;
+			}
+		}
+	}
+
+	if (update->quiet == 0)
+	{
+		print_sdf_3d_progress(&update->tasks_completed, update->num_tasks);
+	}
+
+	return 0;
+}
+
+// Get index of a voxel from its cascade and world voxel coordinates (toroidal addressing):
+size_t get_sdf_3d_clipmap_index(FracRenderSDF3D *sdf_3d, uint32_t cascade,
+						int32_t x, int32_t y, int32_t z)
+{
+	uint32_t levels = sdf_3d->levels;
+	uint32_t mask = (1u << levels) - 1;
+
+	size_t index = (size_t)cascade << (3 * levels);
+	index += ((uint32_t)x & mask);
+	index += (size_t)((uint32_t)y & mask) << levels;
+	index += (size_t)((uint32_t)z & mask) << (2 * levels);
+
+	return index;
+}
+
+// Get centre of the biggest cascade's window:
+FracRenderVector3 get_sdf_3d_clipmap_centre(FracRenderSDF3D *sdf_3d)
+{
+	FracRenderSDF3DCascade *window = &sdf_3d->cascades[sdf_3d->num_cascades - 1];
+	float half_resolution = (float)(1 << (sdf_3d->levels - 1));
+
+	return initialize_vector_3(
+		((float)window->origin[0] + half_resolution) * window->voxel_size,
+		((float)window->origin[1] + half_resolution) * window->voxel_size,
+		((float)window->origin[2] + half_resolution) * window->voxel_size);
+}
+
+// Set up moving the clipmap in the background (the SDF can be destroyed afterwards):
+void set_up_sdf_3d_clipmap(FracRenderSDF3D *sdf_3d, FracRenderSDF3DClipmap *clipmap)
+{
+	memset(clipmap, 0, sizeof(FracRenderSDF3DClipmap));
+
+	// Same SDF, without its data. Voxels are always calculated into memory given each time:
+	clipmap->sdf_3d			= *sdf_3d;
+	clipmap->sdf_3d.voxels		= NULL;
+	clipmap->sdf_3d.nodes		= NULL;
+	clipmap->sdf_3d.cache		= 0;
+	clipmap->sdf_3d.cache_mapping	= NULL;
+	clipmap->sdf_3d.cache_mapping_size = 0;
+
+	// Leave a core for the render loop:
+	if (clipmap->sdf_3d.num_threads > 1) { clipmap->sdf_3d.num_threads--; }
+
+	clipmap->thread_running	= 0;
+	clipmap->state		= 0;
+	clipmap->seconds	= 0.0;
+}
+
+// Start calculating voxels the camera has brought into view, into voxels (a copy of the SDF's).
+// Returns 1 if started, 0 if no cascade needs moving yet:
+int start_sdf_3d_clipmap_update(FracRenderSDF3DClipmap *clipmap, void *voxels,
+						FracRenderVector3 position)
+{
+	if (clipmap->thread_running != 0)
+	{
+		fprintf(stderr, "Error: 3D SDF clipmap is already being updated!\n");
+		return -1;
+	}
+
+	FracRenderSDF3D *sdf_3d = &clipmap->sdf_3d;
+	sdf_3d->voxels = voxels;
+
+	// Move cascades the camera has gone too far from the centre of:
+	int32_t resolution = 1 << sdf_3d->levels;
+	int32_t max_offset = resolution / FRACRENDER_SDF_3D_CLIPMAP_RECENTRE_FRACTION;
+	if (max_offset < 1) { max_offset = 1; }
+
+	set_up_sdf_3d_clipmap_update(sdf_3d, &clipmap->update);
+	clipmap->update.quiet = 1;
+	for (uint32_t i = 0; i < sdf_3d->num_cascades; i++)
+	{
+		FracRenderSDF3DCascade window;
+		get_sdf_3d_cascade_window(sdf_3d, i, position, &window);
+		for (int j = 0; j < 3; j++)
+		{
+			if (abs(window.origin[j] - sdf_3d->cascades[i].origin[j]) > max_offset)
+			{
+				add_sdf_3d_clipmap_regions(&clipmap->update, i,
+							&sdf_3d->cascades[i], &window);
+				break;
+			}
+		}
+	}
+	if (clipmap->update.num_tasks == 0) { return 0; }
+
+	clock_gettime(CLOCK_MONOTONIC, &clipmap->start_time);
+	__atomic_store_n(&clipmap->state, 1, __ATOMIC_RELEASE);
+	if (pthread_create(&clipmap->thread, NULL, sdf_3d_clipmap_thread, clipmap) != 0)
+	{
+		clipmap->state = 0;
+		fprintf(stderr, "Error: Unable to create thread for updating 3D SDF clipmap!\n");
+		return -1;
+	}
+	clipmap->thread_running = 1;
+
+	return 1;
+}
+
+// Get the state of the calculation, waiting for the thread to exit once it is done:
+int get_sdf_3d_clipmap_state(FracRenderSDF3DClipmap *clipmap)
+{
+	int state = __atomic_load_n(&clipmap->state, __ATOMIC_ACQUIRE);
+	if ((state != 1) && (clipmap->thread_running != 0))
+	{
+		pthread_join(clipmap->thread, NULL);
+		clipmap->thread_running = 0;
+	}
+
+	return state;
+}
+
+// Move the cascades to their new windows, once the voxels are being shown:
+void finish_sdf_3d_clipmap_update(FracRenderSDF3DClipmap *clipmap)
+{
+	memcpy(clipmap->sdf_3d.cascades, clipmap->update.cascades,
+				sizeof(clipmap->update.cascades));
+	clipmap->sdf_3d.centre = get_sdf_3d_clipmap_centre(&clipmap->sdf_3d);
+	clipmap->state = 0;
+}
+
+// Stop any calculation in progress, and wait for the thread to exit:
+void stop_sdf_3d_clipmap(FracRenderSDF3DClipmap *clipmap)
+{
+	if (clipmap->thread_running == 0) { return; }
+
+	// Planes not started yet fail straight away:
+	__atomic_store_n(&clipmap->update.cancelled, 1, __ATOMIC_RELAXED);
+	pthread_join(clipmap->thread, NULL);
+	clipmap->thread_running = 0;
+	clipmap->state = 0;
+}
+
+// Background thread main function:
+void *sdf_3d_clipmap_thread(void *clipmap_data)
+{
+	FracRenderSDF3DClipmap *clipmap = clipmap_data;
+
+	int result = run_sdf_3d_clipmap_update(&clipmap->update);
+
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	clipmap->seconds = (double)(end_time.tv_sec - clipmap->start_time.tv_sec) +
+		((double)(end_time.tv_nsec - clipmap->start_time.tv_nsec) / 1000000000.0);
+
+	if (result != 0) { __atomic_store_n(&clipmap->state, -1, __ATOMIC_RELEASE); }
+	else { __atomic_store_n(&clipmap->state, 2, __ATOMIC_RELEASE); }
+
+	return NULL;
+}
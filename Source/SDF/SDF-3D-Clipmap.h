@@ -0,0 +1,146 @@
+#ifndef FRACRENDER_SDF_3D_CLIPMAP_H
+#define FRACRENDER_SDF_3D_CLIPMAP_H
+
+/*****************************************************************
+ * Clipmap 3D SDF, nested dense cascades which follow the camera *
+ *****************************************************************/
+
+// Library includes:
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local includes:
+#include "../Utility/Vectors.h"
+#include "../Utility/Work-Pool.h"
+#include "SDF-3D.h"
+
+/*
+ * Each cascade is a dense grid of (2 ^ levels) voxels along each axis, lined up with world voxel
+ * coordinates (floor(position / voxel size)). Voxels are twice the size in each cascade, so the
+ * biggest one is the usual cube. A cascade's window is re-centred on the camera when the camera
+ * moves far enough from its centre.
+ *
+ * Toroidal addressing: a voxel is stored at its world coordinates wrapped around the grid
+ * (x, y and z modulo the resolution, all counting up), at index x + (y * res) + (z * res^2) of
+ * its cascade. Moving the window leaves every voxel still in it where it is, so only the newly
+ * exposed slabs are calculated.
+ */
+
+// Voxels the camera can move from a cascade's centre (along any axis) before it is re-centred,
+// as a fraction of the resolution:
+#define FRACRENDER_SDF_3D_CLIPMAP_RECENTRE_FRACTION 8
+
+// Boxes of voxels calculated at a time (3 slabs for each cascade):
+#define FRACRENDER_SDF_3D_CLIPMAP_MAX_REGIONS (3 * FRACRENDER_SDF_3D_CLIPMAP_CASCADES)
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// Cascade, and box of world voxel coordinates (lowest corner in, highest corner out):
+	uint32_t cascade;
+	int32_t min[3];
+	int32_t max[3];
+
+	// First task (plane of constant z) of the box:
+	uint32_t first_task;
+} FracRenderSDF3DClipmapRegion;
+
+typedef struct {
+	// SDF being calculated. Cascades are moved to the new windows once it is done:
+	FracRenderSDF3D *sdf_3d;
+	FracRenderSDF3DCascade cascades[FRACRENDER_SDF_3D_CLIPMAP_CASCADES];
+
+	// Boxes of newly exposed voxels, and the cascades they are in (one bit each):
+	FracRenderSDF3DClipmapRegion regions[FRACRENDER_SDF_3D_CLIPMAP_MAX_REGIONS];
+	uint32_t num_regions;
+	uint32_t changed_cascades;
+
+	// One task per plane of constant z in each box:
+	uint32_t num_tasks;
+	uint64_t num_voxels;
+
+	// Progress. Nothing is printed if quiet (background calculation):
+	uint32_t tasks_completed;
+	int quiet;
+
+	// Set to stop the remaining tasks (they then fail):
+	int cancelled;
+} FracRenderSDF3DClipmapUpdate;
+
+typedef struct {
+	// Copy of the SDF being shown, with the cascades currently in the voxels:
+	FracRenderSDF3D sdf_3d;
+	FracRenderSDF3DClipmapUpdate update;
+
+	// Background thread, which runs the work pool:
+	pthread_t thread;
+	int thread_running;
+
+	// State, shared with the thread. 0 = Idle, 1 = Calculating, 2 = Finished, -1 = Failed:
+	int state;
+
+	// Start of the last calculation, and time it took:
+	struct timespec start_time;
+	double seconds;
+} FracRenderSDF3DClipmap;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Calculate all clipmap cascades, centred on the SDF centre:
+int create_sdf_3d_clipmap(FracRenderSDF3D *sdf_3d);
+
+// Get the window of a cascade centred on a position:
+void get_sdf_3d_cascade_window(FracRenderSDF3D *sdf_3d, uint32_t cascade,
+			FracRenderVector3 position, FracRenderSDF3DCascade *window);
+
+// Start an update. Cascades to calculate are added to it with add_sdf_3d_clipmap_regions:
+void set_up_sdf_3d_clipmap_update(FracRenderSDF3D *sdf_3d,
+				FracRenderSDF3DClipmapUpdate *update);
+
+// Add the voxels a cascade's new window has, but the old one doesn't (all if there is no old one):
+void add_sdf_3d_clipmap_regions(FracRenderSDF3DClipmapUpdate *update, uint32_t cascade,
+	const FracRenderSDF3DCascade *old_window, const FracRenderSDF3DCascade *new_window);
+
+// Calculate all voxels added to an update:
+int run_sdf_3d_clipmap_update(FracRenderSDF3DClipmapUpdate *update);
+
+// Calculate one plane of a box (work pool task):
+int create_sdf_3d_clipmap_task(void *update_data, uint32_t task_index);
+
+// Get index of a voxel from its cascade and world voxel coordinates (toroidal addressing):
+size_t get_sdf_3d_clipmap_index(FracRenderSDF3D *sdf_3d, uint32_t cascade,
+						int32_t x, int32_t y, int32_t z);
+
+// Get centre of the biggest cascade's window:
+FracRenderVector3 get_sdf_3d_clipmap_centre(FracRenderSDF3D *sdf_3d);
+
+// Set up moving the clipmap in the background (the SDF can be destroyed afterwards):
+void set_up_sdf_3d_clipmap(FracRenderSDF3D *sdf_3d, FracRenderSDF3DClipmap *clipmap);
+
+// Start calculating voxels the camera has brought into view, into voxels (a copy of the SDF's).
+// Returns 1 if started, 0 if no cascade needs moving yet:
+int start_sdf_3d_clipmap_update(FracRenderSDF3DClipmap *clipmap, void *voxels,
+						FracRenderVector3 position);
+
+// Get the state of the calculation, waiting for the thread to exit once it is done:
+int get_sdf_3d_clipmap_state(FracRenderSDF3DClipmap *clipmap);
+
+// Move the cascades to their new windows, once the voxels are being shown:
+void finish_sdf_3d_clipmap_update(FracRenderSDF3DClipmap *clipmap);
+
+// Stop any calculation in progress, and wait for the thread to exit:
+void stop_sdf_3d_clipmap(FracRenderSDF3DClipmap *clipmap);
+
+// Background thread main function:
+void *sdf_3d_clipmap_thread(void *clipmap_data);
+
+#endif
@@ -0,0 +1,94 @@
+#include "SDF-3D-Rebake.h"
+
+// Set up background recalculation of a dense 3D SDF (which can be destroyed afterwards):
+void set_up_sdf_3d_rebake(FracRenderSDF3D *sdf_3d, FracRenderSDF3DRebake *rebake)
+{
+	memset(rebake, 0, sizeof(FracRenderSDF3DRebake));
+
+	// Same SDF, without its data. Voxels are always calculated into memory given each time:
+	rebake->sdf_3d			= *sdf_3d;
+	rebake->sdf_3d.voxels		= NULL;
+	rebake->sdf_3d.nodes		= NULL;
+	rebake->sdf_3d.num_node_entries	= 0;
+	rebake->sdf_3d.cache		= 0;
+	rebake->sdf_3d.cache_mapping	= NULL;
+	rebake->sdf_3d.cache_mapping_size = 0;
+	rebake->sdf_3d.deferred		= 0;
+	rebake->sdf_3d.bake		= 0;
+
+	// Leave a core for the render loop:
+	if (rebake->sdf_3d.num_threads > 1) { rebake->sdf_3d.num_threads--; }
+
+	rebake->thread_running	= 0;
+	rebake->state		= 0;
+	rebake->seconds		= 0.0;
+}
+
+// Start calculating the SDF for a new parameter into voxels (same size as the original):
+int start_sdf_3d_rebake(FracRenderSDF3DRebake *rebake, void *voxels, float parameter)
+{
+	if (rebake->thread_running != 0)
+	{
+		fprintf(stderr, "Error: 3D SDF is already being recalculated!\n");
+		return -1;
+	}
+
+	rebake->sdf_3d.voxels		= voxels;
+	rebake->sdf_3d.parameter	= parameter;
+	if (set_up_sdf_3d_build(&rebake->sdf_3d, &rebake->build) != 0) { return -1; }
+	rebake->build.quiet = 1;
+
+	__atomic_store_n(&rebake->state, 1, __ATOMIC_RELEASE);
+	if (pthread_create(&rebake->thread, NULL, sdf_3d_rebake_thread, rebake) != 0)
+	{
+		rebake->state = 0;
+		fprintf(stderr, "Error: Unable to create thread for recalculating 3D SDF!\n");
+		return -1;
+	}
+	rebake->thread_running = 1;
+
+	return 0;
+}
+
+// Get the state of the calculation, waiting for the thread to exit once it is done:
+int get_sdf_3d_rebake_state(FracRenderSDF3DRebake *rebake)
+{
+	int state = __atomic_load_n(&rebake->state, __ATOMIC_ACQUIRE);
+	if ((state != 1) && (rebake->thread_running != 0))
+	{
+		pthread_join(rebake->thread, NULL);
+		rebake->thread_running = 0;
+	}
+
+	return state;
+}
+
+// Stop any calculation in progress, and wait for the thread to exit:
+void stop_sdf_3d_rebake(FracRenderSDF3DRebake *rebake)
+{
+	if (rebake->thread_running == 0) { return; }
+
+	// Subtrees not started yet fail straight away:
+	__atomic_store_n(&rebake->build.cancelled, 1, __ATOMIC_RELAXED);
+	pthread_join(rebake->thread, NULL);
+	rebake->thread_running = 0;
+	rebake->state = 0;
+}
+
+// Background thread main function:
+void *sdf_3d_rebake_thread(void *rebake_data)
+{
+	FracRenderSDF3DRebake *rebake = rebake_data;
+
+	int result = run_sdf_3d_build(&rebake->build, 0, rebake->build.num_tasks);
+
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	rebake->seconds = (double)(end_time.tv_sec - rebake->build.start_time.tv_sec) +
+		((double)(end_time.tv_nsec - rebake->build.start_time.tv_nsec) / 1000000000.0);
+
+	if (result != 0) { __atomic_store_n(&rebake->state, -1, __ATOMIC_RELEASE); }
+	else { __atomic_store_n(&rebake->state, 2, __ATOMIC_RELEASE); }
+
+	return NULL;
+}
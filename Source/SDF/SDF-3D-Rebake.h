@@ -0,0 +1,58 @@
+#ifndef FRACRENDER_SDF_3D_REBAKE_H
+#define FRACRENDER_SDF_3D_REBAKE_H
+
+/********************************************************************
+ * Background recalculation of the dense 3D SDF for a new parameter *
+ ********************************************************************/
+
+// Library includes:
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local includes:
+#include "SDF-3D.h"
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// Copy of the SDF being shown. Only the parameter and voxels change:
+	FracRenderSDF3D sdf_3d;
+	FracRenderSDF3DBuild build;
+
+	// Background thread, which runs the work pool:
+	pthread_t thread;
+	int thread_running;
+
+	// State, shared with the thread. 0 = Idle, 1 = Calculating, 2 = Finished, -1 = Failed:
+	int state;
+
+	// Time taken by the last calculation:
+	double seconds;
+} FracRenderSDF3DRebake;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Set up background recalculation of a dense 3D SDF (which can be destroyed afterwards):
+void set_up_sdf_3d_rebake(FracRenderSDF3D *sdf_3d, FracRenderSDF3DRebake *rebake);
+
+// Start calculating the SDF for a new parameter into voxels (same size as the original):
+int start_sdf_3d_rebake(FracRenderSDF3DRebake *rebake, void *voxels, float parameter);
+
+// Get the state of the calculation, waiting for the thread to exit once it is done:
+int get_sdf_3d_rebake_state(FracRenderSDF3DRebake *rebake);
+
+// Stop any calculation in progress, and wait for the thread to exit:
+void stop_sdf_3d_rebake(FracRenderSDF3DRebake *rebake);
+
+// Background thread main function:
+void *sdf_3d_rebake_thread(void *rebake_data);
+
+#endif
@@ -0,0 +1,621 @@
+#include "SDF-3D-SIMD.h"
+#include "SDF-3D.h"
+
+// Get the best supported instruction set. -1 = auto, 0 = scalar, 1 = SSE4.1, 2 = AVX2:
+int get_sdf_3d_instruction_set(int requested_instruction_set)
+{
+	int best_instruction_set = 0;
+
+#ifdef FRACRENDER_SDF_3D_SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) { best_instruction_set = 2; }
+	else if (__builtin_cpu_supports("sse4.1")) { best_instruction_set = 1; }
+#endif
+
+	if (requested_instruction_set < 0) { return best_instruction_set; }
+
+	if (requested_instruction_set > best_instruction_set)
+	{
+		printf("Warning: %s is not supported on this processor. Using %s.\n",
+			get_sdf_3d_instruction_set_name(requested_instruction_set),
+			get_sdf_3d_instruction_set_name(best_instruction_set));
+		return best_instruction_set;
+	}
+
+	return requested_instruction_set;
+}
+
+// Get name of instruction set:
+const char *get_sdf_3d_instruction_set_name(int instruction_set)
+{
+	if (instruction_set == 2) { return "AVX2"; }
+	else if (instruction_set == 1) { return "SSE4.1"; }
+	else { return "Scalar"; }
+}
+
+// Get batch distance estimator for a fractal type and instruction set:
+FracRenderSDF3DBatchFunction get_sdf_3d_batch_function(int fractal_type, int instruction_set)
+{
+#ifdef FRACRENDER_SDF_3D_SIMD_X86
+	if (instruction_set == 2)
+	{
+		if (fractal_type == 1) { return signed_distance_function_hall_of_pillars_x8_avx2; }
+		else { return signed_distance_function_mandelbulb_x8_avx2; }
+	}
+	else if (instruction_set == 1)
+	{
+		if (fractal_type == 1) { return signed_distance_function_hall_of_pillars_x8_sse4; }
+		else { return signed_distance_function_mandelbulb_x8_sse4; }
+	}
+#endif
+
+	if (fractal_type == 1) { return signed_distance_function_hall_of_pillars_x8_scalar; }
+	else { return signed_distance_function_mandelbulb_x8_scalar; }
+}
+
+/**********
+ * Scalar *
+ **********/
+
+// Mandelbulb, one position at a time:
+void signed_distance_function_mandelbulb_x8_scalar(const FracRenderVector3x8 *positions,
+						float parameter, float *distances)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		distances[i] = signed_distance_function_mandelbulb(initialize_vector_3(
+				positions->x[i], positions->y[i], positions->z[i]), parameter);
+	}
+}
+
+// Hall of Pillars, one position at a time:
+void signed_distance_function_hall_of_pillars_x8_scalar(const FracRenderVector3x8 *positions,
+						float parameter, float *distances)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		distances[i] = signed_distance_function_hall_of_pillars(initialize_vector_3(
+				positions->x[i], positions->y[i], positions->z[i]), parameter);
+	}
+}
+
+#ifdef FRACRENDER_SDF_3D_SIMD_X86
+
+/*
+ * Polynomial approximations of log, exp, atan and sin/cos are the single precision
+ * ones from the Cephes library. They are accurate to a few ULP over the ranges used here.
+ */
+
+/**********
+ * SSE4.1 *
+ **********/
+
+#define FRACRENDER_SSE4 __attribute__((target("sse4.1")))
+
+// Natural logarithm (positive, normal inputs):
+static inline FRACRENDER_SSE4 __m128 log_sse4(__m128 x)
+{
+	// Split into mantissa in [0.5, 1) and exponent:
+	__m128i bits = _mm_castps_si128(x);
+	__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x807FFFFF)),
+							_mm_set1_epi32(0x3F000000)));
+
+	// Keep mantissa in [sqrt(0.5), sqrt(2)):
+	__m128 small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+	e = _mm_sub_ps(e, _mm_and_ps(small, _mm_set1_ps(1.f)));
+	m = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(small, m)), _mm_set1_ps(1.f));
+
+	__m128 z = _mm_mul_ps(m, m);
+	__m128 y = _mm_set1_ps(7.0376836292e-2f);
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+	y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+	y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+	y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+
+	return _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+}
+
+// Exponential:
+static inline FRACRENDER_SSE4 __m128 exp_sse4(__m128 x)
+{
+	x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3f)), _mm_set1_ps(88.3f));
+
+	// x = (n * ln(2)) + r:
+	__m128 n = _mm_floor_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)),
+								_mm_set1_ps(0.5f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+	__m128 z = _mm_mul_ps(x, x);
+	__m128 y = _mm_set1_ps(1.9875691500e-4f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+	y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1.f));
+
+	// Multiply by 2^n:
+	__m128i exponent = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n),
+							_mm_set1_epi32(127)), 23);
+
+	return _mm_mul_ps(y, _mm_castsi128_ps(exponent));
+}
+
+// Arctangent of y / x, in the same range as atan2():
+static inline FRACRENDER_SSE4 __m128 atan2_sse4(__m128 y, __m128 x)
+{
+	__m128 sign_mask = _mm_set1_ps(-0.f);
+	__m128 abs_x = _mm_andnot_ps(sign_mask, x);
+	__m128 abs_y = _mm_andnot_ps(sign_mask, y);
+
+	// Reduce to t in [0, 1]:
+	__m128 numerator = _mm_min_ps(abs_x, abs_y);
+	__m128 denominator = _mm_max_ps(_mm_max_ps(abs_x, abs_y), _mm_set1_ps(1e-30f));
+	__m128 t = _mm_div_ps(numerator, denominator);
+
+	// Reduce further to |t| <= tan(pi / 8):
+	__m128 large = _mm_cmpgt_ps(t, _mm_set1_ps(0.4142135623730950f));
+	t = _mm_blendv_ps(t, _mm_div_ps(_mm_sub_ps(t, _mm_set1_ps(1.f)),
+					_mm_add_ps(t, _mm_set1_ps(1.f))), large);
+	__m128 offset = _mm_and_ps(large, _mm_set1_ps(0.78539816339744831f));
+
+	__m128 z = _mm_mul_ps(t, t);
+	__m128 a = _mm_set1_ps(8.05374449538e-2f);
+	a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(-1.38776856032e-1f));
+	a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(1.99777106478e-1f));
+	a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(-3.33329491539e-1f));
+	a = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(a, z), t), t);
+	a = _mm_add_ps(a, offset);
+
+	// Undo the reductions:
+	a = _mm_blendv_ps(a, _mm_sub_ps(_mm_set1_ps(1.57079632679489662f), a),
+						_mm_cmpgt_ps(abs_y, abs_x));
+	a = _mm_blendv_ps(a, _mm_sub_ps(_mm_set1_ps(3.14159265358979324f), a),
+						_mm_cmplt_ps(x, _mm_setzero_ps()));
+
+	return _mm_or_ps(a, _mm_and_ps(y, sign_mask));
+}
+
+// Sine and cosine:
+static inline FRACRENDER_SSE4 void sincos_sse4(__m128 x, __m128 *sine, __m128 *cosine)
+{
+	__m128 sign_mask = _mm_set1_ps(-0.f);
+	__m128 sine_sign = _mm_and_ps(x, sign_mask);
+	x = _mm_andnot_ps(sign_mask, x);
+
+	// Octant, rounded up to even:
+	__m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+	j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+	__m128 y = _mm_cvtepi32_ps(j);
+
+	// Extended precision reduction:
+	x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(0.78515625f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(2.4187564849853515625e-4f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(3.77489497744594108e-8f)));
+
+	// Signs and polynomial choice from the octant:
+	sine_sign = _mm_xor_ps(sine_sign, _mm_castsi128_ps(_mm_slli_epi32(
+				_mm_and_si128(j, _mm_set1_epi32(4)), 29)));
+	__m128 cosine_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(
+				_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+	__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)),
+								_mm_set1_epi32(2)));
+
+	__m128 z = _mm_mul_ps(x, x);
+
+	__m128 c = _mm_set1_ps(2.443315711809948e-5f);
+	c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(-1.388731625493765e-3f));
+	c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(4.166664568298827e-2f));
+	c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+	c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.f));
+
+	__m128 s = _mm_set1_ps(-1.9515295891e-4f);
+	s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(8.3321608736e-3f));
+	s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(-1.6666654611e-1f));
+	s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), x), x);
+
+	*sine = _mm_xor_ps(_mm_blendv_ps(s, c, swap), sine_sign);
+	*cosine = _mm_xor_ps(_mm_blendv_ps(c, s, swap), cosine_sign);
+}
+
+// Mandelbulb distance estimator for 4 positions:
+static inline FRACRENDER_SSE4 __m128 mandelbulb_sse4(__m128 position_x, __m128 position_y,
+					__m128 position_z, float fractal_parameter)
+{
+	int max_iterations = 4;
+	__m128 escape_radius = _mm_set1_ps(2.f);
+	__m128 parameter = _mm_set1_ps(fractal_parameter);
+	__m128 one = _mm_set1_ps(1.f);
+
+	__m128 z_x = position_x;
+	__m128 z_y = position_y;
+	__m128 z_z = position_z;
+	__m128 dr = one;
+	__m128 r = _mm_setzero_ps();
+
+	// Lanes still iterating (all bits set):
+	__m128 active = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+	for (int i = 0; i < max_iterations; i++)
+	{
+		__m128 new_r = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(z_x, z_x),
+				_mm_mul_ps(z_y, z_y)), _mm_mul_ps(z_z, z_z)));
+		r = _mm_blendv_ps(r, new_r, active);
+
+		// Escaped lanes keep their last radius and derivative:
+		active = _mm_and_ps(active, _mm_cmpngt_ps(new_r, escape_radius));
+		if (_mm_movemask_ps(active) == 0) { break; }
+
+		// Convert position to spherical coordinates:
+		__m128 cos_theta = _mm_div_ps(z_z, r);
+		__m128 sin_theta_unscaled = _mm_sqrt_ps(_mm_max_ps(_mm_mul_ps(
+			_mm_sub_ps(one, cos_theta), _mm_add_ps(one, cos_theta)), _mm_setzero_ps()));
+		__m128 theta = atan2_sse4(sin_theta_unscaled, cos_theta);
+		__m128 phi = atan2_sse4(z_y, z_x);
+
+		// r^(parameter - 1), and r^parameter from it:
+		__m128 r_power = exp_sse4(_mm_mul_ps(_mm_sub_ps(parameter, one), log_sse4(r)));
+		__m128 new_dr = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r_power, parameter), dr), one);
+		__m128 zr = _mm_mul_ps(r_power, r);
+
+		// Scale and rotate position:
+		__m128 sin_theta;
+		__m128 cos_theta_scaled;
+		__m128 sin_phi;
+		__m128 cos_phi;
+		sincos_sse4(_mm_mul_ps(theta, parameter), &sin_theta, &cos_theta_scaled);
+		sincos_sse4(_mm_mul_ps(phi, parameter), &sin_phi, &cos_phi);
+
+		// Convert position back to Cartesian coordinates:
+		__m128 new_x = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(zr, sin_theta), cos_phi),
+								position_x);
+		__m128 new_y = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(zr, sin_phi), sin_theta),
+								position_y);
+		__m128 new_z = _mm_add_ps(_mm_mul_ps(zr, cos_theta_scaled), position_z);
+
+		dr = _mm_blendv_ps(dr, new_dr, active);
+		z_x = _mm_blendv_ps(z_x, new_x, active);
+		z_y = _mm_blendv_ps(z_y, new_y, active);
+		z_z = _mm_blendv_ps(z_z, new_z, active);
+	}
+
+	return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), log_sse4(r)), _mm_div_ps(r, dr));
+}
+
+// Hall of Pillars distance estimator for 4 positions:
+static inline FRACRENDER_SSE4 __m128 hall_of_pillars_sse4(__m128 position_x, __m128 position_y,
+					__m128 position_z, float fractal_parameter)
+{
+	__m128 z_x = position_x;
+	__m128 z_y = position_z;
+	__m128 z_z = position_y;
+	__m128 scale = _mm_set1_ps(fmaxf(0.1f, fractal_parameter - 1.f));
+	__m128 fold = _mm_set1_ps(fractal_parameter);
+
+	for (int i = 0; i < 12; i++)
+	{
+		__m128 clamped_x = _mm_min_ps(_mm_max_ps(z_x, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f));
+		__m128 clamped_y = _mm_min_ps(_mm_max_ps(z_y, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f));
+		__m128 clamped_z = _mm_min_ps(_mm_max_ps(z_z, _mm_set1_ps(-1.3f)),
+							_mm_set1_ps(1.3f));
+		z_x = _mm_sub_ps(_mm_mul_ps(fold, clamped_x), z_x);
+		z_y = _mm_sub_ps(_mm_mul_ps(fold, clamped_y), z_y);
+		z_z = _mm_sub_ps(_mm_mul_ps(fold, clamped_z), z_z);
+
+		__m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(z_x, z_x), _mm_mul_ps(z_y, z_y)),
+								_mm_mul_ps(z_z, z_z));
+		__m128 k = _mm_max_ps(_mm_div_ps(fold, r2), _mm_set1_ps(0.027f));
+		z_x = _mm_mul_ps(z_x, k);
+		z_y = _mm_mul_ps(z_y, k);
+		z_z = _mm_mul_ps(z_z, k);
+		scale = _mm_mul_ps(scale, k);
+	}
+
+	__m128 l = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(z_x, z_x), _mm_mul_ps(z_y, z_y)));
+	__m128 rxy = _mm_sub_ps(l, _mm_set1_ps(4.f));
+	__m128 n = _mm_mul_ps(l, z_z);
+	rxy = _mm_max_ps(rxy, _mm_div_ps(n, _mm_set1_ps(-4.f)));
+
+	return _mm_div_ps(rxy, _mm_andnot_ps(_mm_set1_ps(-0.f), scale));
+}
+
+// Mandelbulb, SSE4.1 (2 x 4 positions):
+FRACRENDER_SSE4 void signed_distance_function_mandelbulb_x8_sse4(
+			const FracRenderVector3x8 *positions, float parameter, float *distances)
+{
+	for (int i = 0; i < 8; i += 4)
+	{
+		_mm_storeu_ps(&distances[i], mandelbulb_sse4(_mm_loadu_ps(&positions->x[i]),
+			_mm_loadu_ps(&positions->y[i]), _mm_loadu_ps(&positions->z[i]), parameter));
+	}
+}
+
+// Hall of Pillars, SSE4.1 (2 x 4 positions):
+FRACRENDER_SSE4 void signed_distance_function_hall_of_pillars_x8_sse4(
+			const FracRenderVector3x8 *positions, float parameter, float *distances)
+{
+	for (int i = 0; i < 8; i += 4)
+	{
+		_mm_storeu_ps(&distances[i], hall_of_pillars_sse4(_mm_loadu_ps(&positions->x[i]),
+			_mm_loadu_ps(&positions->y[i]), _mm_loadu_ps(&positions->z[i]), parameter));
+	}
+}
+
+/********
+ * AVX2 *
+ ********/
+
+#define FRACRENDER_AVX2 __attribute__((target("avx2")))
+
+// Natural logarithm (positive, normal inputs):
+static inline FRACRENDER_AVX2 __m256 log_avx2(__m256 x)
+{
+	// Split into mantissa in [0.5, 1) and exponent:
+	__m256i bits = _mm256_castps_si256(x);
+	__m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23),
+							_mm256_set1_epi32(126)));
+	__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits,
+		_mm256_set1_epi32(0x807FFFFF)), _mm256_set1_epi32(0x3F000000)));
+
+	// Keep mantissa in [sqrt(0.5), sqrt(2)):
+	__m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+	e = _mm256_sub_ps(e, _mm256_and_ps(small, _mm256_set1_ps(1.f)));
+	m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(small, m)), _mm256_set1_ps(1.f));
+
+	__m256 z = _mm256_mul_ps(m, m);
+	__m256 y = _mm256_set1_ps(7.0376836292e-2f);
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(-1.1514610310e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(1.1676998740e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(-1.2420140846e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(1.4249322787e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(-1.6668057665e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(2.0000714765e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(-2.4999993993e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(3.3333331174e-1f));
+	y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+
+	y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(-2.12194440e-4f)));
+	y = _mm256_sub_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+
+	return _mm256_add_ps(_mm256_add_ps(m, y), _mm256_mul_ps(e, _mm256_set1_ps(0.693359375f)));
+}
+
+// Exponential:
+static inline FRACRENDER_AVX2 __m256 exp_avx2(__m256 x)
+{
+	x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3f)), _mm256_set1_ps(88.3f));
+
+	// x = (n * ln(2)) + r:
+	__m256 n = _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(x,
+			_mm256_set1_ps(1.44269504088896341f)), _mm256_set1_ps(0.5f)));
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f)));
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+
+	__m256 z = _mm256_mul_ps(x, x);
+	__m256 y = _mm256_set1_ps(1.9875691500e-4f);
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507e-3f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073e-3f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894e-2f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201e-1f));
+	y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(y, z), x), _mm256_set1_ps(1.f));
+
+	// Multiply by 2^n:
+	__m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n),
+							_mm256_set1_epi32(127)), 23);
+
+	return _mm256_mul_ps(y, _mm256_castsi256_ps(exponent));
+}
+
+// Arctangent of y / x, in the same range as atan2():
+static inline FRACRENDER_AVX2 __m256 atan2_avx2(__m256 y, __m256 x)
+{
+	__m256 sign_mask = _mm256_set1_ps(-0.f);
+	__m256 abs_x = _mm256_andnot_ps(sign_mask, x);
+	__m256 abs_y = _mm256_andnot_ps(sign_mask, y);
+
+	// Reduce to t in [0, 1]:
+	__m256 numerator = _mm256_min_ps(abs_x, abs_y);
+	__m256 denominator = _mm256_max_ps(_mm256_max_ps(abs_x, abs_y), _mm256_set1_ps(1e-30f));
+	__m256 t = _mm256_div_ps(numerator, denominator);
+
+	// Reduce further to |t| <= tan(pi / 8):
+	__m256 large = _mm256_cmp_ps(t, _mm256_set1_ps(0.4142135623730950f), _CMP_GT_OQ);
+	t = _mm256_blendv_ps(t, _mm256_div_ps(_mm256_sub_ps(t, _mm256_set1_ps(1.f)),
+					_mm256_add_ps(t, _mm256_set1_ps(1.f))), large);
+	__m256 offset = _mm256_and_ps(large, _mm256_set1_ps(0.78539816339744831f));
+
+	__m256 z = _mm256_mul_ps(t, t);
+	__m256 a = _mm256_set1_ps(8.05374449538e-2f);
+	a = _mm256_add_ps(_mm256_mul_ps(a, z), _mm256_set1_ps(-1.38776856032e-1f));
+	a = _mm256_add_ps(_mm256_mul_ps(a, z), _mm256_set1_ps(1.99777106478e-1f));
+	a = _mm256_add_ps(_mm256_mul_ps(a, z), _mm256_set1_ps(-3.33329491539e-1f));
+	a = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(a, z), t), t);
+	a = _mm256_add_ps(a, offset);
+
+	// Undo the reductions:
+	a = _mm256_blendv_ps(a, _mm256_sub_ps(_mm256_set1_ps(1.57079632679489662f), a),
+						_mm256_cmp_ps(abs_y, abs_x, _CMP_GT_OQ));
+	a = _mm256_blendv_ps(a, _mm256_sub_ps(_mm256_set1_ps(3.14159265358979324f), a),
+						_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+	return _mm256_or_ps(a, _mm256_and_ps(y, sign_mask));
+}
+
+// Sine and cosine:
+static inline FRACRENDER_AVX2 void sincos_avx2(__m256 x, __m256 *sine, __m256 *cosine)
+{
+	__m256 sign_mask = _mm256_set1_ps(-0.f);
+	__m256 sine_sign = _mm256_and_ps(x, sign_mask);
+	x = _mm256_andnot_ps(sign_mask, x);
+
+	// Octant, rounded up to even:
+	__m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(1.27323954473516f)));
+	j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+	__m256 y = _mm256_cvtepi32_ps(j);
+
+	// Extended precision reduction:
+	x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(0.78515625f)));
+	x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(2.4187564849853515625e-4f)));
+	x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(3.77489497744594108e-8f)));
+
+	// Signs and polynomial choice from the octant:
+	sine_sign = _mm256_xor_ps(sine_sign, _mm256_castsi256_ps(_mm256_slli_epi32(
+				_mm256_and_si256(j, _mm256_set1_epi32(4)), 29)));
+	__m256 cosine_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(
+			_mm256_sub_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+	__m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j,
+				_mm256_set1_epi32(2)), _mm256_set1_epi32(2)));
+
+	__m256 z = _mm256_mul_ps(x, x);
+
+	__m256 c = _mm256_set1_ps(2.443315711809948e-5f);
+	c = _mm256_add_ps(_mm256_mul_ps(c, z), _mm256_set1_ps(-1.388731625493765e-3f));
+	c = _mm256_add_ps(_mm256_mul_ps(c, z), _mm256_set1_ps(4.166664568298827e-2f));
+	c = _mm256_mul_ps(_mm256_mul_ps(c, z), z);
+	c = _mm256_add_ps(_mm256_sub_ps(c, _mm256_mul_ps(z, _mm256_set1_ps(0.5f))),
+							_mm256_set1_ps(1.f));
+
+	__m256 s = _mm256_set1_ps(-1.9515295891e-4f);
+	s = _mm256_add_ps(_mm256_mul_ps(s, z), _mm256_set1_ps(8.3321608736e-3f));
+	s = _mm256_add_ps(_mm256_mul_ps(s, z), _mm256_set1_ps(-1.6666654611e-1f));
+	s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, z), x), x);
+
+	*sine = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sine_sign);
+	*cosine = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cosine_sign);
+}
+
+// Mandelbulb distance estimator for 8 positions:
+static inline FRACRENDER_AVX2 __m256 mandelbulb_avx2(__m256 position_x, __m256 position_y,
+					__m256 position_z, float fractal_parameter)
+{
+	int max_iterations = 4;
+	__m256 escape_radius = _mm256_set1_ps(2.f);
+	__m256 parameter = _mm256_set1_ps(fractal_parameter);
+	__m256 one = _mm256_set1_ps(1.f);
+
+	__m256 z_x = position_x;
+	__m256 z_y = position_y;
+	__m256 z_z = position_z;
+	__m256 dr = one;
+	__m256 r = _mm256_setzero_ps();
+
+	// Lanes still iterating (all bits set):
+	__m256 active = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+	for (int i = 0; i < max_iterations; i++)
+	{
+		__m256 new_r = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(z_x, z_x),
+				_mm256_mul_ps(z_y, z_y)), _mm256_mul_ps(z_z, z_z)));
+		r = _mm256_blendv_ps(r, new_r, active);
+
+		// Escaped lanes keep their last radius and derivative:
+		active = _mm256_and_ps(active, _mm256_cmp_ps(new_r, escape_radius, _CMP_NGT_UQ));
+		if (_mm256_movemask_ps(active) == 0) { break; }
+
+		// Convert position to spherical coordinates:
+		__m256 cos_theta = _mm256_div_ps(z_z, r);
+		__m256 sin_theta_unscaled = _mm256_sqrt_ps(_mm256_max_ps(_mm256_mul_ps(
+			_mm256_sub_ps(one, cos_theta), _mm256_add_ps(one, cos_theta)),
+			_mm256_setzero_ps()));
+		__m256 theta = atan2_avx2(sin_theta_unscaled, cos_theta);
+		__m256 phi = atan2_avx2(z_y, z_x);
+
+		// r^(parameter - 1), and r^parameter from it:
+		__m256 r_power = exp_avx2(_mm256_mul_ps(_mm256_sub_ps(parameter, one),
+								log_avx2(r)));
+		__m256 new_dr = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r_power, parameter), dr),
+								one);
+		__m256 zr = _mm256_mul_ps(r_power, r);
+
+		// Scale and rotate position:
+		__m256 sin_theta;
+		__m256 cos_theta_scaled;
+		__m256 sin_phi;
+		__m256 cos_phi;
+		sincos_avx2(_mm256_mul_ps(theta, parameter), &sin_theta, &cos_theta_scaled);
+		sincos_avx2(_mm256_mul_ps(phi, parameter), &sin_phi, &cos_phi);
+
+		// Convert position back to Cartesian coordinates:
+		__m256 new_x = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(zr, sin_theta), cos_phi),
+								position_x);
+		__m256 new_y = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(zr, sin_phi), sin_theta),
+								position_y);
+		__m256 new_z = _mm256_add_ps(_mm256_mul_ps(zr, cos_theta_scaled), position_z);
+
+		dr = _mm256_blendv_ps(dr, new_dr, active);
+		z_x = _mm256_blendv_ps(z_x, new_x, active);
+		z_y = _mm256_blendv_ps(z_y, new_y, active);
+		z_z = _mm256_blendv_ps(z_z, new_z, active);
+	}
+
+	return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), log_avx2(r)),
+							_mm256_div_ps(r, dr));
+}
+
+// Hall of Pillars distance estimator for 8 positions:
+static inline FRACRENDER_AVX2 __m256 hall_of_pillars_avx2(__m256 position_x, __m256 position_y,
+					__m256 position_z, float fractal_parameter)
+{
+	__m256 z_x = position_x;
+	__m256 z_y = position_z;
+	__m256 z_z = position_y;
+	__m256 scale = _mm256_set1_ps(fmaxf(0.1f, fractal_parameter - 1.f));
+	__m256 fold = _mm256_set1_ps(fractal_parameter);
+
+	for (int i = 0; i < 12; i++)
+	{
+		__m256 clamped_x = _mm256_min_ps(_mm256_max_ps(z_x, _mm256_set1_ps(-1.f)),
+							_mm256_set1_ps(1.f));
+		__m256 clamped_y = _mm256_min_ps(_mm256_max_ps(z_y, _mm256_set1_ps(-1.f)),
+							_mm256_set1_ps(1.f));
+		__m256 clamped_z = _mm256_min_ps(_mm256_max_ps(z_z, _mm256_set1_ps(-1.3f)),
+							_mm256_set1_ps(1.3f));
+		z_x = _mm256_sub_ps(_mm256_mul_ps(fold, clamped_x), z_x);
+		z_y = _mm256_sub_ps(_mm256_mul_ps(fold, clamped_y), z_y);
+		z_z = _mm256_sub_ps(_mm256_mul_ps(fold, clamped_z), z_z);
+
+		__m256 r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(z_x, z_x),
+			_mm256_mul_ps(z_y, z_y)), _mm256_mul_ps(z_z, z_z));
+		__m256 k = _mm256_max_ps(_mm256_div_ps(fold, r2), _mm256_set1_ps(0.027f));
+		z_x = _mm256_mul_ps(z_x, k);
+		z_y = _mm256_mul_ps(z_y, k);
+		z_z = _mm256_mul_ps(z_z, k);
+		scale = _mm256_mul_ps(scale, k);
+	}
+
+	__m256 l = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(z_x, z_x), _mm256_mul_ps(z_y, z_y)));
+	__m256 rxy = _mm256_sub_ps(l, _mm256_set1_ps(4.f));
+	__m256 n = _mm256_mul_ps(l, z_z);
+	rxy = _mm256_max_ps(rxy, _mm256_div_ps(n, _mm256_set1_ps(-4.f)));
+
+	return _mm256_div_ps(rxy, _mm256_andnot_ps(_mm256_set1_ps(-0.f), scale));
+}
+
+// Mandelbulb, AVX2 (8 positions):
+FRACRENDER_AVX2 void signed_distance_function_mandelbulb_x8_avx2(
+			const FracRenderVector3x8 *positions, float parameter, float *distances)
+{
+	_mm256_storeu_ps(distances, mandelbulb_avx2(_mm256_loadu_ps(positions->x),
+		_mm256_loadu_ps(positions->y), _mm256_loadu_ps(positions->z), parameter));
+}
+
+// Hall of Pillars, AVX2 (8 positions):
+FRACRENDER_AVX2 void signed_distance_function_hall_of_pillars_x8_avx2(
+			const FracRenderVector3x8 *positions, float parameter, float *distances)
+{
+	_mm256_storeu_ps(distances, hall_of_pillars_avx2(_mm256_loadu_ps(positions->x),
+		_mm256_loadu_ps(positions->y), _mm256_loadu_ps(positions->z), parameter));
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef FRACRENDER_SDF_3D_SIMD_H
+#define FRACRENDER_SDF_3D_SIMD_H
+
+/*******************************************************************
+ * Distance estimators evaluating 8 positions at a time (SSE, AVX) *
+ *******************************************************************/
+
+// Library includes:
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FRACRENDER_SDF_3D_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Local includes:
+#include "../Utility/Vectors.h"
+
+/**************
+ * Structures *
+ **************/
+
+// 8 positions in structure-of-arrays form:
+typedef struct {
+	float x[8];
+	float y[8];
+	float z[8];
+} FracRenderVector3x8;
+
+// Distance estimator for 8 positions, with the fractal parameter (power for Mandelbulb, fold
+// scale for Hall of Pillars):
+typedef void (*FracRenderSDF3DBatchFunction)(const FracRenderVector3x8 *positions,
+						float parameter, float *distances);
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Get the best supported instruction set. -1 = auto, 0 = scalar, 1 = SSE4.1, 2 = AVX2:
+int get_sdf_3d_instruction_set(int requested_instruction_set);
+
+// Get name of instruction set:
+const char *get_sdf_3d_instruction_set_name(int instruction_set);
+
+// Get batch distance estimator for a fractal type and instruction set:
+FracRenderSDF3DBatchFunction get_sdf_3d_batch_function(int fractal_type, int instruction_set);
+
+// Scalar fallbacks:
+void signed_distance_function_mandelbulb_x8_scalar(const FracRenderVector3x8 *positions,
+						float parameter, float *distances);
+void signed_distance_function_hall_of_pillars_x8_scalar(const FracRenderVector3x8 *positions,
+						float parameter, float *distances);
+
+#ifdef FRACRENDER_SDF_3D_SIMD_X86
+// SSE4.1 (2 x 4 positions):
+void signed_distance_function_mandelbulb_x8_sse4(const FracRenderVector3x8 *positions,
+						float parameter, float *distances);
+void signed_distance_function_hall_of_pillars_x8_sse4(const FracRenderVector3x8 *positions,
+						float parameter, float *distances);
+
+// AVX2 (8 positions):
+void signed_distance_function_mandelbulb_x8_avx2(const FracRenderVector3x8 *positions,
+						float parameter, float *distances);
+void signed_distance_function_hall_of_pillars_x8_avx2(const FracRenderVector3x8 *positions,
+						float parameter, float *distances);
+#endif
+
+#endif
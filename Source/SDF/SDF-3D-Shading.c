@@ -0,0 +1,104 @@
+#include "SDF-3D-Shading.h"
+
+// Get index of the first shading entry in the data, after the voxels:
+uint32_t get_sdf_3d_shading_offset(FracRenderSDF3D *sdf_3d)
+{
+	// Voxels take up a whole number of bytes, but not always of entries:
+	size_t bytes = (size_t)sdf_3d->num_voxels * get_sdf_3d_format_size(sdf_3d->format);
+	return (bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+}
+
+// Get number of shading entries (0 without them):
+uint32_t get_sdf_3d_shading_size(FracRenderSDF3D *sdf_3d)
+{
+	if (sdf_3d->shading == 0) { return 0; }
+
+	return sdf_3d->num_voxels;
+}
+
+// Store the shading of the 8 voxels of a cube one level above max resolution (size is half a
+// voxel's length, leaves are the voxel distances):
+void store_sdf_3d_shading(FracRenderSDF3D *sdf_3d, uint32_t code, float size,
+					FracRenderVector3 centre, const float *leaves)
+{
+	uint32_t *shading = (uint32_t *)sdf_3d->voxels + get_sdf_3d_shading_offset(sdf_3d) +
+								((size_t)code * 8);
+
+	// Cubes well clear of the surface are never blended from. Voxels inside always could be,
+	// as estimates inside the fractal don't bound the distance:
+	int near_surface = 0;
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if ((isnan(leaves[i])) ||
+			(leaves[i] <= (FRACRENDER_SDF_3D_SHADING_BAND * 2.f * size)))
+		{
+			near_surface = 1;
+		}
+	}
+	if (near_surface == 0)
+	{
+		memset(shading, 0, 8 * sizeof(uint32_t));
+		return;
+	}
+
+	FracRenderVector3x8 positions;
+	get_sdf_3d_sub_cube_centres(size, centre, &positions);
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		FracRenderVector3 position = initialize_vector_3(positions.x[i], positions.y[i],
+									positions.z[i]);
+		shading[i] = encode_sdf_3d_orbit_trap(get_sdf_3d_orbit_trap(position,
+									sdf_3d->parameter));
+	}
+}
+
+// Get the orbit trap colour at a point (before it is swizzled and offset):
+FracRenderVector3 get_sdf_3d_orbit_trap(FracRenderVector3 position, float parameter)
+{
+	FracRenderVector3 reference_point = initialize_vector_3(
+		FRACRENDER_SDF_3D_SHADING_REFERENCE_X, FRACRENDER_SDF_3D_SHADING_REFERENCE_Y,
+		FRACRENDER_SDF_3D_SHADING_REFERENCE_Z);
+
+	// Minimum distance from the reference point along each axis, over the iterations:
+	FracRenderVector3 z = position;
+	FracRenderVector3 colour = initialize_vector_3(fabsf(z.x - reference_point.x),
+		fabsf(z.y - reference_point.y), fabsf(z.z - reference_point.z));
+
+	for (int i = 0; i < FRACRENDER_SDF_3D_SHADING_ITERATIONS; i++)
+	{
+		float r = length(z);
+		if ((r > FRACRENDER_SDF_3D_SHADING_ESCAPE_RADIUS) || (r == 0.f)) { break; }
+
+		// Convert position to spherical coordinates, scale and rotate:
+		float theta = acosf(z.z / r) * parameter;
+		float phi = atan2f(z.y, z.x) * parameter;
+		float zr = powf(r, parameter);
+
+		// Convert position back to Cartesian coordinates:
+		z.x = (zr * sinf(theta) * cosf(phi)) + position.x;
+		z.y = (zr * sinf(phi) * sinf(theta)) + position.y;
+		z.z = (zr * cosf(theta)) + position.z;
+
+		colour.x = fminf(colour.x, fabsf(z.x - reference_point.x));
+		colour.y = fminf(colour.y, fabsf(z.y - reference_point.y));
+		colour.z = fminf(colour.z, fabsf(z.z - reference_point.z));
+	}
+
+	return colour;
+}
+
+// Pack an orbit trap colour as three 10-bit values, with the top bit set:
+uint32_t encode_sdf_3d_orbit_trap(FracRenderVector3 colour)
+{
+	float channels[3] = { colour.x, colour.y, colour.z };
+	uint32_t packed = 1u << 31;
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		float value = channels[i] / FRACRENDER_SDF_3D_SHADING_COLOUR_RANGE;
+		value = fminf(fmaxf(value, 0.f), 1.f);
+		packed |= (uint32_t)roundf(value * 1023.f) << (10 * i);
+	}
+
+	return packed;
+}
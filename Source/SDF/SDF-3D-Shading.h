@@ -0,0 +1,66 @@
+#ifndef FRACRENDER_SDF_3D_SHADING_H
+#define FRACRENDER_SDF_3D_SHADING_H
+
+/************************************************************************
+ * Shading terms of the Mandelbulb's dense 3D SDF, stored for each voxel *
+ ***********************************************************************/
+
+// Library includes:
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Local includes:
+#include "../Utility/Vectors.h"
+#include "SDF-3D.h"
+
+/*
+ * The colour pass iterates the Mandelbulb again at every pixel for its orbit trap colour. With
+ * shading stored, one entry per voxel follows the voxels (starting at the next whole entry, see
+ * get_sdf_3d_shading_offset), in the voxels' Morton order: the orbit trap term of
+ * colour_function_mandelbulb, before it is swizzled and offset, as three 10-bit values from 0 to
+ * FRACRENDER_SDF_3D_SHADING_COLOUR_RANGE (x in the low bits), and the top bit set so a stored
+ * colour is never 0.
+ *
+ * Only voxels the colour pass can blend from (no more than FRACRENDER_SDF_3D_SHADING_BAND
+ * voxel lengths from the surface) are worked out. The entry is 0 anywhere else, and the colour
+ * pass falls back to iterating.
+ */
+
+// Orbit trap iterations and reference point (as in Colour-Mandelbulb.frag):
+#define FRACRENDER_SDF_3D_SHADING_ITERATIONS 4
+#define FRACRENDER_SDF_3D_SHADING_ESCAPE_RADIUS 2.f
+#define FRACRENDER_SDF_3D_SHADING_REFERENCE_X 1.f
+#define FRACRENDER_SDF_3D_SHADING_REFERENCE_Y 0.75f
+#define FRACRENDER_SDF_3D_SHADING_REFERENCE_Z 0.5f
+
+// Largest orbit trap colour stored (bigger values are clamped):
+#define FRACRENDER_SDF_3D_SHADING_COLOUR_RANGE 4.f
+
+// Voxel lengths from the surface worked out:
+#define FRACRENDER_SDF_3D_SHADING_BAND 2.f
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Get index of the first shading entry in the data, after the voxels:
+uint32_t get_sdf_3d_shading_offset(FracRenderSDF3D *sdf_3d);
+
+// Get number of shading entries (0 without them):
+uint32_t get_sdf_3d_shading_size(FracRenderSDF3D *sdf_3d);
+
+// Store the shading of the 8 voxels of a cube one level above max resolution (size is half a
+// voxel's length, leaves are the voxel distances):
+void store_sdf_3d_shading(FracRenderSDF3D *sdf_3d, uint32_t code, float size,
+					FracRenderVector3 centre, const float *leaves);
+
+// Get the orbit trap colour at a point (before it is swizzled and offset):
+FracRenderVector3 get_sdf_3d_orbit_trap(FracRenderVector3 position, float parameter);
+
+// Pack an orbit trap colour as three 10-bit values, with the top bit set:
+uint32_t encode_sdf_3d_orbit_trap(FracRenderVector3 colour);
+
+#endif
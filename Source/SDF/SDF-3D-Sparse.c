@@ -0,0 +1,279 @@
+#include "SDF-3D-Sparse.h"
+
+// Calculate sparse octree 3D SDF:
+int create_sdf_3d_sparse(FracRenderSDF3D *sdf_3d)
+{
+	if (sdf_3d->levels < 1)
+	{
+		fprintf(stderr, "Error: Sparse 3D SDF needs at least 1 level!\n");
+		return -1;
+	}
+
+	// Split the octree into subtrees. Each task subdivides the cube at the split level:
+	FracRenderSDF3DSparseBuild build;
+	build.sdf_3d		= sdf_3d;
+	build.split_level	= 3;
+	if (build.split_level > (sdf_3d->levels - 1)) { build.split_level = sdf_3d->levels - 1; }
+	build.num_tasks		= pow(8, build.split_level);
+	build.total_nodes	= (build.num_tasks - 1) / 7;
+	build.max_total_nodes	= sdf_3d->memory_budget / (8 * sizeof(uint32_t));
+	build.tasks_completed	= 0;
+
+	build.subtrees = calloc(build.num_tasks, sizeof(FracRenderSDF3DSparseSubtree));
+	if (!build.subtrees)
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for sparse 3D SDF subtrees!\n");
+		return -1;
+	}
+
+	printf(" ---> Calculating distance values (sparse octree).\n");
+	printf("      - Threads: %d.\n", sdf_3d->num_threads);
+	printf("      - Instruction set: %s.\n",
+		get_sdf_3d_instruction_set_name(sdf_3d->instruction_set));
+	printf("      - Subtrees: %d.\n", build.num_tasks);
+	printf("      --->   0.0%%.\n");
+
+	struct timespec start_time;
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	int result = run_work_pool(sdf_3d->num_threads, build.num_tasks,
+					create_sdf_3d_sparse_task, &build);
+	if (result == 0)
+	{
+		printf(" ---> Joining subtrees.\n");
+		result = join_sdf_3d_sparse_subtrees(&build);
+	}
+
+	for (uint32_t i = 0; i < build.num_tasks; i++)
+	{
+		free(build.subtrees[i].entries);
+	}
+	free(build.subtrees);
+
+	if (result != 0) { return -1; }
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	double seconds = (double)(end_time.tv_sec - start_time.tv_sec) +
+			((double)(end_time.tv_nsec - start_time.tv_nsec) / 1000000000.0);
+
+	size_t memory_used = (size_t)sdf_3d->num_node_entries * sizeof(uint32_t);
+	double dense_memory = pow(8, sdf_3d->levels) * sizeof(float);
+	printf("      - Time taken: %.3lf seconds.\n", seconds);
+	printf("      - Nodes: %d.\n", sdf_3d->num_node_entries / 8);
+	printf("      - Memory used: %lu bytes (%lu MB).\n", memory_used,
+						memory_used / (1024 * 1024));
+	printf("      - Dense SDF would use: %.0lf MB (%.1lfx more).\n",
+		dense_memory / (1024 * 1024), dense_memory / (double)memory_used);
+
+	return 0;
+}
+
+// Calculate one subtree of the sparse octree (work pool task):
+int create_sdf_3d_sparse_task(void *build_data, uint32_t task_index)
+{
+	FracRenderSDF3DSparseBuild *build = build_data;
+	FracRenderSDF3DSparseSubtree *subtree = &build->subtrees[task_index];
+
+	// Walk down to the subtree's cube:
+	float size;
+	FracRenderVector3 centre;
+	get_sdf_3d_cube(build->sdf_3d, build->split_level, task_index, &size, &centre);
+
+	// The cube itself is always subdivided, and is node 0 of the subtree:
+	uint32_t root_node;
+	if (add_sdf_3d_sparse_node(build, subtree, &root_node) != 0) { return -1; }
+	if (create_sdf_3d_sparse_node(build, subtree, root_node, size, centre,
+						build->split_level) != 0)
+	{
+		return -1;
+	}
+
+	print_sdf_3d_progress(&build->tasks_completed, build->num_tasks);
+
+	return 0;
+}
+
+// Fill in the 8 entries of a node, subdividing sub-cubes the surface may pass through:
+int create_sdf_3d_sparse_node(FracRenderSDF3DSparseBuild *build,
+	FracRenderSDF3DSparseSubtree *subtree, uint32_t node, float size,
+	FracRenderVector3 centre, uint32_t level)
+{
+	FracRenderSDF3D *sdf_3d = build->sdf_3d;
+
+	// Distance estimates at the centres of the 8 sub-cubes:
+	FracRenderVector3x8 positions;
+	get_sdf_3d_sub_cube_centres(size / 2.f, centre, &positions);
+
+	float distances[8];
+	sdf_3d->batch_distance_function(&positions, sdf_3d->parameter, distances);
+
+	for (int i = 0; i < 8; i++)
+	{
+		float distance_estimate = distances[i];
+		float half_diagonal = sqrt(3.f) * (size / 2.f);
+
+		// Stop if the surface can't reach into the sub-cube. Only outside, as estimates
+		// inside the fractal don't bound the distance (as in create_sdf_3d_cube):
+		if (distance_estimate > half_diagonal)
+		{
+			// To guarantee underestimate, take away half length of diagonal of cube:
+			subtree->entries[(node * 8) + i] =
+				encode_sdf_3d_sparse_leaf(distance_estimate - half_diagonal);
+			continue;
+		}
+
+		// Stop at max resolution, shrinking the estimate towards the surface on either side
+		// (as in create_sdf_3d_leaves):
+		if ((level + 1) == sdf_3d->levels)
+		{
+			distance_estimate -= (distance_estimate / fabs(distance_estimate)) *
+									half_diagonal;
+			subtree->entries[(node * 8) + i] =
+				encode_sdf_3d_sparse_leaf(distance_estimate);
+			continue;
+		}
+
+		// Subdivide. Adding a node can move the entries, so look them up again after:
+		uint32_t child_node;
+		if (add_sdf_3d_sparse_node(build, subtree, &child_node) != 0) { return -1; }
+		subtree->entries[(node * 8) + i] = encode_sdf_3d_sparse_node(child_node);
+
+		FracRenderVector3 child_centre = initialize_vector_3(positions.x[i],
+						positions.y[i], positions.z[i]);
+		if (create_sdf_3d_sparse_node(build, subtree, child_node, size / 2.f,
+						child_centre, level + 1) != 0)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+// Add a node (8 entries) to a subtree:
+int add_sdf_3d_sparse_node(FracRenderSDF3DSparseBuild *build,
+			FracRenderSDF3DSparseSubtree *subtree, uint32_t *node)
+{
+	// Check against the limit for all subtrees together:
+	if (__atomic_add_fetch(&build->total_nodes, 1, __ATOMIC_RELAXED) > build->max_total_nodes)
+	{
+		fprintf(stderr, "Error: Sparse 3D SDF tried to allocate more than the memory"
+			" budget (%lu MB)!\n", build->sdf_3d->memory_budget / (1024 * 1024));
+		return -1;
+	}
+
+	// Grow the subtree's entries if needed:
+	if (subtree->num_nodes == subtree->max_nodes)
+	{
+		uint32_t max_nodes = 64;
+		if (subtree->max_nodes > 0) { max_nodes = subtree->max_nodes * 2; }
+
+		uint32_t *entries = realloc(subtree->entries,
+					(size_t)max_nodes * 8 * sizeof(uint32_t));
+		if (!entries)
+		{
+			fprintf(stderr, "Error: Unable to allocate memory for sparse 3D SDF!\n");
+			return -1;
+		}
+
+		subtree->entries = entries;
+		subtree->max_nodes = max_nodes;
+	}
+
+	*node = subtree->num_nodes;
+	subtree->num_nodes++;
+
+	return 0;
+}
+
+// Join the top levels and all subtrees into one node buffer:
+int join_sdf_3d_sparse_subtrees(FracRenderSDF3DSparseBuild *build)
+{
+	FracRenderSDF3D *sdf_3d = build->sdf_3d;
+
+	// Nodes above the split level come first, then each subtree in turn:
+	uint32_t top_nodes = (build->num_tasks - 1) / 7;
+	uint32_t *subtree_offsets = malloc(build->num_tasks * sizeof(uint32_t));
+	if (!subtree_offsets)
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for sparse 3D SDF subtrees!\n");
+		return -1;
+	}
+
+	uint32_t num_nodes = top_nodes;
+	for (uint32_t i = 0; i < build->num_tasks; i++)
+	{
+		subtree_offsets[i] = num_nodes;
+		num_nodes += build->subtrees[i].num_nodes;
+	}
+
+	sdf_3d->num_node_entries = num_nodes * 8;
+	sdf_3d->nodes = malloc((size_t)sdf_3d->num_node_entries * sizeof(uint32_t));
+	if (!sdf_3d->nodes)
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for sparse 3D SDF!\n");
+		free(subtree_offsets);
+		return -1;
+	}
+
+	// Top levels, fully subdivided and stored level by level:
+	uint32_t first_node = 0;
+	for (uint32_t level = 0; level < build->split_level; level++)
+	{
+		uint32_t level_nodes = pow(8, level);
+		uint32_t next_first_node = first_node + level_nodes;
+
+		for (uint32_t i = 0; i < level_nodes; i++)
+		{
+			for (uint32_t j = 0; j < 8; j++)
+			{
+				uint32_t child = (i * 8) + j;
+				uint32_t child_node;
+				if ((level + 1) < build->split_level)
+				{
+					child_node = next_first_node + child;
+				}
+				else { child_node = subtree_offsets[child]; }
+
+				sdf_3d->nodes[((first_node + i) * 8) + j] =
+					encode_sdf_3d_sparse_node(child_node);
+			}
+		}
+
+		first_node = next_first_node;
+	}
+
+	// Subtrees, with their child node indices moved along by the subtree's offset:
+	for (uint32_t i = 0; i < build->num_tasks; i++)
+	{
+		FracRenderSDF3DSparseSubtree *subtree = &build->subtrees[i];
+		uint32_t *destination = &sdf_3d->nodes[subtree_offsets[i] * 8];
+
+		for (uint32_t j = 0; j < (subtree->num_nodes * 8); j++)
+		{
+			uint32_t entry = subtree->entries[j];
+			if (entry & 1) { entry += subtree_offsets[i] << 1; }
+			destination[j] = entry;
+		}
+	}
+
+	free(subtree_offsets);
+
+	return 0;
+}
+
+// Encode a leaf distance as a node entry:
+uint32_t encode_sdf_3d_sparse_leaf(float distance)
+{
+	uint32_t entry;
+	memcpy(&entry, &distance, sizeof(uint32_t));
+
+	return entry & ~1u;
+}
+
+// Encode a child node index as a node entry:
+uint32_t encode_sdf_3d_sparse_node(uint32_t node)
+{
+	return (node << 1) | 1;
+}
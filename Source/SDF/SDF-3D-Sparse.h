@@ -0,0 +1,87 @@
+#ifndef FRACRENDER_SDF_3D_SPARSE_H
+#define FRACRENDER_SDF_3D_SPARSE_H
+
+/****************************************************************************
+ * Sparse octree 3D SDF, only subdivided where the surface may pass through *
+ ****************************************************************************/
+
+// Library includes:
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local includes:
+#include "../Utility/Vectors.h"
+#include "../Utility/Work-Pool.h"
+#include "SDF-3D.h"
+
+/*
+ * Layout of the node buffer (read as uint by the SDF shaders):
+ * - Each node is 8 consecutive entries, one per sub-cube, in the same order as the dense SDF.
+ * - Node 0 is the main cube.
+ * - Entry with lowest bit set: (index of child node << 1) | 1.
+ * - Entry with lowest bit clear: leaf distance, as float bits. Clearing the lowest mantissa
+ *   bit rounds the distance towards zero, so it stays an underestimate.
+ */
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// Nodes of one subtree, indexed from the subtree's own root node (0):
+	uint32_t *entries;
+	uint32_t num_nodes;
+	uint32_t max_nodes;
+} FracRenderSDF3DSparseSubtree;
+
+typedef struct {
+	// SDF being calculated:
+	FracRenderSDF3D *sdf_3d;
+
+	// Level at which the octree is split into independent subtrees (one per task). All
+	// levels above it are fully subdivided:
+	uint32_t split_level;
+	uint32_t num_tasks;
+	FracRenderSDF3DSparseSubtree *subtrees;
+
+	// Nodes allocated by all tasks, and the limit (the memory budget):
+	uint32_t total_nodes;
+	uint32_t max_total_nodes;
+
+	// Progress:
+	uint32_t tasks_completed;
+} FracRenderSDF3DSparseBuild;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Calculate sparse octree 3D SDF:
+int create_sdf_3d_sparse(FracRenderSDF3D *sdf_3d);
+
+// Calculate one subtree of the sparse octree (work pool task):
+int create_sdf_3d_sparse_task(void *build_data, uint32_t task_index);
+
+// Fill in the 8 entries of a node, subdividing sub-cubes the surface may pass through:
+int create_sdf_3d_sparse_node(FracRenderSDF3DSparseBuild *build,
+	FracRenderSDF3DSparseSubtree *subtree, uint32_t node, float size,
+	FracRenderVector3 centre, uint32_t level);
+
+// Add a node (8 entries) to a subtree:
+int add_sdf_3d_sparse_node(FracRenderSDF3DSparseBuild *build,
+			FracRenderSDF3DSparseSubtree *subtree, uint32_t *node);
+
+// Join the top levels and all subtrees into one node buffer:
+int join_sdf_3d_sparse_subtrees(FracRenderSDF3DSparseBuild *build);
+
+// Encode a leaf distance as a node entry:
+uint32_t encode_sdf_3d_sparse_leaf(float distance);
+
+// Encode a child node index as a node entry:
+uint32_t encode_sdf_3d_sparse_node(uint32_t node);
+
+#endif
@@ -0,0 +1,161 @@
+#include "SDF-3D-Symmetry.h"
+
+// Get the order of rotational symmetry the SDF can be folded by (0 if it can't be):
+uint32_t get_sdf_3d_symmetry_order(FracRenderSDF3D *sdf_3d)
+{
+	if ((sdf_3d->fractal_type != 0) || (sdf_3d->parameter != floorf(sdf_3d->parameter)) ||
+		(sdf_3d->parameter < FRACRENDER_SDF_3D_SYMMETRY_MIN_POWER))
+	{
+		return 0;
+	}
+
+	return (uint32_t)sdf_3d->parameter - 1;
+}
+
+// Calculate the stored cubes of a folded dense 3D SDF into sdf_3d->voxels (already allocated):
+int create_sdf_3d_symmetry(FracRenderSDF3D *sdf_3d)
+{
+	if (sdf_3d->levels < 3)
+	{
+		fprintf(stderr, "Error: Folded 3D SDF needs at least 3 levels!\n");
+		return -1;
+	}
+
+	printf(" ---> Calculating distance values (wedge of %u-fold symmetry).\n",
+								sdf_3d->symmetry);
+	printf("      - Threads: %d.\n", sdf_3d->num_threads);
+	printf("      - Instruction set: %s.\n",
+		get_sdf_3d_instruction_set_name(sdf_3d->instruction_set));
+	printf("      - Cubes: %d of 64 at level 2.\n", FRACRENDER_SDF_3D_SYMMETRY_CUBES);
+	printf("      --->   0.0%%.\n");
+
+	struct timespec start_time;
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	// Each stored cube is an ordinary dense SDF of its own:
+	uint32_t cubes_completed = 0;
+	uint64_t num_culled = 0;
+	for (uint32_t slot = 0; slot < FRACRENDER_SDF_3D_SYMMETRY_CUBES; slot++)
+	{
+		FracRenderSDF3D cube;
+		get_sdf_3d_symmetry_cube(sdf_3d, slot, &cube);
+
+		FracRenderSDF3DBuild build;
+		if (set_up_sdf_3d_build(&cube, &build) != 0) { return -1; }
+		build.quiet = 1;
+		if (run_sdf_3d_build(&build, 0, build.num_tasks) != 0) { return -1; }
+
+		num_culled += build.num_culled;
+		print_sdf_3d_progress(&cubes_completed, FRACRENDER_SDF_3D_SYMMETRY_CUBES);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	double seconds = (double)(end_time.tv_sec - start_time.tv_sec) +
+			((double)(end_time.tv_nsec - start_time.tv_nsec) / 1000000000.0);
+	if (seconds <= 0.0) { seconds = 1e-9; }
+
+	printf("      - Time taken: %.3lf seconds.\n", seconds);
+	printf("      - Voxels per second: %.0lf.\n", (double)sdf_3d->num_voxels / seconds);
+	if (sdf_3d->cull == 1)
+	{
+		printf("      - Voxels culled: %.1lf%%.\n",
+			(100.0 * (double)num_culled) / (double)sdf_3d->num_voxels);
+	}
+	printf("      - Unfolded SDF would have: %.0lf voxels (%ux more).\n",
+		pow(8, sdf_3d->levels), 64 / FRACRENDER_SDF_3D_SYMMETRY_CUBES);
+
+	return 0;
+}
+
+// Set up a copy of the SDF covering one stored cube, calculated into its part of the voxels:
+void get_sdf_3d_symmetry_cube(FracRenderSDF3D *sdf_3d, uint32_t slot, FracRenderSDF3D *cube)
+{
+	// Quarter of the main cube along each side, x from 0 to size, y from 0 to size / 2:
+	float size = sdf_3d->size / 4.f;
+	uint32_t x_half = slot & 1;
+	uint32_t z_quarter = slot >> 1;
+
+	*cube = *sdf_3d;
+	cube->levels		= sdf_3d->levels - 2;
+	cube->size		= size;
+	cube->centre		= initialize_vector_3(
+					sdf_3d->centre.x + size + (2.f * size * x_half),
+					sdf_3d->centre.y + size,
+					sdf_3d->centre.z + (3.f * size) - (2.f * size * z_quarter));
+	cube->num_voxels	= pow(8, cube->levels);
+	cube->symmetry		= 0;
+	cube->voxels		= (char *)sdf_3d->voxels + ((size_t)slot * cube->num_voxels *
+					get_sdf_3d_format_size(sdf_3d->format));
+}
+
+// Find the planes through the origin the distance function is mirrored in, by sampling it
+// around the cube (bit 0 = x, bit 1 = y, bit 2 = z):
+uint32_t find_sdf_3d_mirrors(FracRenderSDF3D *sdf_3d)
+{
+	uint32_t mirrors = 0;
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		// Same points for each axis, from a fixed seed:
+		uint32_t seed = 1;
+		int mirrored = 1;
+		for (uint32_t i = 0; i < FRACRENDER_SDF_3D_MIRROR_SAMPLES; i++)
+		{
+			if (mirrored == 0) { break; }
+
+			FracRenderVector3x8 positions;
+			for (uint32_t j = 0; j < 24; j++)
+			{
+				seed = (seed * 1664525u) + 1013904223u;
+				float offset = (((float)(seed >> 8) / 8388608.f) - 1.f) * sdf_3d->size;
+				if (j < 8) { positions.x[j] = sdf_3d->centre.x + offset; }
+				else if (j < 16) { positions.y[j - 8] = sdf_3d->centre.y + offset; }
+				else { positions.z[j - 16] = sdf_3d->centre.z + offset; }
+			}
+
+			// Same points, on the other side of the plane:
+			FracRenderVector3x8 mirror_positions = positions;
+			float *coordinates = mirror_positions.x;
+			if (axis == 1) { coordinates = mirror_positions.y; }
+			else if (axis == 2) { coordinates = mirror_positions.z; }
+			for (uint32_t j = 0; j < 8; j++) { coordinates[j] = -coordinates[j]; }
+
+			float distances[8];
+			float mirror_distances[8];
+			sdf_3d->batch_distance_function(&positions, sdf_3d->parameter, distances);
+			sdf_3d->batch_distance_function(&mirror_positions, sdf_3d->parameter,
+									mirror_distances);
+
+			for (uint32_t j = 0; j < 8; j++)
+			{
+				float difference = fabs(distances[j] - mirror_distances[j]);
+				if (difference > (FRACRENDER_SDF_3D_MIRROR_TOLERANCE *
+					(fabs(distances[j]) + fabs(mirror_distances[j]) + 1e-3f)))
+				{
+					mirrored = 0;
+				}
+			}
+		}
+
+		if (mirrored == 1) { mirrors |= 1u << axis; }
+	}
+
+	return mirrors;
+}
+
+// Fold the SDF by the planes it is mirrored in, moving the cube to their positive side:
+void set_up_sdf_3d_mirrors(FracRenderSDF3D *sdf_3d)
+{
+	sdf_3d->mirror = find_sdf_3d_mirrors(sdf_3d);
+
+	// The cube still covers the camera (after folding), and touches the plane if it was
+	// within reach of it, so the mirror image carries on from the cube:
+	float *centre[3] = { &sdf_3d->centre.x, &sdf_3d->centre.y, &sdf_3d->centre.z };
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		if (sdf_3d->mirror & (1u << axis))
+		{
+			*centre[axis] = fmaxf(fabsf(*centre[axis]), sdf_3d->size);
+		}
+	}
+}
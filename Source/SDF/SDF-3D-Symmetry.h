@@ -0,0 +1,73 @@
+#ifndef FRACRENDER_SDF_3D_SYMMETRY_H
+#define FRACRENDER_SDF_3D_SYMMETRY_H
+
+/*****************************************************************************
+ * Dense 3D SDF of the Mandelbulb, stored only for a wedge of its symmetries *
+ ****************************************************************************/
+
+// Library includes:
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local includes:
+#include "../Utility/Vectors.h"
+#include "SDF-3D.h"
+
+/*
+ * With a whole number power n, the Mandelbulb is the same after turning it by 2 pi / (n - 1)
+ * around the z-axis, and after mirroring it in y = 0 (checked against the distance estimator
+ * for n = 8, to within float rounding). It isn't mirrored in z = 0. Any point can be folded
+ * into the wedge between 0 and pi / (n - 1) around z (measured from +x towards +y) without
+ * changing the distance, so only the wedge needs storing.
+ *
+ * For n of at least 7 the wedge fits in x from 0 to size and y from 0 to size / 2 (relative to
+ * the centre), over the whole height: 8 of the 64 cubes at level 2, an eighth of the voxels.
+ * Each cube is a dense grid in Morton order (levels - 2 levels), and they are stored one after
+ * another, with slot = (z quarter, counting down from +z) * 2 + (x half, counting up).
+ *
+ * Corners of the main cube (more than size from the z-axis) fold outside the stored cubes, and
+ * are estimated directly by the shaders.
+ *
+ * The Hall of Pillars doesn't repeat, but it is mirrored in some of the planes through the
+ * origin (x = 0 and z = 0, for any fold scale). Those are found by sampling the distance
+ * function either side of each plane, and the cube is moved to their positive side. Lookups
+ * take the absolute value of the mirrored coordinates first, so the same voxels also cover the
+ * cube's mirror images: up to 4 times the volume when mirrored in two planes.
+ */
+
+// Smallest power whose wedge fits in the stored cubes (pi / (n - 1) with sine up to 1 / 2):
+#define FRACRENDER_SDF_3D_SYMMETRY_MIN_POWER 7
+
+// Cubes at level 2 which are stored:
+#define FRACRENDER_SDF_3D_SYMMETRY_CUBES 8
+
+// Batches of 8 points sampled either side of each plane, and how close the distances must be:
+#define FRACRENDER_SDF_3D_MIRROR_SAMPLES 256
+#define FRACRENDER_SDF_3D_MIRROR_TOLERANCE 1e-5f
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Get the order of rotational symmetry the SDF can be folded by (0 if it can't be):
+uint32_t get_sdf_3d_symmetry_order(FracRenderSDF3D *sdf_3d);
+
+// Calculate the stored cubes of a folded dense 3D SDF into sdf_3d->voxels (already allocated):
+int create_sdf_3d_symmetry(FracRenderSDF3D *sdf_3d);
+
+// Set up a copy of the SDF covering one stored cube, calculated into its part of the voxels:
+void get_sdf_3d_symmetry_cube(FracRenderSDF3D *sdf_3d, uint32_t slot,
+							FracRenderSDF3D *cube);
+
+// Find the planes through the origin the distance function is mirrored in, by sampling it
+// around the cube (bit 0 = x, bit 1 = y, bit 2 = z):
+uint32_t find_sdf_3d_mirrors(FracRenderSDF3D *sdf_3d);
+
+// Fold the SDF by the planes it is mirrored in, moving the cube to their positive side:
+void set_up_sdf_3d_mirrors(FracRenderSDF3D *sdf_3d);
+
+#endif
@@ -0,0 +1,496 @@
+#include "SDF-3D-Transform.h"
+
+// Calculate a dense 3D SDF into sdf_3d->voxels (already allocated) by distance transform:
+int create_sdf_3d_transform(FracRenderSDF3D *sdf_3d)
+{
+	if (sdf_3d->levels < 1)
+	{
+		fprintf(stderr, "Error: 3D SDF needs at least 1 level!\n");
+		return -1;
+	}
+
+	FracRenderSDF3DTransform transform;
+	memset(&transform, 0, sizeof(FracRenderSDF3DTransform));
+	transform.sdf_3d	= sdf_3d;
+	transform.resolution	= 1u << sdf_3d->levels;
+	if (transform.resolution > FRACRENDER_SDF_3D_TRANSFORM_MAX_RESOLUTION)
+	{
+		fprintf(stderr, "Error: 3D SDF distance transform can have at most 10 levels!\n");
+		return -1;
+	}
+
+	// Split the octree into subtrees, as the dense build does:
+	transform.split_level	= 3;
+	if (transform.split_level > (sdf_3d->levels - 1))
+	{
+		transform.split_level = sdf_3d->levels - 1;
+	}
+	transform.num_tasks		= pow(8, transform.split_level);
+	transform.voxels_per_task	= sdf_3d->num_voxels / transform.num_tasks;
+
+	// Grid and flags, only needed while calculating:
+	size_t num_voxels = sdf_3d->num_voxels;
+	size_t memory_required = num_voxels * (sizeof(float) + sizeof(uint8_t));
+	transform.squared_distances	= malloc(num_voxels * sizeof(float));
+	transform.flags			= malloc(num_voxels * sizeof(uint8_t));
+	transform.face_minimums		= malloc(transform.num_tasks * 6 * sizeof(float));
+
+	printf(" ---> Calculating distance values (narrow band and distance transform).\n");
+	printf("      - Threads: %d.\n", sdf_3d->num_threads);
+	printf("      - Instruction set: %s.\n",
+		get_sdf_3d_instruction_set_name(sdf_3d->instruction_set));
+	printf("      - Temporary memory: %lu bytes (%lu MB).\n", memory_required,
+						memory_required / (1024 * 1024));
+
+	int result = 0;
+	if ((!transform.squared_distances) || (!transform.flags) || (!transform.face_minimums))
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for 3D SDF transform!\n");
+		result = -1;
+	}
+
+	// Band:
+	struct timespec start_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	if (result == 0)
+	{
+		printf("      --->   0.0%%.\n");
+		result = run_work_pool(sdf_3d->num_threads, transform.num_tasks,
+					create_sdf_3d_band_task, &transform);
+	}
+
+	if (result == 0)
+	{
+		printf("      - Band: %.3lf seconds.\n", get_sdf_3d_transform_seconds(&start_time));
+		printf("      - Voxels estimated: %lu (%.1lf%%).\n", transform.num_estimated,
+			(100.0 * (double)transform.num_estimated) / (double)sdf_3d->num_voxels);
+		printf("      - Seeds: %lu.\n", transform.num_seeds);
+	}
+
+	// Transform, one axis at a time:
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	for (int axis = 0; (axis < 3) && (result == 0); axis++)
+	{
+		result = run_sdf_3d_transform_pass(&transform, axis);
+	}
+
+	if (result == 0)
+	{
+		printf("      - Transform: %.3lf seconds.\n",
+				get_sdf_3d_transform_seconds(&start_time));
+	}
+
+	// Write, after bringing the face minimums together (estimates inside count as zero):
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	if (result == 0)
+	{
+		for (uint32_t i = 1; i < transform.num_tasks; i++)
+		{
+			for (int j = 0; j < 6; j++)
+			{
+				float minimum = transform.face_minimums[(i * 6) + j];
+				if (minimum < transform.face_minimums[j])
+				{
+					transform.face_minimums[j] = minimum;
+				}
+			}
+		}
+		for (int j = 0; j < 6; j++)
+		{
+			if (!(transform.face_minimums[j] > 0.f))
+			{
+				transform.face_minimums[j] = 0.f;
+			}
+		}
+
+		result = run_work_pool(sdf_3d->num_threads, transform.num_tasks,
+					write_sdf_3d_transform_task, &transform);
+	}
+
+	if (result == 0)
+	{
+		printf("      - Writing voxels: %.3lf seconds.\n",
+				get_sdf_3d_transform_seconds(&start_time));
+	}
+
+	free(transform.squared_distances);
+	free(transform.flags);
+	free(transform.face_minimums);
+
+	return result;
+}
+
+// Estimate distances near the surface in one subtree, and find its seeds (work pool task):
+int create_sdf_3d_band_task(void *transform_data, uint32_t task_index)
+{
+	FracRenderSDF3DTransform *transform = transform_data;
+
+	float size;
+	FracRenderVector3 centre;
+	get_sdf_3d_cube(transform->sdf_3d, transform->split_level, task_index, &size, &centre);
+
+	float face_minimums[6];
+	for (int i = 0; i < 6; i++) { face_minimums[i] = INFINITY; }
+
+	create_sdf_3d_band_cube(transform, transform->split_level, task_index, size, centre,
+									face_minimums);
+
+	memcpy(&transform->face_minimums[task_index * 6], face_minimums, 6 * sizeof(float));
+
+	print_sdf_3d_progress(&transform->tasks_completed, transform->num_tasks);
+
+	return 0;
+}
+
+// Walk down a cube (size is half the cube's length), skipping sub-cubes clear of the surface:
+void create_sdf_3d_band_cube(FracRenderSDF3DTransform *transform, uint32_t level,
+	uint32_t code, float size, FracRenderVector3 centre, float *face_minimums)
+{
+	FracRenderSDF3D *sdf_3d = transform->sdf_3d;
+	uint32_t resolution = transform->resolution;
+
+	// Distance estimates at the centres of the 8 sub-cubes:
+	FracRenderVector3x8 positions;
+	get_sdf_3d_sub_cube_centres(size / 2.f, centre, &positions);
+
+	float distances[8];
+	sdf_3d->batch_distance_function(&positions, sdf_3d->parameter, distances);
+
+	float half_diagonal = sqrt(3.f) * (size / 2.f);
+
+	// One level above max resolution, the sub-cubes are the voxels:
+	if ((level + 1) == sdf_3d->levels)
+	{
+		uint64_t num_seeds = 0;
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			uint32_t voxel_code = (code << 3) + i;
+			uint32_t x, y, z;
+			get_sdf_3d_morton_coordinates(voxel_code, &x, &y, &z);
+			size_t voxel = x + ((size_t)y * resolution) +
+					((size_t)z * resolution * resolution);
+
+			// Estimated voxel, underestimated as the dense build does. The surface may
+			// pass through it if the estimate is no bigger than its half diagonal, or
+			// anywhere inside the fractal, as estimates there don't bound the distance:
+			float distance_estimate = distances[i];
+			float leaf = distance_estimate - half_diagonal;
+			if (distance_estimate < 0.f) { leaf = distance_estimate + half_diagonal; }
+			encode_sdf_3d_voxel(sdf_3d, sdf_3d->voxels, sdf_3d->format, voxel_code,
+										leaf);
+
+			transform->flags[voxel] = 4;
+			if (distance_estimate < 0.f) { transform->flags[voxel] |= 1; }
+			if (distance_estimate <= half_diagonal)
+			{
+				transform->flags[voxel] |= 2;
+				transform->squared_distances[voxel] = 0.f;
+				num_seeds++;
+			}
+			else
+			{
+				transform->squared_distances[voxel] =
+						FRACRENDER_SDF_3D_TRANSFORM_FAR;
+			}
+
+			add_sdf_3d_face_minimum(transform, x, y, z, 1,
+				distance_estimate - half_diagonal, face_minimums);
+		}
+
+		__atomic_add_fetch(&transform->num_estimated, 8, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&transform->num_seeds, num_seeds, __ATOMIC_RELAXED);
+		return;
+	}
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		uint32_t sub_cube_code = (code << 3) + i;
+
+		// Well clear of the surface (outside only, as in the culled dense build):
+		if (distances[i] > (FRACRENDER_SDF_3D_CULL_MARGIN * half_diagonal))
+		{
+			clear_sdf_3d_band_cube(transform, level + 1, sub_cube_code);
+
+			uint32_t x, y, z;
+			uint32_t shift = 3 * (sdf_3d->levels - level - 1);
+			get_sdf_3d_morton_coordinates(sub_cube_code << shift, &x, &y, &z);
+			add_sdf_3d_face_minimum(transform, x, y, z,
+				1u << (sdf_3d->levels - level - 1),
+				distances[i] - half_diagonal, face_minimums);
+			continue;
+		}
+
+		FracRenderVector3 sub_cube_centre = initialize_vector_3(positions.x[i],
+						positions.y[i], positions.z[i]);
+		create_sdf_3d_band_cube(transform, level + 1, sub_cube_code, size / 2.f,
+						sub_cube_centre, face_minimums);
+	}
+}
+
+// Mark the voxels of a cube as outside and not seeds:
+void clear_sdf_3d_band_cube(FracRenderSDF3DTransform *transform, uint32_t level,
+								uint32_t code)
+{
+	uint32_t resolution = transform->resolution;
+	uint32_t levels = transform->sdf_3d->levels;
+	uint32_t length = 1u << (levels - level);
+
+	// The cube's first Morton code is its lowest corner:
+	uint32_t x_start, y_start, z_start;
+	get_sdf_3d_morton_coordinates(code << (3 * (levels - level)),
+					&x_start, &y_start, &z_start);
+
+	for (uint32_t z = z_start; z < (z_start + length); z++)
+	{
+		for (uint32_t y = y_start; y < (y_start + length); y++)
+		{
+			size_t voxel = x_start + ((size_t)y * resolution) +
+					((size_t)z * resolution * resolution);
+			for (uint32_t x = 0; x < length; x++)
+			{
+				transform->squared_distances[voxel + x] =
+					FRACRENDER_SDF_3D_TRANSFORM_FAR;
+				transform->flags[voxel + x] = 0;
+			}
+		}
+	}
+}
+
+// Lower a subtree's face minimums with the estimate for a box of voxels (Morton coordinates):
+void add_sdf_3d_face_minimum(FracRenderSDF3DTransform *transform, uint32_t x, uint32_t y,
+			uint32_t z, uint32_t length, float distance, float *face_minimums)
+{
+	uint32_t coordinates[3] = {x, y, z};
+	for (int i = 0; i < 3; i++)
+	{
+		if ((coordinates[i] == 0) && (distance < face_minimums[i * 2]))
+		{
+			face_minimums[i * 2] = distance;
+		}
+		if (((coordinates[i] + length) == transform->resolution) &&
+			(distance < face_minimums[(i * 2) + 1]))
+		{
+			face_minimums[(i * 2) + 1] = distance;
+		}
+	}
+}
+
+// Run one pass of the distance transform over all lines along an axis:
+int run_sdf_3d_transform_pass(FracRenderSDF3DTransform *transform, int axis)
+{
+	transform->axis = axis;
+
+	return run_work_pool(transform->sdf_3d->num_threads, transform->resolution,
+					create_sdf_3d_transform_task, transform);
+}
+
+// Transform the lines of one plane along the current axis (work pool task):
+int create_sdf_3d_transform_task(void *transform_data, uint32_t task_index)
+{
+	FracRenderSDF3DTransform *transform = transform_data;
+	size_t resolution = transform->resolution;
+
+	// First voxel of each line, and the step along it:
+	size_t stride;
+	size_t line_stride;
+	size_t plane_start;
+	if (transform->axis == 0)
+	{
+		stride = 1;
+		line_stride = resolution;
+		plane_start = task_index * resolution * resolution;
+	}
+	else if (transform->axis == 1)
+	{
+		stride = resolution;
+		line_stride = 1;
+		plane_start = task_index * resolution * resolution;
+	}
+	else
+	{
+		stride = resolution * resolution;
+		line_stride = 1;
+		plane_start = task_index * resolution;
+	}
+
+	// Lines across memory are gathered a block at a time, to use whole cache lines:
+	size_t block_size = FRACRENDER_SDF_3D_TRANSFORM_BLOCK_SIZE;
+	if ((stride == 1) || (block_size > resolution)) { block_size = 1; }
+
+	float lines[FRACRENDER_SDF_3D_TRANSFORM_BLOCK_SIZE]
+				[FRACRENDER_SDF_3D_TRANSFORM_MAX_RESOLUTION];
+	for (size_t i = 0; i < resolution; i += block_size)
+	{
+		float *samples = &transform->squared_distances[plane_start + (i * line_stride)];
+		for (size_t j = 0; j < resolution; j++)
+		{
+			for (size_t k = 0; k < block_size; k++)
+			{
+				lines[k][j] = samples[(j * stride) + (k * line_stride)];
+			}
+		}
+
+		for (size_t k = 0; k < block_size; k++)
+		{
+			transform_sdf_3d_line(lines[k], resolution);
+		}
+
+		for (size_t j = 0; j < resolution; j++)
+		{
+			for (size_t k = 0; k < block_size; k++)
+			{
+				samples[(j * stride) + (k * line_stride)] = lines[k][j];
+			}
+		}
+	}
+
+	return 0;
+}
+
+// Squared distance transform of one line of samples, in place:
+void transform_sdf_3d_line(float *line, uint32_t length)
+{
+	// Lower envelope of parabolas rooted at each sample. Parabola i covers from boundaries[i]
+	// to boundaries[i + 1]:
+	uint32_t parabolas[FRACRENDER_SDF_3D_TRANSFORM_MAX_RESOLUTION];
+	float boundaries[FRACRENDER_SDF_3D_TRANSFORM_MAX_RESOLUTION + 1];
+	float samples[FRACRENDER_SDF_3D_TRANSFORM_MAX_RESOLUTION];
+	memcpy(samples, line, length * sizeof(float));
+
+	uint32_t k = 0;
+	parabolas[0] = 0;
+	boundaries[0] = -INFINITY;
+	boundaries[1] = INFINITY;
+	for (uint32_t q = 1; q < length; q++)
+	{
+		// Where the new parabola crosses the last one, dropping any parabola it hides:
+		float intersection;
+		while (1)
+		{
+			uint32_t p = parabolas[k];
+			intersection = ((samples[q] + (float)(q * q)) -
+					(samples[p] + (float)(p * p))) / (float)(2 * (q - p));
+			if ((intersection > boundaries[k]) || (k == 0)) { break; }
+			k--;
+		}
+
+		k++;
+		parabolas[k] = q;
+		boundaries[k] = intersection;
+		boundaries[k + 1] = INFINITY;
+	}
+
+	// Each sample takes the parabola covering it:
+	k = 0;
+	for (uint32_t q = 0; q < length; q++)
+	{
+		while (boundaries[k + 1] < (float)q) { k++; }
+		float offset = (float)q - (float)parabolas[k];
+		line[q] = (offset * offset) + samples[parabolas[k]];
+	}
+}
+
+// Turn squared distances into voxel distances for one subtree (work pool task):
+int write_sdf_3d_transform_task(void *transform_data, uint32_t task_index)
+{
+	FracRenderSDF3DTransform *transform = transform_data;
+	FracRenderSDF3D *sdf_3d = transform->sdf_3d;
+	uint32_t resolution = transform->resolution;
+	float *face_minimums = transform->face_minimums;
+
+	float voxel_size = (2.f * sdf_3d->size) / (float)resolution;
+	float diagonal = sqrt(3.f) * voxel_size;
+
+	// Stored the way the dense build stores them:
+	FracRenderSDF3DBuild build;
+	memset(&build, 0, sizeof(FracRenderSDF3DBuild));
+	build.sdf_3d		= sdf_3d;
+	build.split_level	= transform->split_level;
+
+	uint32_t first_code = task_index * transform->voxels_per_task;
+	uint32_t last_code = first_code + transform->voxels_per_task;
+	for (uint32_t code = first_code; code < last_code; code += 8)
+	{
+		float leaves[8];
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			uint32_t x, y, z;
+			get_sdf_3d_morton_coordinates(code + i, &x, &y, &z);
+			size_t voxel = x + ((size_t)y * resolution) +
+					((size_t)z * resolution * resolution);
+			uint8_t flags = transform->flags[voxel];
+
+			// Seeds keep their estimate:
+			if (flags & 2)
+			{
+				leaves[i] = decode_sdf_3d_voxel(sdf_3d, code + i);
+				continue;
+			}
+
+			// Nearest seed, less both half diagonals:
+			float bound = INFINITY;
+			float squared_distance = transform->squared_distances[voxel];
+			if (squared_distance < (FRACRENDER_SDF_3D_TRANSFORM_FAR / 2.f))
+			{
+				bound = (sqrt(squared_distance) * voxel_size) - diagonal;
+			}
+
+			// Surface outside the main cube is at least as far as the nearest face:
+			uint32_t coordinates[3] = {x, y, z};
+			for (int j = 0; j < 3; j++)
+			{
+				float low = ((float)coordinates[j] * voxel_size) +
+							face_minimums[j * 2];
+				float high = ((float)(resolution - 1 - coordinates[j]) *
+						voxel_size) + face_minimums[(j * 2) + 1];
+				if (low < bound) { bound = low; }
+				if (high < bound) { bound = high; }
+			}
+			if (bound < 0.f) { bound = 0.f; }
+
+			// Estimated voxels keep whichever is bigger:
+			if (flags & 4)
+			{
+				float estimate = fabs(decode_sdf_3d_voxel(sdf_3d, code + i));
+				if (estimate > bound) { bound = estimate; }
+			}
+
+			if (flags & 1) { leaves[i] = -bound; }
+			else { leaves[i] = bound; }
+		}
+
+		store_sdf_3d_leaves(&build, code >> 3, leaves);
+	}
+
+	return 0;
+}
+
+// Get the voxel coordinates in a Morton code (x counting up, y and z counting down):
+void get_sdf_3d_morton_coordinates(uint32_t code, uint32_t *x, uint32_t *y, uint32_t *z)
+{
+	*x = compact_sdf_3d_morton_bits(code);
+	*z = compact_sdf_3d_morton_bits(code >> 1);
+	*y = compact_sdf_3d_morton_bits(code >> 2);
+}
+
+// Gather every third bit of a Morton code (up to 10 levels) into the low bits:
+uint32_t compact_sdf_3d_morton_bits(uint32_t code)
+{
+	code &= 0x09249249;
+	code = (code ^ (code >> 2)) & 0x030C30C3;
+	code = (code ^ (code >> 4)) & 0x0300F00F;
+	code = (code ^ (code >> 8)) & 0x030000FF;
+	code = (code ^ (code >> 16)) & 0x000003FF;
+
+	return code;
+}
+
+// Get seconds since a time:
+double get_sdf_3d_transform_seconds(struct timespec *start_time)
+{
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+	return (double)(end_time.tv_sec - start_time->tv_sec) +
+		((double)(end_time.tv_nsec - start_time->tv_nsec) / 1000000000.0);
+}
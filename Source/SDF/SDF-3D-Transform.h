@@ -0,0 +1,124 @@
+#ifndef FRACRENDER_SDF_3D_TRANSFORM_H
+#define FRACRENDER_SDF_3D_TRANSFORM_H
+
+/**********************************************************************************
+ * Dense 3D SDF from a narrow band of distance estimates and a distance transform *
+ **********************************************************************************/
+
+// Library includes:
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local includes:
+#include "../Utility/Vectors.h"
+#include "../Utility/Work-Pool.h"
+#include "SDF-3D.h"
+
+/*
+ * Three phases:
+ * - Band: walk down the octree as the culled dense build does, estimating distances only for
+ *   voxels near the surface. Voxels the surface may pass through (estimate no bigger than their
+ *   half diagonal, which includes every voxel inside the fractal) are seeds.
+ * - Transform: exact squared distance from every voxel centre to the nearest seed centre, in
+ *   voxels. One pass along each axis, each line on its own (Felzenszwalb and Huttenlocher).
+ * - Write: surface is somewhere in the nearest seed, so the distance to it is at least the
+ *   distance between centres, less both half diagonals. Surface outside the main cube isn't
+ *   seen by the transform, so this is capped by the distance to each face of the cube plus the
+ *   smallest estimate on that face. Estimated voxels keep whichever bound is bigger.
+ *
+ * The grid is indexed by the voxel coordinates in the Morton code (x counting up, y and z
+ * counting down, see SDF-3D.h), at x + (y * res) + (z * res^2).
+ */
+
+// Squared distance of voxels with no seed in reach yet (finite, so the transform never
+// subtracts infinities):
+#define FRACRENDER_SDF_3D_TRANSFORM_FAR 1e20f
+
+// Longest line the transform handles (dense layout has at most 10 levels):
+#define FRACRENDER_SDF_3D_TRANSFORM_MAX_RESOLUTION 1024
+
+// Lines across memory (y and z passes) transformed together:
+#define FRACRENDER_SDF_3D_TRANSFORM_BLOCK_SIZE 16
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// SDF being calculated, and voxels along each side:
+	FracRenderSDF3D *sdf_3d;
+	uint32_t resolution;
+
+	// Squared distance to the nearest seed centre (in voxels), and flags (1 = Inside,
+	// 2 = Seed, 4 = Estimated), of each voxel in the grid:
+	float *squared_distances;
+	uint8_t *flags;
+
+	// Level at which the octree is split into independent subtrees (one per band task):
+	uint32_t split_level;
+	uint32_t num_tasks;
+	uint32_t voxels_per_task;
+
+	// Smallest estimate on each face of the main cube (low x, high x, low y, high y, low z,
+	// high z), 6 per subtree:
+	float *face_minimums;
+
+	// Axis of the transform pass running (0 = x, 1 = y, 2 = z):
+	int axis;
+
+	// Voxels estimated and seeds found:
+	uint64_t num_estimated;
+	uint64_t num_seeds;
+
+	// Progress:
+	uint32_t tasks_completed;
+} FracRenderSDF3DTransform;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Calculate a dense 3D SDF into sdf_3d->voxels (already allocated) by distance transform:
+int create_sdf_3d_transform(FracRenderSDF3D *sdf_3d);
+
+// Estimate distances near the surface in one subtree, and find its seeds (work pool task):
+int create_sdf_3d_band_task(void *transform_data, uint32_t task_index);
+
+// Walk down a cube (size is half the cube's length), skipping sub-cubes clear of the surface:
+void create_sdf_3d_band_cube(FracRenderSDF3DTransform *transform, uint32_t level,
+	uint32_t code, float size, FracRenderVector3 centre, float *face_minimums);
+
+// Mark the voxels of a cube as outside and not seeds:
+void clear_sdf_3d_band_cube(FracRenderSDF3DTransform *transform, uint32_t level,
+								uint32_t code);
+
+// Lower a subtree's face minimums with the estimate for a box of voxels (Morton coordinates):
+void add_sdf_3d_face_minimum(FracRenderSDF3DTransform *transform, uint32_t x, uint32_t y,
+			uint32_t z, uint32_t length, float distance, float *face_minimums);
+
+// Run one pass of the distance transform over all lines along an axis:
+int run_sdf_3d_transform_pass(FracRenderSDF3DTransform *transform, int axis);
+
+// Transform the lines of one plane along the current axis (work pool task):
+int create_sdf_3d_transform_task(void *transform_data, uint32_t task_index);
+
+// Squared distance transform of one line of samples, in place:
+void transform_sdf_3d_line(float *line, uint32_t length);
+
+// Turn squared distances into voxel distances for one subtree (work pool task):
+int write_sdf_3d_transform_task(void *transform_data, uint32_t task_index);
+
+// Get the voxel coordinates in a Morton code (x counting up, y and z counting down):
+void get_sdf_3d_morton_coordinates(uint32_t code, uint32_t *x, uint32_t *y, uint32_t *z);
+
+// Gather every third bit of a Morton code (up to 10 levels) into the low bits:
+uint32_t compact_sdf_3d_morton_bits(uint32_t code);
+
+// Get seconds since a time:
+double get_sdf_3d_transform_seconds(struct timespec *start_time);
+
+#endif
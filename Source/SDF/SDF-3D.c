@@ -1,7 +1,15 @@
 #include "SDF-3D.h"
-
-// Set up 3D SDF structure:
-void set_up_sdf_3d(FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d)
+#include "SDF-3D-Sparse.h"
+#include "SDF-3D-Bricks.h"
+#include "SDF-3D-Cache.h"
+#include "SDF-3D-Clipmap.h"
+#include "SDF-3D-Transform.h"
+#include "SDF-3D-Symmetry.h"
+#include "SDF-3D-Shading.h"
+
+// Set up 3D SDF structure, within the memory of the device (in bytes, 0 = Unknown):
+void set_up_sdf_3d(FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d,
+							size_t device_memory)
 {
 	// If 3D SDF is not being used, stop:
 	if (program_state->optimize != 0) { return; }
@@ -10,7 +18,6 @@ void set_up_sdf_3d(FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3
 	if (program_state->fractal_type == 0)
 	{
 		sdf_3d->levels		= 8;
-		sdf_3d->num_voxels	= pow(8, sdf_3d->levels);
 		sdf_3d->size		= 1.2f;
 
 		sdf_3d->centre		= initialize_vector_3(0.f, 0.f, 0.f);
@@ -18,20 +25,258 @@ void set_up_sdf_3d(FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3
 	else
 	{
 		sdf_3d->levels		= 9;
-		sdf_3d->num_voxels	= pow(8, sdf_3d->levels);
 		sdf_3d->size		= 500.f;
 
 		sdf_3d->centre = program_state->position;
 	}
 
+	// Clipmap cascades are each a smaller dense grid. The biggest one is the usual cube:
+	sdf_3d->layout = program_state->sdf_layout;
+	if (sdf_3d->layout == 2) { sdf_3d->levels = 7; }
+
+	// Levels given as a setting:
+	if (program_state->sdf_levels > 0) { sdf_3d->levels = program_state->sdf_levels; }
+	if (sdf_3d->levels > 16)
+	{
+		printf("Warning: 3D SDF can have at most 16 levels. Using 16.\n");
+		sdf_3d->levels = 16;
+	}
+	if ((sdf_3d->layout == 2) && (sdf_3d->levels > 8))
+	{
+		printf("Warning: 3D SDF clipmap cascades can have at most 8 levels. Using 8.\n");
+		sdf_3d->levels = 8;
+	}
+	if ((sdf_3d->layout == 3) && (sdf_3d->levels > 10))
+	{
+		printf("Warning: 3D SDF bricks can have at most 10 levels. Using 10.\n");
+		sdf_3d->levels = 10;
+	}
+	if ((sdf_3d->layout == 3) && (sdf_3d->levels <= FRACRENDER_SDF_3D_BRICK_LEVELS))
+	{
+		printf("Warning: 3D SDF bricks need at least 4 levels. Using 4.\n");
+		sdf_3d->levels = FRACRENDER_SDF_3D_BRICK_LEVELS + 1;
+	}
+
+	// Layout. Voxels are only counted up front for the dense and clipmap layouts:
+	sdf_3d->texture = program_state->sdf_texture;
+	sdf_3d->format = program_state->sdf_format;
+	sdf_3d->num_cascades = 0;
+	if (sdf_3d->layout == 2) { sdf_3d->num_cascades = FRACRENDER_SDF_3D_CLIPMAP_CASCADES; }
+	sdf_3d->num_voxels = get_sdf_3d_num_voxels(sdf_3d);
+
 	sdf_3d->fractal_type	= program_state->fractal_type;
+	sdf_3d->parameter	= program_state->fractal_parameter;
+	sdf_3d->num_threads	= get_number_of_threads(program_state->sdf_threads);
+	sdf_3d->instruction_set	= get_sdf_3d_instruction_set(program_state->sdf_simd);
+	sdf_3d->batch_distance_function = get_sdf_3d_batch_function(sdf_3d->fractal_type,
+									sdf_3d->instruction_set);
 	sdf_3d->voxels		= NULL;
+	sdf_3d->num_node_entries = 0;
+	sdf_3d->nodes		= NULL;
+	sdf_3d->cache		= program_state->sdf_cache;
+	sdf_3d->cache_mapping	= NULL;
+	sdf_3d->cache_mapping_size = 0;
+	sdf_3d->deferred	= 0;
+	sdf_3d->bake		= program_state->sdf_bake;
+	sdf_3d->cull		= program_state->sdf_cull;
+	sdf_3d->transform	= program_state->sdf_transform;
+
+	// Folding by the Mandelbulb's symmetry needs a power it holds for, and the stored cubes
+	// (level 2) to be split further:
+	sdf_3d->symmetry = 0;
+	sdf_3d->mirror = 0;
+	if ((program_state->sdf_symmetry == 1) && (sdf_3d->fractal_type == 0) &&
+		(sdf_3d->layout == 0))
+	{
+		sdf_3d->symmetry = get_sdf_3d_symmetry_order(sdf_3d);
+		if (sdf_3d->symmetry == 0)
+		{
+			printf("Warning: 3D SDF can only be folded for a whole number power of at"
+				" least %d. Storing all of it.\n",
+				FRACRENDER_SDF_3D_SYMMETRY_MIN_POWER);
+		}
+		else if (sdf_3d->levels < 3)
+		{
+			printf("Warning: Folded 3D SDF needs at least 3 levels. Using 3.\n");
+			sdf_3d->levels = 3;
+		}
+	}
+
+	// The Hall of Pillars goes on forever, so its mirror images widen what the same voxels
+	// cover instead. Clipmaps move with the camera:
+	if ((program_state->sdf_symmetry == 1) && (sdf_3d->fractal_type == 1) &&
+		(sdf_3d->layout != 2))
+	{
+		set_up_sdf_3d_mirrors(sdf_3d);
+		if (sdf_3d->mirror == 0)
+		{
+			printf("Warning: 3D SDF isn't mirrored in any plane through the origin."
+				" Storing all of it.\n");
+		}
+	}
+
+	// Shading is worked out alongside the voxels as they are calculated on the CPU, and only
+	// matches the Mandelbulb's colour function:
+	sdf_3d->shading = 0;
+	if ((program_state->sdf_shading == 1) && (sdf_3d->fractal_type == 0) &&
+		(sdf_3d->layout == 0) && (sdf_3d->texture == 0) && (sdf_3d->bake == 0) &&
+		(sdf_3d->transform == 0) && (sdf_3d->symmetry == 0))
+	{
+		sdf_3d->shading = 1;
+	}
+
+	// Fewer levels or a smaller format if the SDF is too big for the device or the host:
+	fit_sdf_3d_memory_budget(sdf_3d, program_state->sdf_memory, device_memory);
+
+	// Clipmaps move with the camera, so there is nothing worth caching:
+	if (sdf_3d->layout == 2) { sdf_3d->cache = 0; }
+
+	// Load 3D SDF if it was calculated before:
+	sdf_3d->final_levels = 0;
+	if ((sdf_3d->cache == 1) && (load_sdf_3d_cache(sdf_3d) == 0)) { return; }
+
+	// Otherwise start with a coarse SDF, refined in the background once rendering. Only the
+	// full SDF is cached:
+	if ((program_state->sdf_progressive > 0) && (sdf_3d->layout == 0) &&
+		(sdf_3d->texture == 0) && (sdf_3d->num_voxels > 0) && (sdf_3d->symmetry == 0) &&
+		((uint32_t)program_state->sdf_progressive < sdf_3d->levels))
+	{
+		sdf_3d->final_levels	= sdf_3d->levels;
+		sdf_3d->levels		= program_state->sdf_progressive;
+		sdf_3d->num_voxels	= pow(8, sdf_3d->levels);
+		sdf_3d->cache		= 0;
+	}
+
+	// Dense voxels in a storage buffer are calculated later, straight into memory the GPU can
+	// copy from (see copy_sdf_3d_data). The distance transform needs the whole grid at once:
+	if ((sdf_3d->layout == 0) && (sdf_3d->texture == 0) && (sdf_3d->num_voxels > 0) &&
+		(sdf_3d->transform == 0) && (sdf_3d->symmetry == 0) &&
+		(get_sdf_3d_data_size(sdf_3d) <= sdf_3d->memory_budget))
+	{
+		sdf_3d->deferred = 1;
+		return;
+	}
 
-	// Create 3D SDF:
+	// Create 3D SDF, and save it for next time:
 	if (create_sdf_3d(sdf_3d) != 0)
 	{
 		destroy_sdf_3d(sdf_3d);
 	}
+	else if (sdf_3d->cache == 1) { save_sdf_3d_cache(sdf_3d); }
+}
+
+// Fewer levels or a smaller format if the SDF is too big for the device or the host. The
+// budget is the smallest of the setting (in MB, 0 = None), the device's memory (in bytes,
+// 0 = Unknown), half the host's memory, and FRACRENDER_SDF_3D_MAX_MEMORY:
+void fit_sdf_3d_memory_budget(FracRenderSDF3D *sdf_3d, int setting, size_t device_memory)
+{
+	printf("----------------------------------------");
+	printf("----------------------------------------\n");
+	printf("Fitting 3D SDF in memory...\n");
+
+	size_t host_memory = get_sdf_3d_host_memory();
+	size_t budget = FRACRENDER_SDF_3D_MAX_MEMORY;
+	if ((setting > 0) && (((size_t)setting * 1024 * 1024) < budget))
+	{
+		budget = (size_t)setting * 1024 * 1024;
+	}
+	if ((device_memory > 0) && (device_memory < budget)) { budget = device_memory; }
+	if ((host_memory > 0) && (host_memory < budget)) { budget = host_memory; }
+	sdf_3d->memory_budget = budget;
+
+	printf(" ---> Memory budget: %lu MB.\n", budget / (1024 * 1024));
+	if (setting > 0) { printf("      - Setting: %d MB.\n", setting); }
+	if (device_memory > 0)
+	{
+		printf("      - Device: %lu MB.\n", device_memory / (1024 * 1024));
+	}
+	if (host_memory > 0)
+	{
+		printf("      - Host (half): %lu MB.\n", host_memory / (1024 * 1024));
+	}
+
+	// Sparse and brick pool SDFs only find out how much memory they need as they are
+	// calculated, and stop if it goes over the budget:
+	sdf_3d->predicted_memory = 0;
+	if ((sdf_3d->layout == 1) || (sdf_3d->layout == 3))
+	{
+		printf(" ---> Memory predicted: depends on the surface.\n");
+		printf("... Done.\n");
+		printf("----------------------------------------");
+		printf("----------------------------------------\n\n");
+		return;
+	}
+
+	// Deepest levels that fit, trying the smaller formats at each level before taking one
+	// off (clipmaps are always 32-bit floats):
+	uint32_t requested_levels = sdf_3d->levels;
+	int requested_format = sdf_3d->format;
+	while (1)
+	{
+		sdf_3d->num_voxels = get_sdf_3d_num_voxels(sdf_3d);
+		sdf_3d->predicted_memory = get_sdf_3d_data_size(sdf_3d);
+		if (((sdf_3d->num_voxels > 0) && (sdf_3d->predicted_memory <= budget)) ||
+			(sdf_3d->levels == 1))
+		{
+			break;
+		}
+
+		if ((sdf_3d->layout == 0) && (sdf_3d->num_voxels > 0) && (sdf_3d->format < 2))
+		{
+			sdf_3d->format++;
+		}
+		else
+		{
+			sdf_3d->levels--;
+			sdf_3d->format = requested_format;
+		}
+	}
+
+	if ((sdf_3d->levels != requested_levels) || (sdf_3d->format != requested_format))
+	{
+		printf("Warning: 3D SDF of %u levels (%s) doesn't fit in the memory budget. Using"
+			" %u levels (%s).\n", requested_levels,
+			get_sdf_3d_format_name(requested_format), sdf_3d->levels,
+			get_sdf_3d_format_name(sdf_3d->format));
+	}
+
+	printf(" ---> Memory predicted: %lu bytes (%lu MB).\n", sdf_3d->predicted_memory,
+					sdf_3d->predicted_memory / (1024 * 1024));
+	printf("      - Levels: %u.\n", sdf_3d->levels);
+	printf("      - Format: %s.\n", get_sdf_3d_format_name(sdf_3d->format));
+
+	printf("... Done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+}
+
+// Get half the host's physical memory, in bytes (0 if unknown):
+size_t get_sdf_3d_host_memory()
+{
+	long num_pages = sysconf(_SC_PHYS_PAGES);
+	long page_size = sysconf(_SC_PAGE_SIZE);
+	if ((num_pages <= 0) || (page_size <= 0)) { return 0; }
+
+	return ((size_t)num_pages * (size_t)page_size) / 2;
+}
+
+// Get number of voxels of the dense and clipmap layouts (0 for the others, or if there are
+// too many to count in 32 bits):
+uint32_t get_sdf_3d_num_voxels(FracRenderSDF3D *sdf_3d)
+{
+	// A folded SDF keeps an eighth of the voxels:
+	if ((sdf_3d->layout == 0) && (sdf_3d->symmetry > 0))
+	{
+		if ((sdf_3d->levels < 3) || (sdf_3d->levels > 11)) { return 0; }
+		return (pow(8, sdf_3d->levels) * FRACRENDER_SDF_3D_SYMMETRY_CUBES) / 64;
+	}
+	if ((sdf_3d->layout == 0) && (sdf_3d->levels <= 10)) { return pow(8, sdf_3d->levels); }
+	if ((sdf_3d->layout == 2) && (sdf_3d->levels <= 9))
+	{
+		return sdf_3d->num_cascades * pow(8, sdf_3d->levels);
+	}
+
+	return 0;
 }
 
 // Calculate 3D SDF:
@@ -41,27 +286,96 @@ int create_sdf_3d(FracRenderSDF3D *sdf_3d)
 	printf("----------------------------------------\n");
 	printf("Creating 3D SDF...\n");
 
+	if (sdf_3d->layout == 1)
+	{
+		// Sparse octree:
+		if (create_sdf_3d_sparse(sdf_3d) != 0) { return -1; }
+
+		printf("... Done.\n");
+		printf("----------------------------------------");
+		printf("----------------------------------------\n\n");
+
+		return 0;
+	}
+	else if (sdf_3d->layout == 3)
+	{
+		// Bricks of full resolution voxels near the surface:
+		if (create_sdf_3d_bricks(sdf_3d) != 0) { return -1; }
+
+		printf("... Done.\n");
+		printf("----------------------------------------");
+		printf("----------------------------------------\n\n");
+
+		return 0;
+	}
+	else if (sdf_3d->layout == 2)
+	{
+		// Clipmap cascades around the centre:
+		if (create_sdf_3d_clipmap(sdf_3d) != 0) { return -1; }
+
+		printf("... Done.\n");
+		printf("----------------------------------------");
+		printf("----------------------------------------\n\n");
+
+		return 0;
+	}
+
 	// Allocate memory for the SDF:
 	printf(" ---> Allocating memory.\n");
-	size_t memory_required = sdf_3d->num_voxels * sizeof(float);
+	size_t memory_required = get_sdf_3d_data_size(sdf_3d);
 
-	if ((memory_required / (1024 * 1024)) > 2000)
+	if ((sdf_3d->num_voxels == 0) || (memory_required > sdf_3d->memory_budget))
 	{
-		fprintf(stderr, "Error: Tried to allocate more than 2GB!\n");
+		fprintf(stderr, "Error: Tried to allocate more than the memory budget (%lu MB)!\n",
+						sdf_3d->memory_budget / (1024 * 1024));
 		return -1;
 	}
 
 	sdf_3d->voxels = malloc(memory_required);
+	printf("      - Format: %s.\n", get_sdf_3d_format_name(sdf_3d->format));
+	if (sdf_3d->shading == 1)
+	{
+		printf("      - Shading: %u entries.\n", get_sdf_3d_shading_size(sdf_3d));
+	}
 	printf("      - Memory allocated: %lu bytes (%lu MB).\n", memory_required,
 						memory_required / (1024 * 1024));
 
-	printf(" ---> Calculating distance values.\n");
-	uint32_t current_index = 0;
-	if (create_sdf_3d_helper(sdf_3d, sdf_3d->size, sdf_3d->centre, &current_index, 0) != 0)
+	if (!sdf_3d->voxels)
 	{
+		fprintf(stderr, "Error: Unable to allocate memory for 3D SDF!\n");
 		return -1;
 	}
 
+	// Only the wedge of the Mandelbulb's symmetry:
+	if (sdf_3d->symmetry > 0)
+	{
+		if (create_sdf_3d_symmetry(sdf_3d) != 0) { return -1; }
+
+		printf("... Done.\n");
+		printf("----------------------------------------");
+		printf("----------------------------------------\n\n");
+
+		return 0;
+	}
+
+	// Narrow band and distance transform:
+	if (sdf_3d->transform == 1)
+	{
+		if (create_sdf_3d_transform(sdf_3d) != 0) { return -1; }
+
+		printf("... Done.\n");
+		printf("----------------------------------------");
+		printf("----------------------------------------\n\n");
+
+		return 0;
+	}
+
+	// Calculate all subtrees in one go:
+	FracRenderSDF3DBuild build;
+	if (begin_sdf_3d_build(sdf_3d, &build) != 0) { return -1; }
+	if (run_sdf_3d_build(&build, 0, build.num_tasks) != 0) { return -1; }
+	end_sdf_3d_build(&build);
+
 	printf("... Done.\n");
 	printf("----------------------------------------");
 	printf("----------------------------------------\n\n");
@@ -69,183 +383,459 @@ int create_sdf_3d(FracRenderSDF3D *sdf_3d)
 	return 0;
 }
 
-// SDF recursion helper:
-int create_sdf_3d_helper(FracRenderSDF3D *sdf_3d, float size, FracRenderVector3 centre,
-						uint32_t *current_index, uint32_t level)
+// Start calculating a dense 3D SDF into sdf_3d->voxels (already allocated):
+int begin_sdf_3d_build(FracRenderSDF3D *sdf_3d, FracRenderSDF3DBuild *build)
 {
-	// Check index:
-	if (*current_index >= sdf_3d->num_voxels)
+	if (set_up_sdf_3d_build(sdf_3d, build) != 0) { return -1; }
+
+	printf(" ---> Calculating distance values.\n");
+	printf("      - Threads: %d.\n", sdf_3d->num_threads);
+	printf("      - Instruction set: %s.\n",
+		get_sdf_3d_instruction_set_name(sdf_3d->instruction_set));
+	printf("      - Subtrees: %d.\n", build->num_tasks);
+	printf("      --->   0.0%%.\n");
+
+	return 0;
+}
+
+// Split a dense 3D SDF calculation into subtrees, without printing anything:
+int set_up_sdf_3d_build(FracRenderSDF3D *sdf_3d, FracRenderSDF3DBuild *build)
+{
+	if (sdf_3d->levels < 1)
 	{
-		fprintf(stderr, "Error: 3D SDF tried to exceed memory allocation!\n");
+		fprintf(stderr, "Error: 3D SDF needs at least 1 level!\n");
 		return -1;
 	}
 
-	if (level == sdf_3d->levels)
+	// Split the octree into subtrees. Each one is a contiguous range of Morton codes:
+	build->sdf_3d		= sdf_3d;
+	build->split_level	= 3;
+	if (build->split_level > (sdf_3d->levels - 1)) { build->split_level = sdf_3d->levels - 1; }
+	build->num_tasks	= pow(8, build->split_level);
+	build->first_task	= 0;
+	build->voxels_per_task	= sdf_3d->num_voxels / build->num_tasks;
+	build->tasks_completed	= 0;
+	build->quiet		= 0;
+	build->num_culled	= 0;
+	build->cancelled	= 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &build->start_time);
+
+	return 0;
+}
+
+// Calculate a range of subtrees. Their voxels are one contiguous range of the array:
+int run_sdf_3d_build(FracRenderSDF3DBuild *build, uint32_t first_task, uint32_t num_tasks)
+{
+	build->first_task = first_task;
+
+	return run_work_pool(build->sdf_3d->num_threads, num_tasks, create_sdf_3d_task, build);
+}
+
+// Finish calculating a dense 3D SDF, and print how long it took:
+void end_sdf_3d_build(FracRenderSDF3DBuild *build)
+{
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	double seconds = (double)(end_time.tv_sec - build->start_time.tv_sec) +
+			((double)(end_time.tv_nsec - build->start_time.tv_nsec) / 1000000000.0);
+	if (seconds <= 0.0) { seconds = 1e-9; }
+
+	printf("      - Time taken: %.3lf seconds.\n", seconds);
+	printf("      - Voxels per second: %.0lf.\n",
+		(double)build->sdf_3d->num_voxels / seconds);
+	if (build->sdf_3d->cull == 1)
 	{
-		// Max resolution. Calculate signed distance from surface:
-		if (sdf_3d->fractal_type == 1)
-		{
-			// Hall of Pillars:
-			float distance_estimate = signed_distance_function_hall_of_pillars(centre);
+		printf("      - Voxels culled: %.1lf%%.\n",
+			(100.0 * (double)build->num_culled) / (double)build->sdf_3d->num_voxels);
+	}
+}
 
-			// To guarantee underestimate, take away half length of diagonal of cube:
-			distance_estimate -= (distance_estimate / fabs(distance_estimate)) *
-									sqrt(3.f) * size;
-			sdf_3d->voxels[*current_index] = distance_estimate;
-		}
-		else
-		{
-			// Default to Mandelbulb:
-			float distance_estimate = signed_distance_function_mandelbulb(centre);
+// Calculate one subtree of the 3D SDF (work pool task):
+int create_sdf_3d_task(void *build_data, uint32_t task_index)
+{
+	FracRenderSDF3DBuild *build = build_data;
+	FracRenderSDF3D *sdf_3d = build->sdf_3d;
+	task_index += build->first_task;
+
+	if (__atomic_load_n(&build->cancelled, __ATOMIC_RELAXED) != 0) { return -1; }
+
+	// Walk down from the subtree's cube, 8 sub-cubes at a time:
+	float size;
+	FracRenderVector3 centre;
+	get_sdf_3d_cube(sdf_3d, build->split_level, task_index, &size, &centre);
+	create_sdf_3d_cube(build, build->split_level, task_index, size, centre);
+
+	if (build->quiet == 0) { print_sdf_3d_progress(&build->tasks_completed, build->num_tasks); }
+
+	return 0;
+}
 
-			// To guarantee underestimate, take away half length of diagonal of cube:
-			distance_estimate -= (distance_estimate / fabs(distance_estimate)) *
-									sqrt(3.f) * size;
-			sdf_3d->voxels[*current_index] = distance_estimate;
+// Calculate the voxels of a cube (size is half the cube's length), culling its sub-cubes if
+// they are far enough from the surface:
+void create_sdf_3d_cube(FracRenderSDF3DBuild *build, uint32_t level, uint32_t code, float size,
+							FracRenderVector3 centre)
+{
+	FracRenderSDF3D *sdf_3d = build->sdf_3d;
+
+	// One level above max resolution, the sub-cubes are the voxels:
+	if ((level + 1) == sdf_3d->levels)
+	{
+		float leaves[8];
+		create_sdf_3d_leaves(sdf_3d, size / 2.f, centre, leaves);
+		store_sdf_3d_leaves(build, code, leaves);
+		if (sdf_3d->shading == 1)
+		{
+			store_sdf_3d_shading(sdf_3d, code, size / 2.f, centre, leaves);
 		}
-		*current_index += 1;
+		return;
 	}
-	else
+
+	FracRenderVector3x8 positions;
+	get_sdf_3d_sub_cube_centres(size / 2.f, centre, &positions);
+
+	// Distance estimates at the centres of the 8 sub-cubes, if culling:
+	float distances[8];
+	if (sdf_3d->cull == 1)
 	{
-		// Split cube into 8 smaller cubes:
-		FracRenderVector3 new_centre;
+		sdf_3d->batch_distance_function(&positions, sdf_3d->parameter, distances);
+	}
 
-		// Print progress:
-		if (level == 0)
+	float half_diagonal = sqrt(3.f) * (size / 2.f);
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		FracRenderVector3 sub_cube_centre = initialize_vector_3(positions.x[i],
+						positions.y[i], positions.z[i]);
+		uint32_t sub_cube_code = (code << 3) + i;
+
+		// The surface is well clear of the sub-cube, so fill it in without calculating it.
+		// Only outside, as estimates inside the fractal don't bound the distance:
+		if ((sdf_3d->cull == 1) &&
+			(distances[i] > (FRACRENDER_SDF_3D_CULL_MARGIN * half_diagonal)))
 		{
-			printf("      --->   0.0%%.\n");
+			fill_sdf_3d_cube(build, level + 1, sub_cube_code, size / 2.f,
+				sub_cube_centre, sub_cube_centre, distances[i]);
+			uint64_t num_culled = (uint64_t)1 << (3 * (sdf_3d->levels - level - 1));
+			__atomic_add_fetch(&build->num_culled, num_culled, __ATOMIC_RELAXED);
+			continue;
 		}
 
-		// Upper, top-left cube (looking top-down):
-		new_centre.x = centre.x - (size / 2.f);
-		new_centre.y = centre.y + (size / 2.f);
-		new_centre.z = centre.z + (size / 2.f);
-		if (create_sdf_3d_helper(sdf_3d, size / 2.f, new_centre,
-					current_index, level + 1) != 0)
-		{
-			return -1;
-		}
+		create_sdf_3d_cube(build, level + 1, sub_cube_code, size / 2.f, sub_cube_centre);
+	}
+}
 
-		// Print progress:
-		if (level == 0)
-		{
-			printf("      --->  12.5%%.\n");
-		}
+// Fill in the voxels of a cube from the distance at a point, taking away how far each voxel's
+// corners can be from it:
+void fill_sdf_3d_cube(FracRenderSDF3DBuild *build, uint32_t level, uint32_t code, float size,
+	FracRenderVector3 centre, FracRenderVector3 point, float distance)
+{
+	FracRenderSDF3D *sdf_3d = build->sdf_3d;
 
-		// Upper, top-right cube:
-		new_centre.x = centre.x + (size / 2.f);
-		new_centre.y = centre.y + (size / 2.f);
-		new_centre.z = centre.z + (size / 2.f);
-		if (create_sdf_3d_helper(sdf_3d, size / 2.f, new_centre,
-					current_index, level + 1) != 0)
-		{
-			return -1;
-		}
+	FracRenderVector3x8 positions;
+	get_sdf_3d_sub_cube_centres(size / 2.f, centre, &positions);
 
-		// Print progress:
-		if (level == 0)
+	if ((level + 1) < sdf_3d->levels)
+	{
+		for (uint32_t i = 0; i < 8; i++)
 		{
-			printf("      --->  25.0%%.\n");
+			FracRenderVector3 sub_cube_centre = initialize_vector_3(positions.x[i],
+							positions.y[i], positions.z[i]);
+			fill_sdf_3d_cube(build, level + 1, (code << 3) + i, size / 2.f,
+					sub_cube_centre, point, distance);
 		}
+		return;
+	}
 
-		// Upper, bottom-left cube:
-		new_centre.x = centre.x - (size / 2.f);
-		new_centre.y = centre.y + (size / 2.f);
-		new_centre.z = centre.z - (size / 2.f);
-		if (create_sdf_3d_helper(sdf_3d, size / 2.f, new_centre,
-					current_index, level + 1) != 0)
-		{
-			return -1;
-		}
+	// The distance to the surface changes by no more than the distance moved, so taking away
+	// how far the voxel's corners are from the point keeps it an underestimate:
+	float leaves[8];
+	float half_diagonal = sqrt(3.f) * (size / 2.f);
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		float x = positions.x[i] - point.x;
+		float y = positions.y[i] - point.y;
+		float z = positions.z[i] - point.z;
+		leaves[i] = distance - (sqrt((x * x) + (y * y) + (z * z)) + half_diagonal);
+	}
 
-		// Print progress:
-		if (level == 0)
-		{
-			printf("      --->  37.5%%.\n");
-		}
+	store_sdf_3d_leaves(build, code, leaves);
+	if (sdf_3d->shading == 1)
+	{
+		store_sdf_3d_shading(sdf_3d, code, size / 2.f, centre, leaves);
+	}
+}
 
-		// Upper, bottom-right cube:
-		new_centre.x = centre.x + (size / 2.f);
-		new_centre.y = centre.y + (size / 2.f);
-		new_centre.z = centre.z - (size / 2.f);
-		if (create_sdf_3d_helper(sdf_3d, size / 2.f, new_centre,
-					current_index, level + 1) != 0)
-		{
-			return -1;
-		}
+// Store the 8 voxels of a cube one level above max resolution:
+void store_sdf_3d_leaves(FracRenderSDF3DBuild *build, uint32_t code, float *leaves)
+{
+	FracRenderSDF3D *sdf_3d = build->sdf_3d;
 
-		// Print progress:
-		if (level == 0)
-		{
-			printf("      --->  50.0%%.\n");
-		}
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		encode_sdf_3d_voxel(sdf_3d, sdf_3d->voxels, sdf_3d->format, (code << 3) + i,
+									leaves[i]);
+	}
+}
 
-		// Lower, top-left cube (looking top-down):
-		new_centre.x = centre.x - (size / 2.f);
-		new_centre.y = centre.y - (size / 2.f);
-		new_centre.z = centre.z + (size / 2.f);
-		if (create_sdf_3d_helper(sdf_3d, size / 2.f, new_centre,
-					current_index, level + 1) != 0)
-		{
-			return -1;
-		}
+// Get the cube at a level from its Morton code, halving the main cube one level at a time:
+void get_sdf_3d_cube(FracRenderSDF3D *sdf_3d, uint32_t level, uint32_t code,
+					float *size, FracRenderVector3 *centre)
+{
+	*size = sdf_3d->size;
+	*centre = sdf_3d->centre;
+	for (uint32_t i = 0; i < level; i++)
+	{
+		// Index of the cube in the row of 8, from the top 3 bits downwards:
+		uint32_t cube = (code >> (3 * (level - i - 1))) & 7;
 
-		// Print progress:
-		if (level == 0)
-		{
-			printf("      --->  62.5%%.\n");
-		}
+		if (cube & 1) { centre->x = centre->x + (*size / 2.f); }
+		else { centre->x = centre->x - (*size / 2.f); }
+		if (cube & 4) { centre->y = centre->y - (*size / 2.f); }
+		else { centre->y = centre->y + (*size / 2.f); }
+		if (cube & 2) { centre->z = centre->z - (*size / 2.f); }
+		else { centre->z = centre->z + (*size / 2.f); }
 
-		// Lower, top-right cube:
-		new_centre.x = centre.x + (size / 2.f);
-		new_centre.y = centre.y - (size / 2.f);
-		new_centre.z = centre.z + (size / 2.f);
-		if (create_sdf_3d_helper(sdf_3d, size / 2.f, new_centre,
-					current_index, level + 1) != 0)
-		{
-			return -1;
-		}
+		*size /= 2.f;
+	}
+}
 
-		// Print progress:
-		if (level == 0)
-		{
-			printf("      --->  75.0%%.\n");
-		}
+// Count a finished subtree, and print progress every eighth of the way:
+void print_sdf_3d_progress(uint32_t *tasks_completed, uint32_t num_tasks)
+{
+	uint32_t completed = __atomic_add_fetch(tasks_completed, 1, __ATOMIC_RELAXED);
+	if (((completed * 8) / num_tasks) != (((completed - 1) * 8) / num_tasks))
+	{
+		printf("      ---> %5.1f%%.\n", (100.f * completed) / num_tasks);
+	}
+}
 
-		// Lower, bottom-left cube:
-		new_centre.x = centre.x - (size / 2.f);
-		new_centre.y = centre.y - (size / 2.f);
-		new_centre.z = centre.z - (size / 2.f);
-		if (create_sdf_3d_helper(sdf_3d, size / 2.f, new_centre,
-					current_index, level + 1) != 0)
-		{
-			return -1;
-		}
+// Calculate the 8 cubes of the last level in one batch:
+void create_sdf_3d_leaves(FracRenderSDF3D *sdf_3d, float size, FracRenderVector3 centre,
+								float *leaves)
+{
+	FracRenderVector3x8 positions;
+	get_sdf_3d_sub_cube_centres(size, centre, &positions);
 
-		// Print progress:
-		if (level == 0)
-		{
-			printf("      --->  87.5%%.\n");
-		}
+	float distances[8];
+	sdf_3d->batch_distance_function(&positions, sdf_3d->parameter, distances);
 
-		// Lower, bottom-right cube:
-		new_centre.x = centre.x + (size / 2.f);
-		new_centre.y = centre.y - (size / 2.f);
-		new_centre.z = centre.z - (size / 2.f);
-		if (create_sdf_3d_helper(sdf_3d, size / 2.f, new_centre,
-					current_index, level + 1) != 0)
-		{
-			return -1;
-		}
+	for (int i = 0; i < 8; i++)
+	{
+		// To guarantee underestimate, take away half length of diagonal of cube:
+		float distance_estimate = distances[i];
+		distance_estimate -= (distance_estimate / fabs(distance_estimate)) *
+								sqrt(3.f) * size;
+		leaves[i] = distance_estimate;
+	}
+}
+
+// Get the centres of the 8 sub-cubes of a cube (size is the sub-cube size), in Morton order:
+void get_sdf_3d_sub_cube_centres(float size, FracRenderVector3 centre,
+					FracRenderVector3x8 *positions)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		if (i & 1) { positions->x[i] = centre.x + size; }
+		else { positions->x[i] = centre.x - size; }
+		if (i & 4) { positions->y[i] = centre.y - size; }
+		else { positions->y[i] = centre.y + size; }
+		if (i & 2) { positions->z[i] = centre.z - size; }
+		else { positions->z[i] = centre.z + size; }
+	}
+}
+
+// Get the data uploaded to the GPU:
+const void *get_sdf_3d_data(FracRenderSDF3D *sdf_3d)
+{
+	if ((sdf_3d->layout == 1) || (sdf_3d->layout == 3)) { return sdf_3d->nodes; }
+	else { return sdf_3d->voxels; }
+}
+
+// Get size of the data uploaded to the GPU, in bytes:
+size_t get_sdf_3d_data_size(FracRenderSDF3D *sdf_3d)
+{
+	if ((sdf_3d->layout == 1) || (sdf_3d->layout == 3))
+	{
+		return (size_t)sdf_3d->num_node_entries * sizeof(uint32_t);
+	}
+
+	// Shading entries start at the next whole entry after the voxels:
+	if (sdf_3d->shading == 1)
+	{
+		return ((size_t)get_sdf_3d_shading_offset(sdf_3d) +
+				get_sdf_3d_shading_size(sdf_3d)) * sizeof(uint32_t);
+	}
+
+	return (size_t)sdf_3d->num_voxels * get_sdf_3d_format_size(sdf_3d->format);
+}
+
+// Get index of a voxel from integer coordinates (counting up along each axis):
+uint32_t get_sdf_3d_voxel_index(FracRenderSDF3D *sdf_3d, uint32_t x, uint32_t y, uint32_t z)
+{
+	// Y and z count down from the top in the Morton code:
+	uint32_t resolution = 1u << sdf_3d->levels;
+	y = resolution - 1 - y;
+	z = resolution - 1 - z;
+
+	uint32_t index = 0;
+	for (uint32_t i = 0; i < sdf_3d->levels; i++)
+	{
+		index |= ((x >> i) & 1) << (3 * i);
+		index |= ((z >> i) & 1) << ((3 * i) + 1);
+		index |= ((y >> i) & 1) << ((3 * i) + 2);
+	}
 
-		// Print progress:
-		if (level == 0)
+	return index;
+}
+
+// Write the voxels as a grid for a 3D texture (x, then y, then z), in a storage format:
+void write_sdf_3d_grid(FracRenderSDF3D *sdf_3d, void *grid, int format)
+{
+	uint32_t resolution = 1u << sdf_3d->levels;
+	size_t voxel_size = get_sdf_3d_format_size(format);
+
+	size_t texel = 0;
+	for (uint32_t z = 0; z < resolution; z++)
+	{
+		for (uint32_t y = 0; y < resolution; y++)
 		{
-			printf("      ---> 100.0%%.\n");
+			for (uint32_t x = 0; x < resolution; x++)
+			{
+				// Same format can be copied as it is, otherwise convert:
+				uint32_t index = get_sdf_3d_voxel_index(sdf_3d, x, y, z);
+				if (format == sdf_3d->format)
+				{
+					memcpy((char *)grid + (texel * voxel_size),
+						(char *)sdf_3d->voxels + (index * voxel_size),
+									voxel_size);
+				}
+				else
+				{
+					encode_sdf_3d_voxel(sdf_3d, grid, format, texel,
+						decode_sdf_3d_voxel(sdf_3d, index));
+				}
+				texel++;
+			}
 		}
 	}
+}
 
-	return 0;
+// Get size of one voxel in a storage format, in bytes:
+size_t get_sdf_3d_format_size(int format)
+{
+	if (format == 1) { return sizeof(uint16_t); }
+	else if (format == 2) { return sizeof(uint8_t); }
+	else { return sizeof(float); }
+}
+
+// Get name of storage format:
+const char *get_sdf_3d_format_name(int format)
+{
+	if (format == 1) { return "16-bit float"; }
+	else if (format == 2) { return "8-bit"; }
+	else { return "32-bit float"; }
+}
+
+// Get distance between 8-bit steps (size of a cube at the last level):
+float get_sdf_3d_format_scale(FracRenderSDF3D *sdf_3d)
+{
+	return ldexpf(sdf_3d->size, -(int)sdf_3d->levels);
+}
+
+// Store a distance in an array of voxels, in a storage format:
+void encode_sdf_3d_voxel(FracRenderSDF3D *sdf_3d, void *voxels, int format, size_t index,
+									float distance)
+{
+	if (format == 1) { ((uint16_t *)voxels)[index] = encode_sdf_3d_half(distance); }
+	else if (format == 2)
+	{
+		((uint8_t *)voxels)[index] = encode_sdf_3d_unorm8(distance,
+						get_sdf_3d_format_scale(sdf_3d));
+	}
+	else { ((float *)voxels)[index] = distance; }
+}
+
+// Get a voxel's distance back as a 32-bit float:
+float decode_sdf_3d_voxel(FracRenderSDF3D *sdf_3d, size_t index)
+{
+	if (sdf_3d->format == 1) { return decode_sdf_3d_half(((uint16_t *)sdf_3d->voxels)[index]); }
+	else if (sdf_3d->format == 2)
+	{
+		int steps = (int)((uint8_t *)sdf_3d->voxels)[index] - 128;
+		return (float)steps * get_sdf_3d_format_scale(sdf_3d);
+	}
+	else { return ((float *)sdf_3d->voxels)[index]; }
+}
+
+// Convert a distance to a 16-bit float, rounding towards zero so it stays an underestimate:
+uint16_t encode_sdf_3d_half(float distance)
+{
+	uint32_t bits;
+	memcpy(&bits, &distance, sizeof(uint32_t));
+
+	uint16_t sign = (bits >> 16) & 0x8000;
+	int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	// Not a number:
+	if ((bits & 0x7fffffff) > 0x7f800000) { return sign | 0x7e00; }
+
+	// Too big (including infinity). Use the largest finite value:
+	if (exponent >= 31) { return sign | 0x7bff; }
+
+	// Too small for a normal 16-bit float. Use a subnormal, or zero:
+	if (exponent <= 0)
+	{
+		if (exponent < -10) { return sign; }
+		return sign | ((mantissa | 0x800000) >> (14 - exponent));
+	}
+
+	return sign | (exponent << 10) | (mantissa >> 13);
+}
+
+// Convert a 16-bit float back to a 32-bit float:
+float decode_sdf_3d_half(uint16_t half)
+{
+	uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1f;
+	uint32_t mantissa = half & 0x3ff;
+
+	// Zero and subnormals are exact as a scaled 32-bit float:
+	if (exponent == 0)
+	{
+		float value = ldexpf((float)mantissa, -24);
+		return (sign) ? -value : value;
+	}
+
+	// Infinity and not a number:
+	uint32_t bits;
+	if (exponent == 31) { bits = sign | 0x7f800000 | (mantissa << 13); }
+	else { bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13); }
+
+	float value;
+	memcpy(&value, &bits, sizeof(float));
+
+	return value;
+}
+
+// Convert a distance to 8-bit steps of the scale, rounding towards zero:
+uint8_t encode_sdf_3d_unorm8(float distance, float scale)
+{
+	if (isnan(distance)) { return 128; }
+
+	// Steps either side of 128, clamped to the range (clamping also moves towards zero):
+	float steps = truncf(distance / scale);
+	if (steps > 127.f) { steps = 127.f; }
+	if (steps < -127.f) { steps = -127.f; }
+
+	// The division can round up. Step towards zero until the decoded value is no bigger:
+	while (fabsf(steps * scale) > fabsf(distance))
+	{
+		if (steps > 0.f) { steps -= 1.f; }
+		else { steps += 1.f; }
+	}
+
+	return (uint8_t)(128 + (int)steps);
 }
 
 // Free SDF memory:
@@ -255,10 +845,18 @@ void destroy_sdf_3d(FracRenderSDF3D *sdf_3d)
 	printf("----------------------------------------\n");
 	printf("Freeing memory for 3D SDF (CPU-side)...\n");
 
+	if (sdf_3d->cache_mapping)
+	{
+		unmap_sdf_3d_cache(sdf_3d);
+	}
 	if (sdf_3d->voxels)
 	{
 		free(sdf_3d->voxels);
 	}
+	if (sdf_3d->nodes)
+	{
+		free(sdf_3d->nodes);
+	}
 
 	printf("... Done.\n");
 	printf("----------------------------------------");
@@ -266,11 +864,10 @@ void destroy_sdf_3d(FracRenderSDF3D *sdf_3d)
 }
 
 // Signed distance function for Mandelbulb fractal:
-float signed_distance_function_mandelbulb(FracRenderVector3 position)
+float signed_distance_function_mandelbulb(FracRenderVector3 position, float parameter)
 {
 	int max_iterations = 4;
 	float escape_radius = 2.f;
-	float parameter = 8.f;
 
 	FracRenderVector3 z = position;
 	float dr = 1.f;
@@ -301,24 +898,24 @@ float signed_distance_function_mandelbulb(FracRenderVector3 position)
 }
 
 // Signed distance function for Hall of Pillars fractal:
-float signed_distance_function_hall_of_pillars(FracRenderVector3 position)
+float signed_distance_function_hall_of_pillars(FracRenderVector3 position, float parameter)
 {
 	FracRenderVector3 z;
 	z.x = position.x;
 	z.y = position.z;
 	z.z = position.y;
-	float scale = 1.f;
+	float scale = fmaxf(0.1f, parameter - 1.f);
 	FracRenderVector3 size_clamp_min = initialize_vector_3(-1.f, -1.f, -1.3f);
 	FracRenderVector3 size_clamp_max = initialize_vector_3(1.f, 1.f, 1.3f);
 
 	for (int i = 0; i < 12; i++)
 	{
 		FracRenderVector3 z_clamped = clamp_vector_3(z, size_clamp_min, size_clamp_max);
-		z.x = (2.f * z_clamped.x) - z.x;
-		z.y = (2.f * z_clamped.y) - z.y;
-		z.z = (2.f * z_clamped.z) - z.z;
+		z.x = (parameter * z_clamped.x) - z.x;
+		z.y = (parameter * z_clamped.y) - z.y;
+		z.z = (parameter * z_clamped.z) - z.z;
 		float r2 = dot(z, z);
-		float k = fmax(2.f / r2, 0.027f);
+		float k = fmax(parameter / r2, 0.027f);
 		z = multiply_vector_3_scalar(z, k);
 		scale *= k;
 	}
@@ -391,7 +988,7 @@ void print_sdf_3d_voxels(FracRenderSDF3D *sdf_3d)
 	printf("Centre: %f, %f, %f\n", centre.x, centre.y, centre.z);
 	printf("Size: %f\n", size);
 	printf("Index: %d\n", index + cube_index);
-	printf("Distance: %f\n\n", sdf_3d->voxels[index]);
+	printf("Distance: %f\n\n", decode_sdf_3d_voxel(sdf_3d, index));
 
 	printf("----------------------------------------");
 	printf("----------------------------------------\n\n");
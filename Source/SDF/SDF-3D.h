@@ -5,55 +5,271 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 // Local includes:
 #include "../Utility/Program-State.h"
 #include "../Utility/Vectors.h"
+#include "../Utility/Work-Pool.h"
+#include "SDF-3D-SIMD.h"
+
+/*
+ * Voxel order: a voxel's index is its Morton (Z-order) code. With integer voxel coordinates x
+ * (counting up along +x), y (counting down from +y) and z (counting down from +z), bit 3n of the
+ * code is bit n of x, bit 3n + 1 is bit n of z, and bit 3n + 2 is bit n of y. Each group of 3 bits
+ * picks one of 8 sub-cubes, most significant group first:
+ * 0 = Upper, top-left (-x, +y, +z)       4 = Lower, top-left (-x, -y, +z)
+ * 1 = Upper, top-right (+x, +y, +z)      5 = Lower, top-right (+x, -y, +z)
+ * 2 = Upper, bottom-left (-x, +y, -z)    6 = Lower, bottom-left (-x, -y, -z)
+ * 3 = Upper, bottom-right (+x, +y, -z)   7 = Lower, bottom-right (+x, -y, -z)
+ */
+
+// Culling: a cube's voxels are filled in from the distance at its centre, without calculating
+// them, if it is more than this many times the cube's half diagonal:
+#define FRACRENDER_SDF_3D_CULL_MARGIN 2.f
+
+// Cascades of the clipmap layout (see SDF-3D-Clipmap.h):
+#define FRACRENDER_SDF_3D_CLIPMAP_CASCADES 4
+
+// Most memory any 3D SDF may use, whatever the budget (entries are indexed with 32 bits):
+#define FRACRENDER_SDF_3D_MAX_MEMORY (2000ull * 1024 * 1024)
 
 /**************
  * Structures *
  **************/
 
 typedef struct {
-	// Levels:
+	// Window of world voxel coordinates (lowest corner), and size of a voxel:
+	int32_t origin[3];
+	float voxel_size;
+} FracRenderSDF3DCascade;
+
+typedef struct {
+	// Levels (for the clipmap layout, of each cascade):
 	uint32_t levels;
 
+	// Layout. 0 = Dense array of voxels, 1 = Sparse octree, 2 = Clipmap (dense cascades at
+	// doubling sizes, following the camera), 3 = Brick pool (voxels only near the surface):
+	int layout;
+
+	// GPU storage. 0 = Storage buffer, 1 = 3D texture (dense layout only):
+	int texture;
+
+	// Storage format of the voxels. 0 = 32-bit float, 1 = 16-bit float, 2 = 8-bit (steps of the
+	// last level's cube size, 128 = zero). All round towards zero, to stay underestimates:
+	int format;
+
 	// Number of voxels:
 	uint32_t num_voxels;
 
-	// Cube size and centre:
+	// Most memory the SDF may use (the smallest of the setting, the device, half the host's
+	// memory and FRACRENDER_SDF_3D_MAX_MEMORY), and the memory worked out for it before it is
+	// calculated (0 for the sparse and brick pool layouts, which depend on the surface):
+	size_t memory_budget;
+	size_t predicted_memory;
+
+	// Levels a dense SDF started with fewer levels is refined to once rendering, or 0 (see
+	// 15-Vulkan-SDF-Progressive.h):
+	uint32_t final_levels;
+
+	// Cube size and centre (for the clipmap layout, of the biggest cascade):
 	float size;
 	FracRenderVector3 centre;
 
-	// Fractal type:
+	// Clipmap cascades, smallest first:
+	uint32_t num_cascades;
+	FracRenderSDF3DCascade cascades[FRACRENDER_SDF_3D_CLIPMAP_CASCADES];
+
+	// Fractal type, and the fractal parameter the SDF is calculated for (power for Mandelbulb,
+	// fold scale for Hall of Pillars):
 	int fractal_type;
+	float parameter;
+
+	// Number of threads used to calculate the SDF:
+	uint32_t num_threads;
+
+	// Instruction set and distance estimator used for the 8 cubes of the last level:
+	int instruction_set;
+	FracRenderSDF3DBatchFunction batch_distance_function;
 
-	// Voxels:
-	float *voxels;
+	// Voxels (dense and clipmap layouts), in the storage format:
+	void *voxels;
+
+	// Whether dense voxels far from the surface are filled in from the distance at the centre
+	// of a bigger cube, instead of being calculated (see FRACRENDER_SDF_3D_CULL_MARGIN):
+	int cull;
+
+	// Whether the dense voxels are calculated from a narrow band of distance estimates near
+	// the surface and a distance transform, instead of estimating every voxel (see
+	// SDF-3D-Transform.h):
+	int transform;
+
+	// Order of the Mandelbulb's rotational symmetry the dense voxels are folded by, storing
+	// only a wedge of them, or 0 (see SDF-3D-Symmetry.h):
+	uint32_t symmetry;
+
+	// Planes through the origin the SDF is mirrored in (bit 0 = x, bit 1 = y, bit 2 = z), with
+	// the cube on their positive side and lookups folded into it, or 0 (see SDF-3D-Symmetry.h):
+	uint32_t mirror;
+
+	// Whether the dense voxels are followed by a normal and orbit trap colour for each voxel,
+	// read by the colour pass (see SDF-3D-Shading.h):
+	int shading;
+
+	// Whether the dense voxels are left to be calculated straight into mapped GPU memory
+	// when uploading, instead of into their own array:
+	int deferred;
+
+	// Whether deferred voxels are calculated on the GPU by a compute shader instead:
+	int bake;
+
+	// Octree nodes (sparse layout), 8 entries per node, or cells then bricks (brick pool
+	// layout). See SDF-3D-Sparse.h and SDF-3D-Bricks.h for the encodings:
+	uint32_t num_node_entries;
+	uint32_t *nodes;
+
+	// Whether to use the on-disk cache, and the mapped cache file if the SDF was loaded from
+	// it (voxels or nodes then point into the mapping):
+	int cache;
+	void *cache_mapping;
+	size_t cache_mapping_size;
 } FracRenderSDF3D;
 
+typedef struct {
+	// SDF being calculated:
+	FracRenderSDF3D *sdf_3d;
+
+	// Level at which the octree is split into independent subtrees (one per task):
+	uint32_t split_level;
+	uint32_t num_tasks;
+	uint32_t voxels_per_task;
+
+	// First subtree of the range being calculated:
+	uint32_t first_task;
+
+	// Progress. Nothing is printed if quiet (background calculation):
+	uint32_t tasks_completed;
+	struct timespec start_time;
+	int quiet;
+
+	// Voxels filled in by culling:
+	uint64_t num_culled;
+
+	// Set to stop the remaining subtrees (they then fail):
+	int cancelled;
+} FracRenderSDF3DBuild;
+
 /***********************
  * Function Prototypes *
  ***********************/
 
-// Set up 3D SDF structure:
-void set_up_sdf_3d(FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d);
+// Set up 3D SDF structure, within the memory of the device (in bytes, 0 = Unknown):
+void set_up_sdf_3d(FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d,
+							size_t device_memory);
+
+// Fewer levels or a smaller format if the SDF is too big for the device or the host:
+void fit_sdf_3d_memory_budget(FracRenderSDF3D *sdf_3d, int setting, size_t device_memory);
+
+// Get half the host's physical memory, in bytes (0 if unknown):
+size_t get_sdf_3d_host_memory();
+
+// Get number of voxels of the dense and clipmap layouts (0 for the others, or if there are
+// too many to count in 32 bits):
+uint32_t get_sdf_3d_num_voxels(FracRenderSDF3D *sdf_3d);
 
 // Calculate 3D SDF:
 int create_sdf_3d(FracRenderSDF3D *sdf_3d);
 
-// SDF recursion helper:
-int create_sdf_3d_helper(FracRenderSDF3D *sdf_3d, float size, FracRenderVector3 centre,
-						uint32_t *current_index, uint32_t level);
+// Start calculating a dense 3D SDF into sdf_3d->voxels (already allocated):
+int begin_sdf_3d_build(FracRenderSDF3D *sdf_3d, FracRenderSDF3DBuild *build);
+
+// Split a dense 3D SDF calculation into subtrees, without printing anything:
+int set_up_sdf_3d_build(FracRenderSDF3D *sdf_3d, FracRenderSDF3DBuild *build);
+
+// Calculate a range of subtrees. Their voxels are one contiguous range of the array:
+int run_sdf_3d_build(FracRenderSDF3DBuild *build, uint32_t first_task, uint32_t num_tasks);
+
+// Finish calculating a dense 3D SDF, and print how long it took:
+void end_sdf_3d_build(FracRenderSDF3DBuild *build);
+
+// Calculate one subtree of the 3D SDF (work pool task):
+int create_sdf_3d_task(void *build_data, uint32_t task_index);
+
+// Calculate the voxels of a cube (size is half the cube's length), culling its sub-cubes if
+// they are far enough from the surface:
+void create_sdf_3d_cube(FracRenderSDF3DBuild *build, uint32_t level, uint32_t code, float size,
+							FracRenderVector3 centre);
+
+// Fill in the voxels of a cube from the distance at a point, taking away how far each voxel's
+// corners can be from it:
+void fill_sdf_3d_cube(FracRenderSDF3DBuild *build, uint32_t level, uint32_t code, float size,
+	FracRenderVector3 centre, FracRenderVector3 point, float distance);
+
+// Store the 8 voxels of a cube one level above max resolution:
+void store_sdf_3d_leaves(FracRenderSDF3DBuild *build, uint32_t code, float *leaves);
+
+// Get the cube at a level from its Morton code, halving the main cube one level at a time:
+void get_sdf_3d_cube(FracRenderSDF3D *sdf_3d, uint32_t level, uint32_t code,
+					float *size, FracRenderVector3 *centre);
+
+// Count a finished subtree, and print progress every eighth of the way:
+void print_sdf_3d_progress(uint32_t *tasks_completed, uint32_t num_tasks);
+
+// Calculate the 8 cubes of the last level in one batch:
+void create_sdf_3d_leaves(FracRenderSDF3D *sdf_3d, float size, FracRenderVector3 centre,
+								float *leaves);
+
+// Get the centres of the 8 sub-cubes of a cube (size is the sub-cube size):
+void get_sdf_3d_sub_cube_centres(float size, FracRenderVector3 centre,
+					FracRenderVector3x8 *positions);
+
+// Get the data uploaded to the GPU:
+const void *get_sdf_3d_data(FracRenderSDF3D *sdf_3d);
+
+// Get size of the data uploaded to the GPU, in bytes:
+size_t get_sdf_3d_data_size(FracRenderSDF3D *sdf_3d);
+
+// Get index of a voxel from integer coordinates (counting up along each axis):
+uint32_t get_sdf_3d_voxel_index(FracRenderSDF3D *sdf_3d, uint32_t x, uint32_t y, uint32_t z);
+
+// Write the voxels as a grid for a 3D texture (x, then y, then z), in a storage format:
+void write_sdf_3d_grid(FracRenderSDF3D *sdf_3d, void *grid, int format);
+
+// Get size of one voxel in a storage format, in bytes:
+size_t get_sdf_3d_format_size(int format);
+
+// Get name of storage format:
+const char *get_sdf_3d_format_name(int format);
+
+// Get distance between 8-bit steps (size of a cube at the last level):
+float get_sdf_3d_format_scale(FracRenderSDF3D *sdf_3d);
+
+// Store a distance in an array of voxels, in a storage format:
+void encode_sdf_3d_voxel(FracRenderSDF3D *sdf_3d, void *voxels, int format, size_t index,
+									float distance);
+
+// Get a voxel's distance back as a 32-bit float:
+float decode_sdf_3d_voxel(FracRenderSDF3D *sdf_3d, size_t index);
+
+// Convert a distance to a 16-bit float, rounding towards zero so it stays an underestimate:
+uint16_t encode_sdf_3d_half(float distance);
+
+// Convert a 16-bit float back to a 32-bit float:
+float decode_sdf_3d_half(uint16_t half);
+
+// Convert a distance to 8-bit steps of the scale, rounding towards zero:
+uint8_t encode_sdf_3d_unorm8(float distance, float scale);
 
 // Free SDF memory:
 void destroy_sdf_3d(FracRenderSDF3D *sdf_3d);
 
 // Signed distance function for Mandelbulb fractal:
-float signed_distance_function_mandelbulb(FracRenderVector3 position);
+float signed_distance_function_mandelbulb(FracRenderVector3 position, float parameter);
 
 // Signed distance function for Hall of Pillars fractal:
-float signed_distance_function_hall_of_pillars(FracRenderVector3 position);
+float signed_distance_function_hall_of_pillars(FracRenderVector3 position, float parameter);
 
 // Print out a few voxels for debugging:
 void print_sdf_3d_voxels(FracRenderSDF3D *sdf_3d);
@@ -14,6 +14,8 @@ layout (set = 0, binding = 0) uniform UScene
 	vec3 sdf_3d_centre;
 	float sdf_3d_size;
 	uint sdf_3d_levels;
+	uint sdf_3d_layout;
+	uint sdf_3d_format;
 
 	// Aspect ratio:
 	float aspect_ratio;
@@ -16,6 +16,8 @@ layout (set = 0, binding = 0) uniform UScene
 	vec3 sdf_3d_centre;
 	float sdf_3d_size;
 	uint sdf_3d_levels;
+	uint sdf_3d_layout;
+	uint sdf_3d_format;
 
 	// Aspect ratio:
 	float aspect_ratio;
@@ -25,14 +27,41 @@ layout (set = 0, binding = 0) uniform UScene
 
 	// View distance:
 	float view_distance;
+
+	// Clipmap cascades, smallest first. World voxel coordinates of each window's lowest corner:
+	uint sdf_3d_num_cascades;
+	ivec4 sdf_3d_cascades[4];
+
+	// Order of rotational symmetry the dense voxels are folded by, or 0:
+	uint sdf_3d_symmetry;
+
+	// Planes through the origin the 3D SDF is mirrored in (Hall of Pillars only):
+	uint sdf_3d_mirror;
+
+	// First entry of the dense 3D SDF's stored shading, or 0 without it:
+	uint sdf_3d_shading;
 } u_scene;
 
 layout (set = 1, binding = 0) uniform sampler2D u_position_sampler;
 
+#ifdef FRACRENDER_SDF_3D_SHADING
+// Dense 3D SDF, with an entry of shading for each voxel after the voxels (see
+// SDF-3D-Shading.h):
+layout (set = 2, binding = 0) readonly buffer BVoxels
+{
+	uint voxels[];
+} b_voxels;
+#endif
+
 layout (location = 0) out vec4 out_colour;
 
 // Function prototypes:
 vec4 colour_function_mandelbulb(vec3 position);
+vec4 orbit_trap_colour(vec3 colour);
+#ifdef FRACRENDER_SDF_3D_SHADING
+bool sdf_3d_shading(vec3 position, out vec3 colour);
+uint morton_spread(uint value);
+#endif
 
 void main()
 {
@@ -45,11 +74,24 @@ void main()
 		return;
 	}
 
+	// Colour from the 3D SDF's stored shading where it has it, instead of iterating:
+	vec4 colour;
+#ifdef FRACRENDER_SDF_3D_SHADING
+	vec3 orbit_trap;
+	if (sdf_3d_shading(position.xyz, orbit_trap))
+	{
+		colour = orbit_trap_colour(orbit_trap);
+	}
+	else { colour = colour_function_mandelbulb(position.xyz); }
+#else
+	colour = colour_function_mandelbulb(position.xyz);
+#endif
+
 	// Colour using colour function:
-//	out_colour = colour_function_mandelbulb(position.xyz);
+//	out_colour = colour;
 
 	// Colour using colour function, with iterations achieved for AO effect:
-	out_colour = (colour_function_mandelbulb(position.xyz) * pow(position.w, 20));
+	out_colour = (colour * pow(position.w, 20));
 
 	// Colour based on iterations achieved:
 //	out_colour = vec4(vec3(pow(position.w, 20)), 1.f);
@@ -68,7 +110,6 @@ vec4 colour_function_mandelbulb(vec3 position)
 	// Colour:
 	vec3 reference_point = vec3(1.f, 0.75f, 0.5f);
 	vec3 colour = abs(z - reference_point);
-	vec3 colour_addition = vec3(0.05f, 0.1f, 0.15f);
 
         for (int i = 0; i < max_iterations; i++)
         {
@@ -93,5 +134,67 @@ vec4 colour_function_mandelbulb(vec3 position)
 		colour = min(colour, abs(z - reference_point));
         }
 
+	return orbit_trap_colour(colour);
+}
+
+vec4 orbit_trap_colour(vec3 colour)
+{
+	// Minimum distances from the reference point, swizzled and offset:
+	vec3 colour_addition = vec3(0.05f, 0.1f, 0.15f);
 	return vec4(colour.zyx + colour_addition, 1.f);
 }
+
+#ifdef FRACRENDER_SDF_3D_SHADING
+bool sdf_3d_shading(vec3 position, out vec3 colour)
+{
+	colour = vec3(0.f);
+	if (u_scene.sdf_3d_shading == 0) { return false; }
+
+	// Voxel coordinates, with voxel centres on whole numbers. Y and z count down from the top
+	// (see SDF-3D.h):
+	int resolution = 1 << u_scene.sdf_3d_levels;
+	vec3 grid = ((position - u_scene.sdf_3d_centre) / (2.f * u_scene.sdf_3d_size)) + 0.5f;
+	grid.yz = 1.f - grid.yz;
+	grid = (grid * float(resolution)) - 0.5f;
+	if (any(lessThan(grid, vec3(-0.5f))) ||
+		any(greaterThan(grid, vec3(float(resolution) - 0.5f)))) { return false; }
+	ivec3 lowest = ivec3(floor(grid));
+	vec3 blend = grid - vec3(lowest);
+
+	// Trilinear blend of the 8 voxels around the point, leaving out any without shading:
+	float total_weight = 0.f;
+	for (int i = 0; i < 8; i++)
+	{
+		ivec3 offset = ivec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+		uvec3 voxel = uvec3(clamp(lowest + offset, 0, resolution - 1));
+		vec3 weights = mix(1.f - blend, blend, vec3(offset));
+		float weight = weights.x * weights.y * weights.z;
+
+		uint packed_colour = b_voxels.voxels[u_scene.sdf_3d_shading +
+			(morton_spread(voxel.x) | (morton_spread(voxel.z) << 1) |
+						(morton_spread(voxel.y) << 2))];
+		if ((packed_colour == 0) || (weight <= 0.f)) { continue; }
+
+		// Colour is three 10-bit values from 0 to 4:
+		colour += weight * (vec3(uvec3(packed_colour, packed_colour >> 10,
+					packed_colour >> 20) & 1023u) * (4.f / 1023.f));
+		total_weight += weight;
+	}
+
+	if (total_weight <= 0.f) { return false; }
+
+	colour /= total_weight;
+	return true;
+}
+
+uint morton_spread(uint value)
+{
+	// Move bit n of a 10-bit value to bit 3n:
+	value &= 0x3ffu;
+	value = (value | (value << 16)) & 0x030000ffu;
+	value = (value | (value << 8)) & 0x0300f00fu;
+	value = (value | (value << 4)) & 0x030c30c3u;
+	value = (value | (value << 2)) & 0x09249249u;
+	return value;
+}
+#endif
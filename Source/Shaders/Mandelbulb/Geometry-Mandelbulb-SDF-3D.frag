@@ -16,6 +16,8 @@ layout (set = 0, binding = 0) uniform UScene
 	vec3 sdf_3d_centre;
 	float sdf_3d_size;
 	uint sdf_3d_levels;
+	uint sdf_3d_layout;
+	uint sdf_3d_format;
 
 	// Aspect ratio:
 	float aspect_ratio;
@@ -25,18 +27,43 @@ layout (set = 0, binding = 0) uniform UScene
 
 	// View distance:
 	float view_distance;
+
+	// Clipmap cascades (Hall of Pillars only):
+	uint sdf_3d_num_cascades;
+	ivec4 sdf_3d_cascades[4];
+
+	// Order of rotational symmetry the dense voxels are folded by, or 0 (see
+	// SDF-3D-Symmetry.h):
+	uint sdf_3d_symmetry;
 } u_scene;
 
+#ifdef FRACRENDER_SDF_3D_TEXTURE
+// Dense layout as a 3D texture (x, y and z counting up), filtered by the hardware:
+layout (set = 1, binding = 0) uniform sampler3D u_sdf_3d_sampler;
+#else
+// Dense layout: voxel distances packed in the storage format (1, 2 or 4 per entry). Sparse
+// layout: octree nodes, 8 entries each. Brick pool layout: cell entries, then bricks of 512
+// voxel distances:
 layout (set = 1, binding = 0) readonly buffer BVoxels
 {
-	float voxels[];
+	uint voxels[];
 } b_voxels;
+#endif
 
 layout (location = 0) out vec4 out_position;
 
 // Function prototypes:
 vec4 sphere_trace(vec3 origin, vec3 ray);
+#ifdef FRACRENDER_SDF_3D_TEXTURE
+bool sdf_3d_lookup_texture(vec3 position, out float distance_estimate);
+#else
 uint sdf_3d_lookup(vec3 position);
+float sdf_3d_voxel(uint voxel);
+uint morton_spread(uint value);
+bool sdf_3d_lookup_sparse(vec3 position, out float distance_estimate);
+bool sdf_3d_lookup_bricks(vec3 position, out float distance_estimate);
+bool sdf_3d_lookup_symmetry(vec3 position, out float distance_estimate);
+#endif
 bool in_cube(vec3 cube_centre, float cube_size, vec3 point);
 float ray_cube(vec3 origin, vec3 ray);
 float distance_estimator_mandelbulb(vec3 position);
@@ -60,16 +87,39 @@ vec4 sphere_trace(vec3 origin, vec3 ray)
 	float distance_travelled = 0.f;
 	float distance_threshold = 0.0001f;
 	uint voxel_lookup;
+	bool voxel_found;
 	float cube_size = u_scene.sdf_3d_size / pow(2.f, u_scene.sdf_3d_levels);
 
 	int steps_taken = 0;
 	for (; steps_taken <= max_steps; steps_taken++)
 	{
 		// Look up which voxel the point is in:
-		voxel_lookup = sdf_3d_lookup(current_position.xyz);
+#ifdef FRACRENDER_SDF_3D_TEXTURE
+		voxel_found = sdf_3d_lookup_texture(current_position.xyz, distance_estimate);
+#else
+		if (u_scene.sdf_3d_layout == 1)
+		{
+			voxel_found = sdf_3d_lookup_sparse(current_position.xyz, distance_estimate);
+		}
+		else if (u_scene.sdf_3d_layout == 3)
+		{
+			voxel_found = sdf_3d_lookup_bricks(current_position.xyz, distance_estimate);
+		}
+		else if (u_scene.sdf_3d_symmetry != 0)
+		{
+			voxel_found = sdf_3d_lookup_symmetry(current_position.xyz,
+								distance_estimate);
+		}
+		else
+		{
+			voxel_lookup = sdf_3d_lookup(current_position.xyz);
+			voxel_found = (voxel_lookup != 0);
+			distance_estimate = sdf_3d_voxel(voxel_lookup);
+		}
+#endif
 
-		// If voxel is invalid (0), check for main cube intersection:
-		if (voxel_lookup == 0)
+		// If voxel is invalid, check for main cube intersection:
+		if (!voxel_found)
 		{
 			distance_estimate = ray_cube(origin, ray);
 			if (distance_estimate >= 0.f)
@@ -80,7 +130,6 @@ vec4 sphere_trace(vec3 origin, vec3 ray)
 		}
 		else
 		{
-			distance_estimate = b_voxels.voxels[voxel_lookup];
 			distance_travelled += distance_estimate;
 		}
 
@@ -113,55 +162,192 @@ vec4 sphere_trace(vec3 origin, vec3 ray)
 	return current_position;
 }
 
+#ifdef FRACRENDER_SDF_3D_TEXTURE
+bool sdf_3d_lookup_texture(vec3 position, out float distance_estimate)
+{
+	vec3 centre = u_scene.sdf_3d_centre;
+	float size = u_scene.sdf_3d_size;
+	distance_estimate = 0.f;
+
+	// Check if point is in main cube:
+	if (!in_cube(centre, size, position)) { return false; }
+
+	// The 3D SDF's sampler clamps to the edge, so the outermost voxels carry on to the
+	// cube's faces:
+	vec3 coordinates = ((position - centre) / (2.f * size)) + 0.5f;
+	distance_estimate = textureLod(u_sdf_3d_sampler, coordinates, 0.f).r;
+
+	// 8-bit is read as 0 to 1. Turn it back into steps either side of 128:
+	float half_voxel = ldexp(u_scene.sdf_3d_size, -int(u_scene.sdf_3d_levels));
+	if (u_scene.sdf_3d_format == 2)
+	{
+		distance_estimate = ((distance_estimate * 255.f) - 128.f) * half_voxel;
+	}
+
+	// Each voxel only bounds the distance inside its own cube, and the point can be up to
+	// half a voxel's diagonal outside the cubes blended. Take that away too:
+	distance_estimate -= sqrt(3.f) * half_voxel;
+
+	return true;
+}
+#else
 uint sdf_3d_lookup(vec3 position)
 {
-	// Ordering of sub-cubes (looking top-down, upper/lower is y-coordinate):
-	vec3 sub_cubes[] = {
-		vec3(-1.f,  1.f,  1.f),	// Upper, top-left.
-		vec3( 1.f,  1.f,  1.f),	// Upper, top-right.
-		vec3(-1.f,  1.f, -1.f),	// Upper, bottom-left.
-		vec3( 1.f,  1.f, -1.f),	// Upper, bottom-right.
-		vec3(-1.f, -1.f,  1.f),	// Lower, top-left.
-		vec3( 1.f, -1.f,  1.f),	// Lower, top-right.
-		vec3(-1.f, -1.f, -1.f),	// Lower, bottom-left.
-		vec3( 1.f, -1.f, -1.f)	// Lower, bottom-right.
-	};
-
-	uint index = 0;
 	vec3 centre = u_scene.sdf_3d_centre;
 	float size = u_scene.sdf_3d_size;
 
 	// Check if point is in main cube:
 	if (!in_cube(centre, size, position)) { return 0; }
 
-	// Find out which cube the point is in:
-	uint level = 1;
-	uint max_level = u_scene.sdf_3d_levels;
-	while (true)
+	// Integer voxel coordinates. Y and z count down from the top (see SDF-3D.h):
+	int resolution = 1 << u_scene.sdf_3d_levels;
+	vec3 grid = ((position - centre) / (2.f * size)) + 0.5f;
+	grid.yz = 1.f - grid.yz;
+	uvec3 voxel = uvec3(clamp(ivec3(grid * float(resolution)), 0, resolution - 1));
+
+	// Voxel index is the Morton code, interleaving x, z and y:
+	return morton_spread(voxel.x) | (morton_spread(voxel.z) << 1) |
+					(morton_spread(voxel.y) << 2);
+}
+
+float sdf_3d_voxel(uint voxel)
+{
+	// 16-bit floats, 2 per entry:
+	if (u_scene.sdf_3d_format == 1)
+	{
+		return unpackHalf2x16(b_voxels.voxels[voxel >> 1])[voxel & 1];
+	}
+
+	// 8-bit steps of the last level's cube size, 4 per entry (128 = zero):
+	if (u_scene.sdf_3d_format == 2)
+	{
+		uint steps = (b_voxels.voxels[voxel >> 2] >> ((voxel & 3) * 8)) & 0xff;
+		float scale = ldexp(u_scene.sdf_3d_size, -int(u_scene.sdf_3d_levels));
+		return (float(steps) - 128.f) * scale;
+	}
+
+	return uintBitsToFloat(b_voxels.voxels[voxel]);
+}
+
+uint morton_spread(uint value)
+{
+	// Move bit n of a 10-bit value to bit 3n:
+	value &= 0x3ffu;
+	value = (value | (value << 16)) & 0x030000ffu;
+	value = (value | (value << 8)) & 0x0300f00fu;
+	value = (value | (value << 4)) & 0x030c30c3u;
+	value = (value | (value << 2)) & 0x09249249u;
+	return value;
+}
+
+bool sdf_3d_lookup_sparse(vec3 position, out float distance_estimate)
+{
+	uint node = 0;
+	vec3 centre = u_scene.sdf_3d_centre;
+	float size = u_scene.sdf_3d_size;
+	distance_estimate = 0.f;
+
+	// Check if point is in main cube:
+	if (!in_cube(centre, size, position)) { return false; }
+
+	// Walk down the octree until reaching a leaf:
+	for (uint level = 1; level <= u_scene.sdf_3d_levels; level++)
 	{
 		// Cut size in two:
 		size /= 2.f;
 
-		for (uint i = 0; i < 8; i++)
+		// Find out which sub-cube the point is in (Morton order, see SDF-3D.h):
+		uint sub_cube = 0;
+		vec3 direction = vec3(-1.f, 1.f, 1.f);
+		if (position.x > centre.x) { sub_cube += 1; direction.x = 1.f; }
+		if (position.z < centre.z) { sub_cube += 2; direction.z = -1.f; }
+		if (position.y < centre.y) { sub_cube += 4; direction.y = -1.f; }
+
+		// Lowest bit set means a child node, clear means a distance:
+		uint entry = b_voxels.voxels[(node * 8) + sub_cube];
+		if ((entry & 1) == 0)
 		{
-			vec3 new_centre = centre + (sub_cubes[i] * size);
-			if (in_cube(new_centre, size, position))
-			{
-				if (level == max_level) {
-					return index + i;
-				}
-
-				// Move to sub-cubes:
-				centre = new_centre;
-				index += uint(pow(8.f, float(max_level) - float(level))) * i;
-				break;
-			}
+			distance_estimate = uintBitsToFloat(entry);
+			return true;
 		}
 
-		if (level == max_level) { return 0; }
-		level++;
+		// Move to sub-cubes:
+		node = entry >> 1;
+		centre += direction * size;
 	}
+
+	return false;
+}
+
+bool sdf_3d_lookup_bricks(vec3 position, out float distance_estimate)
+{
+	distance_estimate = 0.f;
+
+	// Check if point is in main cube:
+	if (!in_cube(u_scene.sdf_3d_centre, u_scene.sdf_3d_size, position)) { return false; }
+
+	// Cells of 8x8x8 voxels are indexed by the top bits of the voxel's Morton code. Lowest bit
+	// clear means a distance for the whole cell (see SDF-3D-Bricks.h):
+	uint voxel = sdf_3d_lookup(position);
+	uint entry = b_voxels.voxels[voxel >> 9];
+	if ((entry & 1) == 0)
+	{
+		distance_estimate = uintBitsToFloat(entry);
+		return true;
+	}
+
+	// Otherwise the voxel is in the cell's brick, with the bricks after the cells:
+	uint num_cells = 1u << (3 * (u_scene.sdf_3d_levels - 3));
+	uint brick = entry >> 1;
+	distance_estimate = uintBitsToFloat(b_voxels.voxels[num_cells + (brick * 512) +
+										(voxel & 511)]);
+	return true;
+}
+
+bool sdf_3d_lookup_symmetry(vec3 position, out float distance_estimate)
+{
+	vec3 centre = u_scene.sdf_3d_centre;
+	float size = u_scene.sdf_3d_size;
+	distance_estimate = 0.f;
+
+	// Check if point is in main cube:
+	if (!in_cube(centre, size, position)) { return false; }
+
+	// Fold into the wedge between 0 and pi / order around z, turning by 2 pi / order and
+	// mirroring in y = 0:
+	vec3 folded = position - centre;
+	float wedge = 3.14159265f / float(u_scene.sdf_3d_symmetry);
+	float angle = mod(atan(folded.y, folded.x), 2.f * wedge);
+	angle = min(angle, (2.f * wedge) - angle);
+	folded.xy = length(folded.xy) * vec2(cos(angle), sin(angle));
+
+	// Corners of the main cube fold outside the stored cubes, so estimate them directly:
+	if ((folded.x >= size) || (folded.y >= (0.5f * size)))
+	{
+		distance_estimate = distance_estimator_mandelbulb(position);
+		return true;
+	}
+
+	// Integer voxel coordinates, as for the whole cube:
+	int resolution = 1 << u_scene.sdf_3d_levels;
+	vec3 grid = (folded / (2.f * size)) + 0.5f;
+	grid.yz = 1.f - grid.yz;
+	uvec3 voxel = uvec3(clamp(ivec3(grid * float(resolution)), 0, resolution - 1));
+
+	// Stored cubes are a quarter of the main cube along each side, covering x from 0 to size
+	// and y from 0 to size / 2, one after another by z quarter then x half:
+	uint quarter = uint(resolution) >> 2;
+	uvec3 local = uvec3(voxel.x - (2 * quarter), min(voxel.y - quarter, quarter - 1),
+								voxel.z % quarter);
+	uint slot = ((voxel.z / quarter) * 2) + (local.x / quarter);
+	local.x %= quarter;
+
+	uint cube_voxels = 1u << (3 * (u_scene.sdf_3d_levels - 2));
+	distance_estimate = sdf_3d_voxel((slot * cube_voxels) + (morton_spread(local.x) |
+				(morton_spread(local.z) << 1) | (morton_spread(local.y) << 2)));
+	return true;
 }
+#endif
 
 bool in_cube(vec3 cube_centre, float cube_size, vec3 point)
 {
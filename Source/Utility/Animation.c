@@ -16,24 +16,9 @@ void update_animation_none(FracRenderProgramState *program_state)
 void update_animation_parameter(FracRenderProgramState *program_state)
 {
 	int num_key_frames = 4;
-
-	// If Mandelbrot is being shown, slow down animation:
 	uint64_t key_frames[4];
-
-	if (program_state->fractal_type == -1)
-	{
-		key_frames[0] = 0;	//  0. Start.
-		key_frames[1] = 9000;	//  1. Parameter increasing to top.
-		key_frames[2] = 18000;	//  2. Parameter decreasing to bottom.
-		key_frames[3] = 9000;	//  3. Parameter increasing to start.
-	}
-	else
-	{
-		key_frames[0] = 0;	//  0. Start.
-		key_frames[1] = 2000;	//  1. Parameter increasing to top.
-		key_frames[2] = 4000;	//  2. Parameter decreasing to bottom.
-		key_frames[3] = 2000;	//  3. Parameter increasing to start.
-	}
+	float key_parameter_values[4];
+	get_parameter_animation_key_frames(program_state, key_frames, key_parameter_values);
 
 	// Get total frames:
 	uint64_t total_frames = 0;
@@ -41,13 +26,6 @@ void update_animation_parameter(FracRenderProgramState *program_state)
 	program_state->max_animation_frames = total_frames;
 	if (program_state->animation_frames > total_frames) { return; }
 
-	float key_parameter_values[] = {
-		program_state->fractal_parameter_start,
-		program_state->fractal_parameter_max,
-		program_state->fractal_parameter_min,
-		program_state->fractal_parameter_start
-	};
-
 	if (program_state->animation_frames == 0)
 	{
 		program_state->fractal_parameter = program_state->fractal_parameter_start;
@@ -75,6 +53,60 @@ void update_animation_parameter(FracRenderProgramState *program_state)
 	}
 }
 
+// Get key frames (frames since the previous one) and parameter values of the parameter animation:
+void get_parameter_animation_key_frames(FracRenderProgramState *program_state,
+				uint64_t *key_frames, float *key_parameter_values)
+{
+	// If Mandelbrot is being shown, slow down animation:
+	if (program_state->fractal_type == -1)
+	{
+		key_frames[0] = 0;	//  0. Start.
+		key_frames[1] = 9000;	//  1. Parameter increasing to top.
+		key_frames[2] = 18000;	//  2. Parameter decreasing to bottom.
+		key_frames[3] = 9000;	//  3. Parameter increasing to start.
+	}
+	else
+	{
+		key_frames[0] = 0;	//  0. Start.
+		key_frames[1] = 2000;	//  1. Parameter increasing to top.
+		key_frames[2] = 4000;	//  2. Parameter decreasing to bottom.
+		key_frames[3] = 2000;	//  3. Parameter increasing to start.
+	}
+
+	key_parameter_values[0] = program_state->fractal_parameter_start;
+	key_parameter_values[1] = program_state->fractal_parameter_max;
+	key_parameter_values[2] = program_state->fractal_parameter_min;
+	key_parameter_values[3] = program_state->fractal_parameter_start;
+}
+
+// Get the fractal parameter the parameter animation reaches at a frame (wrapping around):
+float get_animation_parameter(FracRenderProgramState *program_state, uint64_t frame)
+{
+	int num_key_frames = 4;
+	uint64_t key_frames[4];
+	float key_parameter_values[4];
+	get_parameter_animation_key_frames(program_state, key_frames, key_parameter_values);
+
+	uint64_t total_frames = 0;
+	for (int i = 0; i < num_key_frames; i++) { total_frames += key_frames[i]; }
+	frame %= total_frames;
+
+	// Straight line between the key frames either side:
+	uint64_t frames = 0;
+	for (int i = 1; i < num_key_frames; i++)
+	{
+		if (frame < (frames + key_frames[i]))
+		{
+			float t = (float)(frame - frames) / (float)key_frames[i];
+			return key_parameter_values[i - 1] +
+				((key_parameter_values[i] - key_parameter_values[i - 1]) * t);
+		}
+		frames += key_frames[i];
+	}
+
+	return key_parameter_values[num_key_frames - 1];
+}
+
 // Fly through Hall of Pillars:
 void update_animation_flythrough(FracRenderProgramState *program_state)
 {
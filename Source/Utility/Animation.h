@@ -22,6 +22,13 @@ void update_animation_none(FracRenderProgramState *program_state);
 // Vary fractal parameter over time:
 void update_animation_parameter(FracRenderProgramState *program_state);
 
+// Get key frames (frames since the previous one) and parameter values of the parameter animation:
+void get_parameter_animation_key_frames(FracRenderProgramState *program_state,
+				uint64_t *key_frames, float *key_parameter_values);
+
+// Get the fractal parameter the parameter animation reaches at a frame (wrapping around):
+float get_animation_parameter(FracRenderProgramState *program_state, uint64_t frame);
+
 // Fly through Hall of Pillars:
 void update_animation_flythrough(FracRenderProgramState *program_state);
 
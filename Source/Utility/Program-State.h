@@ -44,6 +44,32 @@ typedef struct {
 	// Name of performance file:
 	char performance_file_name[256];
 
+	// Rendering settings:
+	int headless_width;
+	int headless_height;
+	int max_frames;
+	int dump_frames;
+	int frames_in_flight;
+	int prerecord;
+	int compute_geometry;
+
+	// 3D SDF settings:
+	int sdf_threads;
+	int sdf_simd;
+	int sdf_layout;
+	int sdf_texture;
+	int sdf_format;
+	int sdf_cache;
+	int sdf_levels;
+	int sdf_bake;
+	int sdf_rebake;
+	int sdf_cull;
+	int sdf_transform;
+	int sdf_progressive;
+	int sdf_memory;
+	int sdf_symmetry;
+	int sdf_shading;
+
 	// Fractal parameter:
 	float fractal_parameter;
 	float fractal_parameter_start;
@@ -75,6 +75,47 @@ void set_up_program_state(int argc, char **argv, FracRenderProgramState *program
 	program_state->optimize = -1;
 	program_state->animation = -1;
 	program_state->performance = -1;
+
+	// Default settings:
+	program_state->headless_width = 0;
+	program_state->headless_height = 0;
+	program_state->max_frames = 0;
+	program_state->dump_frames = 0;
+	program_state->frames_in_flight = FRACRENDER_DEFAULT_FRAMES_IN_FLIGHT;
+	program_state->prerecord = 0;
+	program_state->compute_geometry = 0;
+	program_state->sdf_threads = 0;
+	program_state->sdf_simd = -1;
+	program_state->sdf_layout = 0;
+	program_state->sdf_texture = 0;
+	program_state->sdf_format = 0;
+	program_state->sdf_cache = 1;
+	program_state->sdf_levels = 0;
+	program_state->sdf_bake = 0;
+	program_state->sdf_rebake = 1;
+	program_state->sdf_cull = 0;
+	program_state->sdf_transform = 0;
+	program_state->sdf_progressive = 0;
+	program_state->sdf_memory = 0;
+	program_state->sdf_symmetry = 0;
+	program_state->sdf_shading = 0;
+
+	// Settings (--name=value) can go anywhere. Everything else is a numbered argument:
+	int num_arguments = 1;
+	for (int i = 1; i < argc; i++)
+	{
+		if ((argv[i][0] == '-') && (argv[i][1] == '-'))
+		{
+			set_up_program_setting(argv[i], program_state);
+		}
+		else
+		{
+			argv[num_arguments] = argv[i];
+			num_arguments++;
+		}
+	}
+	argc = num_arguments;
+
 	if (argc > 1)
 	{
 		// Fractal type. -1 = 2D Mandelbrot, 0 = Mandelbulb, 1 = Hall of Pillars.
@@ -110,6 +151,146 @@ void set_up_program_state(int argc, char **argv, FracRenderProgramState *program
 		program_state->animation = 0;
 	}
 
+	// Check 3D SDF settings (the 3D texture holds a dense grid):
+	if ((program_state->sdf_layout == 2) && (program_state->fractal_type != 1))
+	{
+		printf("Warning: 3D SDF clipmap is only for Hall of Pillars. Falling back to"
+				" the dense layout.\n");
+		program_state->sdf_layout = 0;
+	}
+	if ((program_state->sdf_texture == 1) && (program_state->sdf_layout != 0))
+	{
+		printf("Warning: 3D SDF texture needs the dense layout. Falling back to"
+				" a storage buffer.\n");
+		program_state->sdf_texture = 0;
+	}
+	if ((program_state->sdf_format != 0) && (program_state->sdf_layout != 0))
+	{
+		printf("Warning: Sparse, clipmap and brick pool 3D SDFs are always stored as"
+				" 32-bit floats. Ignoring the storage format.\n");
+		program_state->sdf_format = 0;
+	}
+	if ((program_state->sdf_bake == 1) &&
+		((program_state->sdf_layout != 0) || (program_state->sdf_texture != 0)))
+	{
+		printf("Warning: 3D SDF can only be calculated on the GPU into a dense storage"
+				" buffer. Calculating it on the CPU.\n");
+		program_state->sdf_bake = 0;
+	}
+	if ((program_state->sdf_cull == 1) &&
+		((program_state->sdf_layout != 0) || (program_state->sdf_bake != 0)))
+	{
+		printf("Warning: 3D SDF culling is only for the dense layout calculated on the"
+				" CPU. Calculating every voxel.\n");
+		program_state->sdf_cull = 0;
+	}
+	if ((program_state->sdf_transform == 1) &&
+		((program_state->sdf_layout != 0) || (program_state->sdf_bake != 0)))
+	{
+		printf("Warning: 3D SDF distance transform is only for the dense layout calculated"
+				" on the CPU. Estimating every voxel.\n");
+		program_state->sdf_transform = 0;
+	}
+	if ((program_state->sdf_symmetry == 1) && (program_state->fractal_type == 0) &&
+		((program_state->sdf_layout != 0) || (program_state->sdf_texture != 0) ||
+		(program_state->sdf_bake != 0) || (program_state->sdf_transform != 0) ||
+		(program_state->animation == 0)))
+	{
+		printf("Warning: Only the Mandelbulb's dense 3D SDF can be folded by symmetry, in a"
+			" storage buffer calculated on the CPU by estimating every voxel, and"
+			" without the parameter animation. Storing all of it.\n");
+		program_state->sdf_symmetry = 0;
+	}
+	if ((program_state->sdf_symmetry == 1) && ((program_state->fractal_type < 0) ||
+		((program_state->fractal_type == 1) && (program_state->sdf_layout == 2))))
+	{
+		printf("Warning: 3D SDF can only be folded by symmetry for the Mandelbulb, or for"
+			" the Hall of Pillars outside of a clipmap. Storing all of it.\n");
+		program_state->sdf_symmetry = 0;
+	}
+	if ((program_state->sdf_shading == 1) &&
+		((program_state->fractal_type != 0) || (program_state->optimize != 0) ||
+		(program_state->sdf_layout != 0) || (program_state->sdf_texture != 0) ||
+		(program_state->sdf_bake != 0) || (program_state->sdf_transform != 0) ||
+		(program_state->sdf_symmetry != 0)))
+	{
+		printf("Warning: Shading can only be stored with the Mandelbulb's unfolded dense 3D"
+			" SDF, in a storage buffer calculated on the CPU by estimating every voxel."
+			" Iterating in the colour pass.\n");
+		program_state->sdf_shading = 0;
+	}
+	if ((program_state->sdf_progressive > 0) &&
+		((program_state->sdf_layout != 0) || (program_state->sdf_texture != 0) ||
+		((program_state->sdf_symmetry != 0) && (program_state->fractal_type == 0)) ||
+		(program_state->sdf_shading != 0) || (program_state->optimize != 0) ||
+		((program_state->animation == 0) && (program_state->sdf_rebake == 1))))
+	{
+		printf("Warning: 3D SDF can only be refined in the background in an unfolded dense"
+			" storage buffer without stored shading, and without the parameter"
+			" animation. Calculating all levels.\n");
+		program_state->sdf_progressive = 0;
+	}
+	if (program_state->sdf_memory < 0)
+	{
+		printf("Warning: 3D SDF memory budget can't be negative. Ignoring it.\n");
+		program_state->sdf_memory = 0;
+	}
+
+	// Check rendering settings:
+	if ((program_state->headless_width < 0) || (program_state->headless_height < 0) ||
+		((program_state->headless_width == 0) != (program_state->headless_height == 0)))
+	{
+		printf("Warning: Offscreen size must be given as WIDTHxHEIGHT. Opening a"
+				" window.\n");
+		program_state->headless_width = 0;
+		program_state->headless_height = 0;
+	}
+	if (program_state->max_frames < 0)
+	{
+		printf("Warning: Number of frames can't be negative. Ignoring it.\n");
+		program_state->max_frames = 0;
+	}
+	if ((program_state->headless_width > 0) && (program_state->max_frames == 0) &&
+		(program_state->performance == -1))
+	{
+		printf("Warning: Without a window or performance measurements, nothing stops"
+			" the rendering. Stopping after %d frames.\n",
+			FRACRENDER_HEADLESS_DEFAULT_FRAMES);
+		program_state->max_frames = FRACRENDER_HEADLESS_DEFAULT_FRAMES;
+	}
+	if ((program_state->dump_frames != 0) &&
+		((program_state->headless_width == 0) || (program_state->dump_frames < 0)))
+	{
+		printf("Warning: Frames can only be dumped when rendering offscreen, every N > 0"
+			" frames. Not dumping frames.\n");
+		program_state->dump_frames = 0;
+	}
+	if ((program_state->frames_in_flight < 1) ||
+		(program_state->frames_in_flight > FRACRENDER_MAX_FRAMES_IN_FLIGHT))
+	{
+		printf("Warning: Frames in flight must be from 1 to %d. Using %d.\n",
+			FRACRENDER_MAX_FRAMES_IN_FLIGHT, FRACRENDER_DEFAULT_FRAMES_IN_FLIGHT);
+		program_state->frames_in_flight = FRACRENDER_DEFAULT_FRAMES_IN_FLIGHT;
+	}
+	if ((program_state->prerecord != 0) && (program_state->prerecord != 1))
+	{
+		printf("Warning: Pre-recording must be 0 or 1. Recording every frame.\n");
+		program_state->prerecord = 0;
+	}
+	if ((program_state->compute_geometry != 0) && (program_state->compute_geometry != 1))
+	{
+		printf("Warning: Compute geometry pass must be 0 or 1. Using the geometry render"
+								" pass.\n");
+		program_state->compute_geometry = 0;
+	}
+	if ((program_state->compute_geometry == 1) &&
+		((program_state->fractal_type == -1) || (program_state->optimize != -1)))
+	{
+		printf("Warning: The compute geometry pass only traces the Mandelbulb and Hall of"
+			" Pillars, without optimization. Using the geometry render pass.\n");
+		program_state->compute_geometry = 0;
+	}
+
 	// Get performance file name:
 	char *default_name = "./Performance-Measurements/00-Default-Name.txt";
 	if (argc > 5) { strcpy(program_state->performance_file_name, argv[5]); }
@@ -217,6 +398,155 @@ void set_up_program_state(int argc, char **argv, FracRenderProgramState *program
 	program_state->mouse_sensitivity	= 7.5f;
 }
 
+// Set up a single setting of the form --name=value:
+void set_up_program_setting(char *setting, FracRenderProgramState *program_state)
+{
+	char *value = strchr(setting, '=');
+	if (!value)
+	{
+		printf("Warning: Setting \"%s\" has no value. Ignoring it.\n", setting);
+		return;
+	}
+	value++;
+
+	if (strncmp(setting, "--headless=", strlen("--headless=")) == 0)
+	{
+		// Render offscreen at WIDTHxHEIGHT, without a window. 0 = Open a window.
+		if (sscanf(value, "%dx%d", &program_state->headless_width,
+					&program_state->headless_height) != 2)
+		{
+			program_state->headless_width = 0;
+			program_state->headless_height = 0;
+		}
+	}
+	else if (strncmp(setting, "--frames=", strlen("--frames=")) == 0)
+	{
+		// Frames to render before stopping. 0 = Until the window is closed or the
+		// performance measurements finish.
+		program_state->max_frames = atoi(value);
+	}
+	else if (strncmp(setting, "--dump=", strlen("--dump=")) == 0)
+	{
+		// Write every Nth frame rendered offscreen to a PPM file. 0 = No frame dumps.
+		program_state->dump_frames = atoi(value);
+	}
+	else if (strncmp(setting, "--frames-in-flight=", strlen("--frames-in-flight=")) == 0)
+	{
+		// Frames the CPU can record ahead of the GPU, each with its own frame slot.
+		program_state->frames_in_flight = atoi(value);
+	}
+	else if (strncmp(setting, "--prerecord=", strlen("--prerecord=")) == 0)
+	{
+		// Record command buffers once and reuse them. 0 = Record every frame.
+		program_state->prerecord = atoi(value);
+	}
+	else if (strncmp(setting, "--compute-geometry=", strlen("--compute-geometry=")) == 0)
+	{
+		// Trace the geometry pass in tiles with a compute shader. 0 = Geometry render pass.
+		program_state->compute_geometry = atoi(value);
+	}
+	else if (strncmp(setting, "--sdf-threads=", strlen("--sdf-threads=")) == 0)
+	{
+		// Threads used to calculate the 3D SDF. 0 = One per processor.
+		program_state->sdf_threads = atoi(value);
+	}
+	else if (strncmp(setting, "--sdf-simd=", strlen("--sdf-simd=")) == 0)
+	{
+		// Instruction set used to calculate the 3D SDF. -1 = Best available, 0 = Scalar,
+		// 1 = SSE4.1, 2 = AVX2.
+		program_state->sdf_simd = atoi(value);
+	}
+	else if (strncmp(setting, "--sdf-layout=", strlen("--sdf-layout=")) == 0)
+	{
+		// Layout of the 3D SDF. 0 = Dense array of voxels, 1 = Sparse octree, 2 = Clipmap,
+		// 3 = Brick pool.
+		if (value[0] == '1') { program_state->sdf_layout = 1; }
+		else if (value[0] == '2') { program_state->sdf_layout = 2; }
+		else if (value[0] == '3') { program_state->sdf_layout = 3; }
+		else { program_state->sdf_layout = 0; }
+	}
+	else if (strncmp(setting, "--sdf-texture=", strlen("--sdf-texture=")) == 0)
+	{
+		// GPU storage of the 3D SDF. 0 = Storage buffer, 1 = 3D texture (filtered).
+		if (value[0] == '1') { program_state->sdf_texture = 1; }
+		else { program_state->sdf_texture = 0; }
+	}
+	else if (strncmp(setting, "--sdf-format=", strlen("--sdf-format=")) == 0)
+	{
+		// Storage format of the 3D SDF. 0 = 32-bit float, 1 = 16-bit float, 2 = 8-bit.
+		if (value[0] == '1') { program_state->sdf_format = 1; }
+		else if (value[0] == '2') { program_state->sdf_format = 2; }
+		else { program_state->sdf_format = 0; }
+	}
+	else if (strncmp(setting, "--sdf-cache=", strlen("--sdf-cache=")) == 0)
+	{
+		// Load and save the 3D SDF in the on-disk cache. 0 = Always calculate it.
+		if (value[0] == '0') { program_state->sdf_cache = 0; }
+		else { program_state->sdf_cache = 1; }
+	}
+	else if (strncmp(setting, "--sdf-levels=", strlen("--sdf-levels=")) == 0)
+	{
+		// Levels of the 3D SDF. 0 = Default for the fractal.
+		program_state->sdf_levels = atoi(value);
+	}
+	else if (strncmp(setting, "--sdf-bake=", strlen("--sdf-bake=")) == 0)
+	{
+		// Where the 3D SDF is calculated. 0 = CPU, 1 = GPU (compute shader).
+		if (value[0] == '1') { program_state->sdf_bake = 1; }
+		else { program_state->sdf_bake = 0; }
+	}
+	else if (strncmp(setting, "--sdf-rebake=", strlen("--sdf-rebake=")) == 0)
+	{
+		// Recalculate the 3D SDF as the parameter animation goes. 0 = Keep the first one.
+		if (value[0] == '0') { program_state->sdf_rebake = 0; }
+		else { program_state->sdf_rebake = 1; }
+	}
+	else if (strncmp(setting, "--sdf-cull=", strlen("--sdf-cull=")) == 0)
+	{
+		// Fill in dense 3D SDF voxels far from the surface without calculating them.
+		// 0 = Calculate every voxel.
+		if (value[0] == '1') { program_state->sdf_cull = 1; }
+		else { program_state->sdf_cull = 0; }
+	}
+	else if (strncmp(setting, "--sdf-transform=", strlen("--sdf-transform=")) == 0)
+	{
+		// Estimate dense 3D SDF voxels only near the surface, and fill in the rest with a
+		// distance transform. 0 = Estimate every voxel.
+		if (value[0] == '1') { program_state->sdf_transform = 1; }
+		else { program_state->sdf_transform = 0; }
+	}
+	else if (strncmp(setting, "--sdf-progressive=", strlen("--sdf-progressive=")) == 0)
+	{
+		// Levels of the dense 3D SDF shown first, refined in the background afterwards.
+		// 0 = Calculate all levels before the first frame.
+		program_state->sdf_progressive = atoi(value);
+	}
+	else if (strncmp(setting, "--sdf-memory=", strlen("--sdf-memory=")) == 0)
+	{
+		// Most memory the 3D SDF may use, in MB. Levels and storage format are reduced
+		// until it fits. 0 = Only limited by the device and the host.
+		program_state->sdf_memory = atoi(value);
+	}
+	else if (strncmp(setting, "--sdf-symmetry=", strlen("--sdf-symmetry=")) == 0)
+	{
+		// Store only a wedge of the Mandelbulb's dense 3D SDF, or widen the Hall of
+		// Pillars' by its mirror images, and fold lookups into it. 0 = Store all of it.
+		if (value[0] == '1') { program_state->sdf_symmetry = 1; }
+		else { program_state->sdf_symmetry = 0; }
+	}
+	else if (strncmp(setting, "--sdf-shading=", strlen("--sdf-shading=")) == 0)
+	{
+		// Store a normal and orbit trap colour with each voxel of the Mandelbulb's dense 3D
+		// SDF, for the colour pass to read. 0 = Iterate in the colour pass.
+		if (value[0] == '1') { program_state->sdf_shading = 1; }
+		else { program_state->sdf_shading = 0; }
+	}
+	else
+	{
+		printf("Warning: Unknown setting \"%s\". Ignoring it.\n", setting);
+	}
+}
+
 // Set up scene uniform object:
 void set_up_scene_uniform(FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d,
 					FracRenderVulkanSceneUniform *scene_uniform)
@@ -228,6 +558,15 @@ void set_up_scene_uniform(FracRenderProgramState *program_state, FracRenderSDF3D
 		scene_uniform->sdf_3d_centre	= sdf_3d->centre;
 		scene_uniform->sdf_3d_size	= sdf_3d->size;
 		scene_uniform->sdf_3d_levels	= sdf_3d->levels;
+		scene_uniform->sdf_3d_layout	= sdf_3d->layout;
+		scene_uniform->sdf_3d_format	= sdf_3d->format;
+		scene_uniform->sdf_3d_symmetry	= sdf_3d->symmetry;
+		scene_uniform->sdf_3d_mirror	= sdf_3d->mirror;
+		scene_uniform->sdf_3d_shading	= 0;
+		if (sdf_3d->shading == 1)
+		{
+			scene_uniform->sdf_3d_shading = get_sdf_3d_shading_offset(sdf_3d);
+		}
 	}
 	else
 	{
@@ -235,6 +574,19 @@ void set_up_scene_uniform(FracRenderProgramState *program_state, FracRenderSDF3D
 		scene_uniform->sdf_3d_centre	= initialize_vector_3(0.f, 0.f, 0.f);
 		scene_uniform->sdf_3d_size	= 0.f;
 		scene_uniform->sdf_3d_levels	= 0;
+		scene_uniform->sdf_3d_layout	= 0;
+		scene_uniform->sdf_3d_format	= 0;
+		scene_uniform->sdf_3d_symmetry	= 0;
+		scene_uniform->sdf_3d_mirror	= 0;
+		scene_uniform->sdf_3d_shading	= 0;
+	}
+
+	// Clipmap cascades:
+	scene_uniform->sdf_3d_num_cascades = 0;
+	memset(scene_uniform->sdf_3d_cascades, 0, sizeof(scene_uniform->sdf_3d_cascades));
+	if ((program_state->optimize == 0) && (sdf_3d->layout == 2))
+	{
+		set_sdf_3d_clipmap_uniform(sdf_3d, scene_uniform);
 	}
 
 	// Set up fractal information:
@@ -267,6 +619,9 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 	base->window		= NULL;
 	base->surface		= VK_NULL_HANDLE;
 
+	base->headless_extent.width	= program_state->headless_width;
+	base->headless_extent.height	= program_state->headless_height;
+
 	base->debug_messenger	= VK_NULL_HANDLE;
 
 	// Device:
@@ -276,6 +631,9 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 	device->num_device_extensions	= 1;
 	device->device_extensions[0]	= VK_KHR_SWAPCHAIN_EXTENSION_NAME;
 
+	// Nothing is presented without a window:
+	if (program_state->headless_width > 0) { device->num_device_extensions = 0; }
+
 	device->graphics_family_index	= 100;
 	device->graphics_queue		= VK_NULL_HANDLE;
 	device->present_family_index	= 100;
@@ -300,6 +658,8 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 	swapchain->swapchain_format		= VK_FORMAT_UNDEFINED;
 	swapchain->swapchain_extent.width	= 0;
 	swapchain->swapchain_extent.height	= 0;
+	swapchain->headless			= 0;
+	swapchain->headless_memory		= NULL;
 
 	// Descriptors:
 	descriptors->descriptor_pool			= VK_NULL_HANDLE;
@@ -310,6 +670,9 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 	descriptors->scene_descriptor			= VK_NULL_HANDLE;
 	descriptors->scene_buffer			= VK_NULL_HANDLE;
 	descriptors->scene_memory			= VK_NULL_HANDLE;
+	descriptors->num_scene_slices			= program_state->frames_in_flight;
+	descriptors->scene_slice_size			= 0;
+	descriptors->scene_data				= NULL;
 
 	descriptors->num_g_buffer_descriptors		= 1;
 	descriptors->g_buffer_descriptor_layout		= VK_NULL_HANDLE;
@@ -319,10 +682,18 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 	descriptors->sdf_3d_descriptor			= VK_NULL_HANDLE;
 	descriptors->sdf_3d_buffer			= VK_NULL_HANDLE;
 	descriptors->sdf_3d_memory			= VK_NULL_HANDLE;
+	descriptors->sdf_3d_memory_mapped		= 0;
+	descriptors->sdf_3d_image			= VK_NULL_HANDLE;
+	descriptors->sdf_3d_image_view			= VK_NULL_HANDLE;
+	descriptors->sdf_3d_image_format		= VK_FORMAT_UNDEFINED;
+	descriptors->sdf_3d_sampler			= VK_NULL_HANDLE;
 
 	descriptors->temporal_cache_descriptor_layout	= VK_NULL_HANDLE;
 	descriptors->temporal_cache_descriptor		= VK_NULL_HANDLE;
 
+	descriptors->g_buffer_storage_descriptor_layout	= VK_NULL_HANDLE;
+	descriptors->g_buffer_storage_descriptor	= VK_NULL_HANDLE;
+
 	// Pipeline:
 	pipeline->geometry_pipeline_layout	= VK_NULL_HANDLE;
 	pipeline->colour_pipeline_layout	= VK_NULL_HANDLE;
@@ -338,6 +709,15 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 	pipeline->colour_vertex_shader		= VK_NULL_HANDLE;
 	pipeline->colour_fragment_shader	= VK_NULL_HANDLE;
 
+	pipeline->sdf_3d_bake_shader_path	= NULL;
+	pipeline->colour_sdf_3d			= 0;
+
+	pipeline->compute_geometry			= program_state->compute_geometry;
+	pipeline->geometry_compute_shader		= VK_NULL_HANDLE;
+	pipeline->geometry_compute_shader_path		= NULL;
+	pipeline->geometry_compute_pipeline_layout	= VK_NULL_HANDLE;
+	pipeline->geometry_compute_pipeline		= VK_NULL_HANDLE;
+
 	if (program_state->fractal_type == 0)
 	{
 		#define SHADER_DIR_ "Assets/Shaders/Mandelbulb/"
@@ -347,8 +727,18 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 			// 3D SDF:
 			pipeline->geometry_vertex_shader_path =
 				SHADER_DIR_"Geometry-Mandelbulb-SDF-3D.vert.sprv";
-			pipeline->geometry_fragment_shader_path =
-				SHADER_DIR_"Geometry-Mandelbulb-SDF-3D.frag.sprv";
+			if (program_state->sdf_texture == 1)
+			{
+				pipeline->geometry_fragment_shader_path =
+					SHADER_DIR_"Geometry-Mandelbulb-SDF-3D-Texture.frag.sprv";
+			}
+			else
+			{
+				pipeline->geometry_fragment_shader_path =
+					SHADER_DIR_"Geometry-Mandelbulb-SDF-3D.frag.sprv";
+			}
+			pipeline->sdf_3d_bake_shader_path =
+				SHADER_DIR_"Bake-Mandelbulb-SDF-3D.comp.sprv";
 		}
 		else if (program_state->optimize == 1)
 		{
@@ -365,11 +755,23 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 				SHADER_DIR_"Geometry-Mandelbulb.vert.sprv";
 			pipeline->geometry_fragment_shader_path =
 				SHADER_DIR_"Geometry-Mandelbulb.frag.sprv";
+			pipeline->geometry_compute_shader_path =
+				SHADER_DIR_"Geometry-Mandelbulb.comp.sprv";
 		}
 		pipeline->colour_vertex_shader_path =
 			SHADER_DIR_"Colour-Mandelbulb.vert.sprv";
-		pipeline->colour_fragment_shader_path =
-			SHADER_DIR_"Colour-Mandelbulb.frag.sprv";
+		if (program_state->sdf_shading == 1)
+		{
+			// Stored shading, read from the 3D SDF:
+			pipeline->colour_fragment_shader_path =
+				SHADER_DIR_"Colour-Mandelbulb-SDF-3D.frag.sprv";
+			pipeline->colour_sdf_3d = 1;
+		}
+		else
+		{
+			pipeline->colour_fragment_shader_path =
+				SHADER_DIR_"Colour-Mandelbulb.frag.sprv";
+		}
 		#undef SHADER_DIR_
 	}
 	else if (program_state->fractal_type == 1)
@@ -381,8 +783,18 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 			// 3D SDF:
 			pipeline->geometry_vertex_shader_path =
 				SHADER_DIR_"Geometry-Hall-Of-Pillars-SDF-3D.vert.sprv";
-			pipeline->geometry_fragment_shader_path =
-				SHADER_DIR_"Geometry-Hall-Of-Pillars-SDF-3D.frag.sprv";
+			if (program_state->sdf_texture == 1)
+			{
+				pipeline->geometry_fragment_shader_path = SHADER_DIR_
+					"Geometry-Hall-Of-Pillars-SDF-3D-Texture.frag.sprv";
+			}
+			else
+			{
+				pipeline->geometry_fragment_shader_path =
+					SHADER_DIR_"Geometry-Hall-Of-Pillars-SDF-3D.frag.sprv";
+			}
+			pipeline->sdf_3d_bake_shader_path =
+				SHADER_DIR_"Bake-Hall-Of-Pillars-SDF-3D.comp.sprv";
 		}
 		else if (program_state->optimize == 1)
 		{
@@ -399,6 +811,8 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 				SHADER_DIR_"Geometry-Hall-Of-Pillars.vert.sprv";
 			pipeline->geometry_fragment_shader_path =
 				SHADER_DIR_"Geometry-Hall-Of-Pillars.frag.sprv";
+			pipeline->geometry_compute_shader_path =
+				SHADER_DIR_"Geometry-Hall-Of-Pillars.comp.sprv";
 		}
 		pipeline->colour_vertex_shader_path =
 			SHADER_DIR_"Colour-Hall-Of-Pillars.vert.sprv";
@@ -436,6 +850,7 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 	}
 	framebuffers->g_buffer_images		= NULL;
 	framebuffers->g_buffer_image_views	= NULL;
+	framebuffers->g_buffer_storage		= program_state->compute_geometry;
 
 	// Allocate memory for G-buffer formats (free in destroy_vulkan_framebuffers):
 	framebuffers->g_buffer_formats		= malloc(framebuffers->num_g_buffer_images *
@@ -458,11 +873,20 @@ void initialize_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevic
 	framebuffers->temporal_cache_format		= VK_FORMAT_R32G32B32A32_SFLOAT;
 
 	// Commands:
-	commands->command_pool		= VK_NULL_HANDLE;
-	commands->command_buffers	= NULL;
-	commands->fences		= NULL;
-	commands->image_available	= VK_NULL_HANDLE;
-	commands->render_finished	= VK_NULL_HANDLE;
+	commands->command_pool			= VK_NULL_HANDLE;
+	commands->num_frames_in_flight		= program_state->frames_in_flight;
+	commands->current_frame			= 0;
+	commands->command_buffers		= NULL;
+	commands->fences			= NULL;
+	commands->image_available		= NULL;
+	commands->num_render_finished		= 0;
+	commands->render_finished		= NULL;
+	commands->prerecord			= program_state->prerecord;
+	commands->num_prerecorded_images	= 0;
+	commands->prerecorded_command_buffers	= NULL;
+	commands->prerecorded_generations	= NULL;
+	commands->generation			= 0;
+	commands->prerecorded_sdf_3d_descriptor	= VK_NULL_HANDLE;
 
 	// Performance:
 	performance->query_pool		= VK_NULL_HANDLE;
@@ -507,6 +931,10 @@ int set_up_vulkan(FracRenderVulkanBase *base, FracRenderVulkanDevice *device,
 		return -1;
 	}
 
+	// Set up 3D SDF, now the device's memory is known:
+	set_up_sdf_3d(program_state, sdf_3d, get_vulkan_sdf_3d_memory_limit(device,
+							program_state->sdf_texture));
+
 	// Create swapchain:
 	if (initialize_vulkan_swapchain(base, device, swapchain) != 0)
 	{
@@ -541,6 +969,16 @@ int set_up_vulkan(FracRenderVulkanBase *base, FracRenderVulkanDevice *device,
 		return -1;
 	}
 
+	// Create compute geometry pass:
+	if (pipeline->compute_geometry == 1)
+	{
+		if (initialize_vulkan_compute_geometry(device, framebuffers, descriptors,
+								pipeline) != 0)
+		{
+			return -1;
+		}
+	}
+
 	// Create command pool, fences and semaphores:
 	if (initialize_vulkan_commands(device, swapchain, commands) != 0)
 	{
@@ -550,7 +988,7 @@ int set_up_vulkan(FracRenderVulkanBase *base, FracRenderVulkanDevice *device,
 	// Set up performance measuring structures:
 	if (program_state->performance > -1)
 	{
-		if (initialize_vulkan_performance(device, swapchain, performance) != 0)
+		if (initialize_vulkan_performance(device, commands, performance) != 0)
 		{
 			return -1;
 		}
@@ -558,10 +996,21 @@ int set_up_vulkan(FracRenderVulkanBase *base, FracRenderVulkanDevice *device,
 
 	if (program_state->optimize == 0)
 	{
-		// Copy SDF data into GPU buffer:
-		if (copy_sdf_3d_data(device, descriptors, commands, sdf_3d) != 0)
+		if ((sdf_3d->deferred == 1) && (sdf_3d->bake == 1))
 		{
-			return -1;
+			// Calculate SDF on the GPU, straight into its buffer:
+			if (bake_sdf_3d_data(device, descriptors, pipeline, commands, sdf_3d) != 0)
+			{
+				return -1;
+			}
+		}
+		else
+		{
+			// Copy SDF data into GPU buffer:
+			if (copy_sdf_3d_data(device, descriptors, commands, sdf_3d) != 0)
+			{
+				return -1;
+			}
 		}
 	}
 	else if (program_state->optimize == 1)
@@ -590,11 +1039,14 @@ void destroy_vulkan_structs(FracRenderVulkanBase *base, FracRenderVulkanDevice *
 	destroy_vulkan_performance(device, performance);
 
 	// Destroy Vulkan command pool, fences and semaphores:
-	destroy_vulkan_commands(device, swapchain, commands);
+	destroy_vulkan_commands(device, commands);
 
 	// Destroy Vulkan framebuffers:
 	destroy_vulkan_framebuffers(device, swapchain, framebuffers);
 
+	// Destroy Vulkan compute geometry pass:
+	destroy_vulkan_compute_geometry(device, descriptors, pipeline);
+
 	// Destroy Vulkan pipeline:
 	destroy_vulkan_pipeline(device, pipeline);
 
@@ -893,6 +1345,11 @@ void print_vulkan_handles(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 		printf("Scene Memory\t\t---> %p\n", descriptors->scene_memory);
 	}
 
+	// Scene Uniform Ring:
+	printf("Scene Slices\t\t---> %u x %lu bytes, mapped at %p\n",
+		descriptors->num_scene_slices, descriptors->scene_slice_size,
+		descriptors->scene_data);
+
 	// Number of G-Buffer Descriptors:
 	printf("Number of G-Buffer Descriptors\t---> %d\n", descriptors->num_g_buffer_descriptors);
 
@@ -993,6 +1450,28 @@ void print_vulkan_handles(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 			descriptors->temporal_cache_descriptor);
 	}
 
+	// G-Buffer Storage Descriptor Layout:
+	if (descriptors->g_buffer_storage_descriptor_layout == VK_NULL_HANDLE)
+	{
+		printf("G-Buffer Storage Descriptor Layout\t---> VK_NULL_HANDLE\n");
+	}
+	else
+	{
+		printf("G-Buffer Storage Descriptor Layout\t---> %p\n",
+			descriptors->g_buffer_storage_descriptor_layout);
+	}
+
+	// G-Buffer Storage Descriptor:
+	if (descriptors->g_buffer_storage_descriptor == VK_NULL_HANDLE)
+	{
+		printf("G-Buffer Storage Descriptor\t---> VK_NULL_HANDLE\n");
+	}
+	else
+	{
+		printf("G-Buffer Storage Descriptor\t---> %p\n",
+			descriptors->g_buffer_storage_descriptor);
+	}
+
 	printf("----------------------------------------");
 	printf("----------------------------------------\n\n");
 
@@ -1106,6 +1585,42 @@ void print_vulkan_handles(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 	}
 	printf("Shader Path:\t---> %s\n", pipeline->colour_fragment_shader_path);
 
+	// Compute Geometry Pipeline Layout:
+	if (pipeline->geometry_compute_pipeline_layout == VK_NULL_HANDLE)
+	{
+		printf("Compute Geometry Pipeline Layout\t---> VK_NULL_HANDLE\n");
+	}
+	else
+	{
+		printf("Compute Geometry Pipeline Layout\t---> %p\n",
+			pipeline->geometry_compute_pipeline_layout);
+	}
+
+	// Compute Geometry Pipeline:
+	if (pipeline->geometry_compute_pipeline == VK_NULL_HANDLE)
+	{
+		printf("Compute Geometry Pipeline\t---> VK_NULL_HANDLE\n");
+	}
+	else
+	{
+		printf("Compute Geometry Pipeline\t---> %p\n",
+			pipeline->geometry_compute_pipeline);
+	}
+
+	// Compute Geometry Shader and Path:
+	if (pipeline->geometry_compute_shader == VK_NULL_HANDLE)
+	{
+		printf("Compute Geometry Shader\t---> VK_NULL_HANDLE\n");
+	}
+	else
+	{
+		printf("Compute Geometry Shader\t---> %p\n", pipeline->geometry_compute_shader);
+	}
+	if (pipeline->geometry_compute_shader_path)
+	{
+		printf("Shader Path:\t---> %s\n", pipeline->geometry_compute_shader_path);
+	}
+
 	printf("----------------------------------------");
 	printf("----------------------------------------\n\n");
 
@@ -1274,7 +1789,7 @@ void print_vulkan_handles(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 	else
 	{
 		printf("Command Buffers\t\t---> %p\n", commands->command_buffers);
-		for (int i = 0; i < swapchain->num_swapchain_images; i++)
+		for (int i = 0; i < commands->num_frames_in_flight; i++)
 		{
 			if (commands->command_buffers[i] == VK_NULL_HANDLE)
 			{
@@ -1296,7 +1811,7 @@ void print_vulkan_handles(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 	else
 	{
 		printf("Fences\t\t---> %p\n", commands->fences);
-		for (int i = 0; i < swapchain->num_swapchain_images; i++)
+		for (int i = 0; i < commands->num_frames_in_flight; i++)
 		{
 			if (commands->fences[i] == VK_NULL_HANDLE)
 			{
@@ -1309,24 +1824,60 @@ void print_vulkan_handles(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 		}
 	}
 
-	// Image Available Semaphore:
-	if (commands->image_available == VK_NULL_HANDLE)
+	// Image Available Semaphores:
+	if (!commands->image_available)
 	{
-		printf("Image Available Semaphore\t---> VK_NULL_HANDLE\n");
+		printf("Image Available Semaphores\t---> NULL\n");
 	}
 	else
 	{
-		printf("Image Available Semaphore\t---> %p\n", commands->image_available);
+		printf("Image Available Semaphores\t---> %p\n", commands->image_available);
+		for (int i = 0; i < commands->num_frames_in_flight; i++)
+		{
+			if (commands->image_available[i] == VK_NULL_HANDLE)
+			{
+				printf(" ---> Semaphore %d\t---> VK_NULL_HANDLE\n", i);
+			}
+			else
+			{
+				printf(" ---> Semaphore %d\t---> %p\n",
+					i, commands->image_available[i]);
+			}
+		}
+	}
+
+	// Render Finished Semaphores:
+	if (!commands->render_finished)
+	{
+		printf("Render Finished Semaphores\t---> NULL\n");
+	}
+	else
+	{
+		printf("Render Finished Semaphores\t---> %p\n", commands->render_finished);
+		for (int i = 0; i < commands->num_render_finished; i++)
+		{
+			if (commands->render_finished[i] == VK_NULL_HANDLE)
+			{
+				printf(" ---> Semaphore %d\t---> VK_NULL_HANDLE\n", i);
+			}
+			else
+			{
+				printf(" ---> Semaphore %d\t---> %p\n",
+					i, commands->render_finished[i]);
+			}
+		}
 	}
 
-	// Render Finished Semaphore:
-	if (commands->render_finished == VK_NULL_HANDLE)
+	// Pre-recorded Command Buffers:
+	if (!commands->prerecorded_command_buffers)
 	{
-		printf("Render Finished Semaphore\t---> VK_NULL_HANDLE\n");
+		printf("Pre-recorded Command Buffers\t---> NULL\n");
 	}
 	else
 	{
-		printf("Render Finished Semaphore\t---> %p\n", commands->render_finished);
+		printf("Pre-recorded Command Buffers\t---> %p (%u per slot, generation %lu)\n",
+			commands->prerecorded_command_buffers,
+			commands->num_prerecorded_images, commands->generation);
 	}
 
 	printf("----------------------------------------");
@@ -7,8 +7,11 @@
 
 // Library includes:
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Local includes:
+#include "../SDF/SDF-3D-Shading.h"
 #include "../Vulkan/00-Vulkan-API.h"
 #include "Animation.h"
 #include "Input.h"
@@ -32,6 +35,9 @@ void print_controls();
 // Set up program state according to program inputs:
 void set_up_program_state(int argc, char **argv, FracRenderProgramState *program_state);
 
+// Set up a single setting of the form --name=value:
+void set_up_program_setting(char *setting, FracRenderProgramState *program_state);
+
 // Set up scene uniform object:
 void set_up_scene_uniform(FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d,
 					FracRenderVulkanSceneUniform *scene_uniform);
@@ -0,0 +1,146 @@
+#include "Work-Pool.h"
+
+// Get number of threads to use (0 or less means one per online processor):
+uint32_t get_number_of_threads(int requested_threads)
+{
+	if (requested_threads > 0) { return (uint32_t)requested_threads; }
+
+	long online_processors = sysconf(_SC_NPROCESSORS_ONLN);
+	if (online_processors < 1) { return 1; }
+
+	return (uint32_t)online_processors;
+}
+
+// Run tasks 0 to (num_tasks - 1) on a pool of threads, and wait for them to finish:
+int run_work_pool(uint32_t num_threads, uint32_t num_tasks,
+			FracRenderWorkFunction function, void *user_data)
+{
+	if (num_tasks == 0) { return 0; }
+	if (num_threads == 0) { num_threads = 1; }
+	if (num_threads > num_tasks) { num_threads = num_tasks; }
+
+	FracRenderWorkPool pool;
+	pool.num_threads	= num_threads;
+	pool.function		= function;
+	pool.user_data		= user_data;
+	pool.error		= 0;
+
+	pool.threads = malloc(num_threads * sizeof(pthread_t));
+	pool.deques = malloc(num_threads * sizeof(FracRenderWorkDeque));
+	FracRenderWorker *workers = malloc(num_threads * sizeof(FracRenderWorker));
+	if ((!pool.threads) || (!pool.deques) || (!workers))
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for work pool!\n");
+		free(pool.threads);
+		free(pool.deques);
+		free(workers);
+		return -1;
+	}
+
+	// Give each worker a contiguous block of tasks to start with:
+	for (uint32_t i = 0; i < num_threads; i++)
+	{
+		pthread_mutex_init(&pool.deques[i].lock, NULL);
+		pool.deques[i].front	= (uint32_t)(((uint64_t)num_tasks * i) / num_threads);
+		pool.deques[i].back	= (uint32_t)(((uint64_t)num_tasks * (i + 1)) / num_threads);
+
+		workers[i].pool		= &pool;
+		workers[i].worker_index	= i;
+	}
+
+	// Start other workers. The calling thread is worker 0:
+	uint32_t threads_started = 1;
+	for (uint32_t i = 1; i < num_threads; i++)
+	{
+		if (pthread_create(&pool.threads[i], NULL, work_pool_worker, &workers[i]) != 0)
+		{
+			// Remaining tasks get stolen by the threads that did start:
+			fprintf(stderr, "Warning: Unable to start worker thread %d.\n", i);
+			break;
+		}
+		threads_started++;
+	}
+	work_pool_worker(&workers[0]);
+
+	// Wait for all workers to finish:
+	for (uint32_t i = 1; i < threads_started; i++)
+	{
+		pthread_join(pool.threads[i], NULL);
+	}
+
+	for (uint32_t i = 0; i < num_threads; i++)
+	{
+		pthread_mutex_destroy(&pool.deques[i].lock);
+	}
+
+	free(pool.threads);
+	free(pool.deques);
+	free(workers);
+
+	return pool.error;
+}
+
+// Worker thread main function:
+void *work_pool_worker(void *worker_data)
+{
+	FracRenderWorker *worker = worker_data;
+	FracRenderWorkPool *pool = worker->pool;
+	uint32_t task_index;
+
+	while (__atomic_load_n(&pool->error, __ATOMIC_RELAXED) == 0)
+	{
+		// Own work first:
+		int found = take_work_pool_task(&pool->deques[worker->worker_index], &task_index);
+
+		// Then steal, starting with the next worker along:
+		for (uint32_t i = 1; (i < pool->num_threads) && (found != 0); i++)
+		{
+			uint32_t victim = (worker->worker_index + i) % pool->num_threads;
+			found = steal_work_pool_task(&pool->deques[victim], &task_index);
+		}
+
+		// Nothing left anywhere:
+		if (found != 0) { break; }
+
+		if (pool->function(pool->user_data, task_index) != 0)
+		{
+			__atomic_store_n(&pool->error, -1, __ATOMIC_RELAXED);
+		}
+	}
+
+	return NULL;
+}
+
+// Take a task from a worker's own deque:
+int take_work_pool_task(FracRenderWorkDeque *deque, uint32_t *task_index)
+{
+	int result = -1;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->front < deque->back)
+	{
+		*task_index = deque->front;
+		deque->front++;
+		result = 0;
+	}
+	pthread_mutex_unlock(&deque->lock);
+
+	return result;
+}
+
+// Steal a task from another worker's deque:
+int steal_work_pool_task(FracRenderWorkDeque *deque, uint32_t *task_index)
+{
+	int result = -1;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->front < deque->back)
+	{
+		deque->back--;
+		*task_index = deque->back;
+		result = 0;
+	}
+	pthread_mutex_unlock(&deque->lock);
+
+	return result;
+}
@@ -0,0 +1,72 @@
+#ifndef FRACRENDER_UTILITY_WORK_POOL_H
+#define FRACRENDER_UTILITY_WORK_POOL_H
+
+/********************************************************************
+ * Utilities for spreading independent tasks over a pool of threads *
+ ********************************************************************/
+
+// Library includes:
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**************
+ * Structures *
+ **************/
+
+// Task function. Return 0 on success, -1 to abort the remaining tasks:
+typedef int (*FracRenderWorkFunction)(void *user_data, uint32_t task_index);
+
+typedef struct {
+	// Lock protecting the range below:
+	pthread_mutex_t lock;
+
+	// Remaining tasks. The owner takes from the front, thieves take from the back:
+	uint32_t front;
+	uint32_t back;
+} FracRenderWorkDeque;
+
+typedef struct {
+	// Threads (including the calling thread, which is worker 0):
+	uint32_t num_threads;
+	pthread_t *threads;
+
+	// One deque of task indices per worker:
+	FracRenderWorkDeque *deques;
+
+	// Work to be done:
+	FracRenderWorkFunction function;
+	void *user_data;
+
+	// Error flag, set by any failing task. 0 = OK, -1 = Error:
+	int error;
+} FracRenderWorkPool;
+
+typedef struct {
+	FracRenderWorkPool *pool;
+	uint32_t worker_index;
+} FracRenderWorker;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Get number of threads to use (0 or less means one per online processor):
+uint32_t get_number_of_threads(int requested_threads);
+
+// Run tasks 0 to (num_tasks - 1) on a pool of threads, and wait for them to finish:
+int run_work_pool(uint32_t num_threads, uint32_t num_tasks,
+			FracRenderWorkFunction function, void *user_data);
+
+// Worker thread main function:
+void *work_pool_worker(void *worker_data);
+
+// Take a task from a worker's own deque:
+int take_work_pool_task(FracRenderWorkDeque *deque, uint32_t *task_index);
+
+// Steal a task from another worker's deque:
+int steal_work_pool_task(FracRenderWorkDeque *deque, uint32_t *task_index);
+
+#endif
@@ -24,5 +24,11 @@
 #include "09-Vulkan-Commands.h"
 #include "10-Vulkan-Main.h"
 #include "11-Vulkan-Performance.h"
+#include "12-Vulkan-SDF-Bake.h"
+#include "13-Vulkan-SDF-Rebake.h"
+#include "14-Vulkan-SDF-Clipmap.h"
+#include "15-Vulkan-SDF-Progressive.h"
+#include "16-Vulkan-Headless.h"
+#include "17-Vulkan-Compute-Geometry.h"
 
 #endif
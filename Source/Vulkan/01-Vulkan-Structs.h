@@ -14,6 +14,7 @@
 // Local includes:
 #include "../../Third-Party/volk/include/volk/volk.h"
 #include "../Utility/Vectors.h"
+#include "../SDF/SDF-3D.h"
 
 typedef struct {
 	// Instance and window:
@@ -21,6 +22,9 @@ typedef struct {
 	GLFWwindow *window;
 	VkSurfaceKHR surface;
 
+	// Size of the offscreen images rendered to instead of a window (0 x 0 with a window):
+	VkExtent2D headless_extent;
+
 	// Debug messenger:
 	VkDebugUtilsMessengerEXT debug_messenger;
 } FracRenderVulkanBase;
@@ -67,6 +71,10 @@ typedef struct {
 	// Format:
 	VkFormat swapchain_format;
 	VkExtent2D swapchain_extent;
+
+	// Offscreen images standing in for the swapchain's, and their memory (headless only):
+	int headless;
+	VkDeviceMemory *headless_memory;
 } FracRenderVulkanSwapchain;
 
 typedef struct {
@@ -82,6 +90,12 @@ typedef struct {
 	VkBuffer scene_buffer;
 	VkDeviceMemory scene_memory;
 
+	// Scene uniform ring (one slice per frame slot, picked with a dynamic offset), mapped for
+	// as long as the buffer lives:
+	uint32_t num_scene_slices;
+	VkDeviceSize scene_slice_size;
+	void *scene_data;
+
 	// G-buffer descriptors:
 	uint32_t num_g_buffer_descriptors;
 	VkDescriptorSetLayout g_buffer_descriptor_layout;
@@ -93,9 +107,22 @@ typedef struct {
 	VkBuffer sdf_3d_buffer;
 	VkDeviceMemory sdf_3d_memory;
 
+	// Whether the 3D SDF buffer memory can be mapped (device-local and host-visible):
+	int sdf_3d_memory_mapped;
+
+	// 3D SDF texture (used instead of the buffer if created), with its own sampler:
+	VkImage sdf_3d_image;
+	VkImageView sdf_3d_image_view;
+	VkFormat sdf_3d_image_format;
+	VkSampler sdf_3d_sampler;
+
 	// Temporal Cache descriptor:
 	VkDescriptorSetLayout temporal_cache_descriptor_layout;
 	VkDescriptorSet temporal_cache_descriptor;
+
+	// G-buffer storage image descriptor (written by the compute geometry pass):
+	VkDescriptorSetLayout g_buffer_storage_descriptor_layout;
+	VkDescriptorSet g_buffer_storage_descriptor;
 } FracRenderVulkanDescriptors;
 
 typedef struct {
@@ -122,6 +149,20 @@ typedef struct {
 	const char *geometry_fragment_shader_path;
 	const char *colour_vertex_shader_path;
 	const char *colour_fragment_shader_path;
+
+	// 3D SDF compute shader path (only loaded while calculating the SDF on the GPU):
+	const char *sdf_3d_bake_shader_path;
+
+	// Whether the colour pass reads the 3D SDF's stored shading (bound after the G-buffer):
+	int colour_sdf_3d;
+
+	// Compute geometry pass (used instead of the geometry render pass if compute_geometry is
+	// 1, tracing the G-buffer in tiles):
+	int compute_geometry;
+	VkShaderModule geometry_compute_shader;
+	const char *geometry_compute_shader_path;
+	VkPipelineLayout geometry_compute_pipeline_layout;
+	VkPipeline geometry_compute_pipeline;
 } FracRenderVulkanPipeline;
 
 typedef struct {
@@ -136,6 +177,9 @@ typedef struct {
 	VkImageView *g_buffer_image_views;
 	VkFormat *g_buffer_formats;
 
+	// Whether the G-buffer images can also be written as storage images:
+	int g_buffer_storage;
+
 	// Temporal Cache:
 	VkImage temporal_cache_image;
 	VkDeviceMemory temporal_cache_memory;
@@ -147,15 +191,28 @@ typedef struct {
 	// Command pool:
 	VkCommandPool command_pool;
 
-	// Command buffers:
-	VkCommandBuffer *command_buffers;
+	// Frames in flight, and the frame slot the next frame is recorded into:
+	uint32_t num_frames_in_flight;
+	uint32_t current_frame;
 
-	// Fences:
+	// Command buffers, fences and "image available" semaphores (one per frame slot):
+	VkCommandBuffer *command_buffers;
 	VkFence *fences;
-
-	// Semaphores:
-	VkSemaphore image_available;
-	VkSemaphore render_finished;
+	VkSemaphore *image_available;
+
+	// "Render finished" semaphores (one per swapchain image, see 09-Vulkan-Commands.h):
+	uint32_t num_render_finished;
+	VkSemaphore *render_finished;
+
+	// Command buffers recorded once for each frame slot and swapchain image, the generation
+	// each was recorded at, the current generation, and the 3D SDF descriptor set it bound
+	// (pre-recorded mode only):
+	int prerecord;
+	uint32_t num_prerecorded_images;
+	VkCommandBuffer *prerecorded_command_buffers;
+	uint64_t *prerecorded_generations;
+	uint64_t generation;
+	VkDescriptorSet prerecorded_sdf_3d_descriptor;
 } FracRenderVulkanCommands;
 
 typedef struct {
@@ -166,6 +223,51 @@ typedef struct {
 	float timestamp_period;
 } FracRenderVulkanPerformance;
 
+// Most chunks the 3D SDF is copied to the GPU in, while it is being calculated:
+#define FRACRENDER_SDF_3D_COPY_CHUNKS 8
+
+typedef struct {
+	// Staging buffer:
+	VkBuffer staging_buffer;
+	VkDeviceMemory staging_memory;
+
+	// One command buffer per chunk. The fence goes with the last one:
+	uint32_t num_chunks;
+	VkCommandBuffer command_buffers[FRACRENDER_SDF_3D_COPY_CHUNKS];
+	VkFence fence;
+} FracRenderVulkanSDF3DCopy;
+
+// Most workgroups in one 3D SDF compute dispatch (the least any device has to allow), and
+// buffer entries per workgroup:
+#define FRACRENDER_SDF_3D_BAKE_MAX_GROUPS 65535
+#define FRACRENDER_SDF_3D_BAKE_GROUP_SIZE 64
+
+typedef struct {
+	// Compute pipeline:
+	VkShaderModule shader;
+	VkPipelineLayout pipeline_layout;
+	VkPipeline pipeline;
+
+	// Command buffer and fence:
+	VkCommandBuffer command_buffer;
+	VkFence fence;
+} FracRenderVulkanSDF3DBake;
+
+typedef struct {
+	// 3D SDF information:
+	FracRenderVector3 sdf_3d_centre;
+	float sdf_3d_size;
+	uint32_t sdf_3d_levels;
+	uint32_t sdf_3d_format;
+
+	// Fractal parameter:
+	float fractal_parameter;
+
+	// Buffer entries to fill, and the first one of the dispatch:
+	uint32_t num_entries;
+	uint32_t first_entry;
+} FracRenderVulkanSDF3DBakeConstants;
+
 typedef struct {
 	// Axes in eye coordinate system:
 	FracRenderVector3 plane_centre; float pad_0;
@@ -179,6 +281,8 @@ typedef struct {
 	FracRenderVector3 sdf_3d_centre;
 	float sdf_3d_size;
 	uint32_t sdf_3d_levels;
+	uint32_t sdf_3d_layout;
+	uint32_t sdf_3d_format;
 
 	// Aspect ratio:
 	float aspect_ratio;
@@ -188,6 +292,20 @@ typedef struct {
 
 	// View distance:
 	float view_distance;
+
+	// 3D SDF clipmap cascades. World voxel coordinates of each window's lowest corner (the
+	// fourth value is unused):
+	uint32_t sdf_3d_num_cascades; float pad_4;
+	int32_t sdf_3d_cascades[FRACRENDER_SDF_3D_CLIPMAP_CASCADES][4];
+
+	// Order of the Mandelbulb's rotational symmetry the dense 3D SDF is folded by, or 0:
+	uint32_t sdf_3d_symmetry;
+
+	// Planes through the origin the 3D SDF is mirrored in (bit 0 = x, bit 1 = y, bit 2 = z):
+	uint32_t sdf_3d_mirror;
+
+	// First entry of the dense 3D SDF's stored shading, or 0 without it:
+	uint32_t sdf_3d_shading;
 } FracRenderVulkanSceneUniform;
 
 #endif
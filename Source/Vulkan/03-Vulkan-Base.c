@@ -7,11 +7,19 @@ int initialize_vulkan_base(FracRenderVulkanBase *base, FracRenderVulkanValidatio
 	printf("----------------------------------------\n");
 	printf("Initializing Vulkan instance and window...\n");
 
-	// Initialize GLFW and make sure Vulkan is supported:
-	printf(" ---> Creating GLFW window and Vulkan surface.\n");
-	if (create_glfw_window(base) != 0)
+	// Initialize GLFW and make sure Vulkan is supported (no window when rendering offscreen):
+	if (base->headless_extent.width == 0)
 	{
-		return -1;
+		printf(" ---> Creating GLFW window and Vulkan surface.\n");
+		if (create_glfw_window(base) != 0)
+		{
+			return -1;
+		}
+	}
+	else
+	{
+		printf(" ---> Rendering offscreen at %ux%u, without a window.\n",
+			base->headless_extent.width, base->headless_extent.height);
 	}
 
 	// Create Vulkan instance:
@@ -22,10 +30,13 @@ int initialize_vulkan_base(FracRenderVulkanBase *base, FracRenderVulkanValidatio
 	}
 
 	// Create KHR surface:
-	printf(" ---> Creating the Vulkan surface.\n");
-	if (create_KHR_surface(base) != 0)
+	if (base->window)
 	{
-		return -1;
+		printf(" ---> Creating the Vulkan surface.\n");
+		if (create_KHR_surface(base) != 0)
+		{
+			return -1;
+		}
 	}
 
 #ifdef FRACRENDER_DEBUG
@@ -130,9 +141,13 @@ int create_vulkan_instance(FracRenderVulkanBase *base, FracRenderVulkanValidatio
 	application_info.engineVersion		= VK_MAKE_VERSION(1, 0, 0);
 	application_info.apiVersion		= VK_MAKE_API_VERSION(0, 1, 3, 0); // Version 1.3.
 
-	// Get GLFW extensions:
+	// Get GLFW extensions (none without a window, which also leaves GLFW uninitialized):
 	uint32_t num_glfw_extensions = 0;
-	char const **glfw_extensions = glfwGetRequiredInstanceExtensions(&num_glfw_extensions);
+	char const **glfw_extensions = NULL;
+	if (base->window)
+	{
+		glfw_extensions = glfwGetRequiredInstanceExtensions(&num_glfw_extensions);
+	}
 
 	// Gather all extension names:
 	int max_name_length = 128;
@@ -186,10 +186,16 @@ int score_physical_device(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 	// Free memory:
 	free(supported_extensions);
 
-	// Check queue families for the device:
+	// Check queue families for the device. The graphics queue also runs the 3D SDF compute
+	// shader (Vulkan guarantees a family that can do both, if any can do graphics):
 	int graphics_queue_family_found = -1;
 	int surface_queue_family_found = -1;
-	VkQueueFlags graphics_flags = VK_QUEUE_GRAPHICS_BIT;
+	if (base->surface == VK_NULL_HANDLE)
+	{
+		// Nothing is presented without a window:
+		surface_queue_family_found = 0;
+	}
+	VkQueueFlags graphics_flags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
 
 	uint32_t num_queues = 0;
 	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &num_queues, NULL);
@@ -242,6 +248,12 @@ int score_physical_device(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 	// Free memory:
 	free(queues);
 
+	// Without a window, the graphics queue stands in for the present queue:
+	if (base->surface == VK_NULL_HANDLE)
+	{
+		device->present_family_index = device->graphics_family_index;
+	}
+
 	// Check supported device features (need shaderFloat64):
 	VkPhysicalDeviceFeatures supported_features;
 	vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
@@ -8,6 +8,22 @@ int initialize_vulkan_swapchain(FracRenderVulkanBase *base, FracRenderVulkanDevi
 	printf("----------------------------------------\n");
 	printf("Initializing Vulkan swapchain...\n");
 
+	// Without a window, render to offscreen images instead:
+	if (base->headless_extent.width > 0)
+	{
+		printf(" ---> Creating offscreen images and image views.\n");
+		if (create_headless_images(base, device, swapchain) != 0)
+		{
+			return -1;
+		}
+
+		printf("... Done.\n");
+		printf("----------------------------------------");
+		printf("----------------------------------------\n\n");
+
+		return 0;
+	}
+
 	printf(" ---> Creating swapchain.\n");
 	if (create_swapchain(base, device, swapchain, VK_NULL_HANDLE) != 0)
 	{
@@ -43,6 +59,18 @@ void destroy_vulkan_swapchain(FracRenderVulkanDevice *device, FracRenderVulkanSw
 		free(swapchain->swapchain_image_views);
 	}
 
+	// Destroy offscreen images and free their memory:
+	if (swapchain->headless_memory)
+	{
+		for (uint32_t i = 0; i < swapchain->num_swapchain_images; i++)
+		{
+			vkDestroyImage(device->logical_device,
+				swapchain->swapchain_images[i], NULL);
+			vkFreeMemory(device->logical_device, swapchain->headless_memory[i], NULL);
+		}
+		free(swapchain->headless_memory);
+	}
+
 	// Free memory for swapchain images if necessary:
 	if (swapchain->swapchain_images)
 	{
@@ -338,6 +366,13 @@ int create_swapchain_images(FracRenderVulkanDevice *device, FracRenderVulkanSwap
 		return -1;
 	}
 
+	return create_swapchain_image_views(device, swapchain);
+}
+
+// Create an image view for each swapchain image:
+int create_swapchain_image_views(FracRenderVulkanDevice *device,
+				FracRenderVulkanSwapchain *swapchain)
+{
 	// For each swapchain image, create an image view. Free is in destroy_vulkan_swapchain:
 	swapchain->swapchain_image_views = malloc(swapchain->num_swapchain_images *
 								sizeof(VkImageView));
@@ -379,3 +414,123 @@ int create_swapchain_images(FracRenderVulkanDevice *device, FracRenderVulkanSwap
 
 	return 0;
 }
+
+// Create offscreen images and image views in place of the swapchain's:
+int create_headless_images(FracRenderVulkanBase *base, FracRenderVulkanDevice *device,
+							FracRenderVulkanSwapchain *swapchain)
+{
+	// Check the size is within the device's limits:
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device->physical_device, &properties);
+	if ((base->headless_extent.width > properties.limits.maxImageDimension2D) ||
+		(base->headless_extent.height > properties.limits.maxImageDimension2D))
+	{
+		fprintf(stderr, "Error: Offscreen images can be at most %ux%u!\n",
+			properties.limits.maxImageDimension2D,
+			properties.limits.maxImageDimension2D);
+		return -1;
+	}
+
+	// Same format a window would ideally get, and copyable for frame dumps:
+	swapchain->headless		= 1;
+	swapchain->num_swapchain_images	= FRACRENDER_HEADLESS_IMAGES;
+	swapchain->swapchain_format	= VK_FORMAT_R8G8B8A8_SRGB;
+	swapchain->swapchain_extent	= base->headless_extent;
+
+	// Allocate memory for images (free in destroy_vulkan_swapchain):
+	swapchain->swapchain_images = malloc(swapchain->num_swapchain_images * sizeof(VkImage));
+	swapchain->headless_memory = malloc(swapchain->num_swapchain_images *
+								sizeof(VkDeviceMemory));
+	for (uint32_t i = 0; i < swapchain->num_swapchain_images; i++)
+	{
+		swapchain->swapchain_images[i] = VK_NULL_HANDLE;
+		swapchain->headless_memory[i] = VK_NULL_HANDLE;
+	}
+
+	for (uint32_t i = 0; i < swapchain->num_swapchain_images; i++)
+	{
+		// Define image creation info:
+		VkImageCreateInfo image_info;
+		memset(&image_info, 0, sizeof(VkImageCreateInfo));
+		image_info.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		image_info.pNext			= NULL;
+		image_info.flags			= 0;
+		image_info.imageType			= VK_IMAGE_TYPE_2D;
+		image_info.format			= swapchain->swapchain_format;
+		image_info.extent.width			= swapchain->swapchain_extent.width;
+		image_info.extent.height		= swapchain->swapchain_extent.height;
+		image_info.extent.depth			= 1;
+		image_info.mipLevels			= 1;
+		image_info.arrayLayers			= 1;
+		image_info.samples			= VK_SAMPLE_COUNT_1_BIT;
+		image_info.tiling			= VK_IMAGE_TILING_OPTIMAL;
+		image_info.usage			= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+							VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		image_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
+		image_info.queueFamilyIndexCount	= 0;
+		image_info.pQueueFamilyIndices		= NULL;
+		image_info.initialLayout		= VK_IMAGE_LAYOUT_UNDEFINED;
+
+		// Create image:
+		if (vkCreateImage(device->logical_device, &image_info, NULL,
+			&swapchain->swapchain_images[i]) != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to create offscreen image %d!\n", i);
+			return -1;
+		}
+
+		// Get memory requirements of image:
+		VkMemoryRequirements memory_requirements;
+		vkGetImageMemoryRequirements(device->logical_device,
+			swapchain->swapchain_images[i], &memory_requirements);
+
+		VkMemoryAllocateInfo allocate_info;
+		memset(&allocate_info, 0, sizeof(VkMemoryAllocateInfo));
+		allocate_info.sType		= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocate_info.pNext		= NULL;
+		allocate_info.allocationSize	= memory_requirements.size;
+
+		// Find suitable memory type for image:
+		VkPhysicalDeviceMemoryProperties memory_properties;
+		vkGetPhysicalDeviceMemoryProperties(device->physical_device, &memory_properties);
+
+		VkMemoryPropertyFlags required_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		int success_flag = -1;
+		for (uint32_t j = 0; j < memory_properties.memoryTypeCount; j++)
+		{
+			if ((memory_requirements.memoryTypeBits & (1 << j)) &&
+				((memory_properties.memoryTypes[j].propertyFlags &
+				required_properties) == required_properties))
+			{
+				allocate_info.memoryTypeIndex = j;
+				success_flag = 0;
+				break;
+			}
+		}
+		if (success_flag != 0)
+		{
+			fprintf(stderr, "Error: No suitable memory type found for offscreen "
+									"image %d!\n", i);
+			return -1;
+		}
+
+		// Allocate memory for image:
+		if (vkAllocateMemory(device->logical_device, &allocate_info, NULL,
+			&swapchain->headless_memory[i]) != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to allocate memory for offscreen "
+									"image %d!\n", i);
+			return -1;
+		}
+
+		// Bind image memory:
+		vkBindImageMemory(device->logical_device, swapchain->swapchain_images[i],
+						swapchain->headless_memory[i], 0);
+	}
+
+	printf("      - Images: %u of %ux%u.\n", swapchain->num_swapchain_images,
+		swapchain->swapchain_extent.width, swapchain->swapchain_extent.height);
+
+	// Image views are made the same way as for a swapchain's images:
+	return create_swapchain_image_views(device, swapchain);
+}
@@ -14,6 +14,16 @@
 #include "../../Third-Party/volk/include/volk/volk.h"
 #include "01-Vulkan-Structs.h"
 
+/*
+ * Without a window (headless), there is no surface to make a swapchain for. Offscreen images of
+ * the size asked for are made instead, and stored in the same places as the swapchain's images,
+ * so the render passes, framebuffers and commands work the same. Nothing is acquired or
+ * presented: frames use the images in turn.
+ */
+
+// Offscreen images used in turn without a window:
+#define FRACRENDER_HEADLESS_IMAGES 2
+
 /***********************
  * Function Prototypes *
 ************************/
@@ -36,4 +46,12 @@ int create_swapchain(FracRenderVulkanBase *base, FracRenderVulkanDevice *device,
 // Create swapchain images and image views:
 int create_swapchain_images(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain);
 
+// Create an image view for each swapchain image:
+int create_swapchain_image_views(FracRenderVulkanDevice *device,
+				FracRenderVulkanSwapchain *swapchain);
+
+// Create offscreen images and image views in place of the swapchain's:
+int create_headless_images(FracRenderVulkanBase *base, FracRenderVulkanDevice *device,
+							FracRenderVulkanSwapchain *swapchain);
+
 #endif
@@ -17,13 +17,13 @@ int initialize_vulkan_descriptor_layouts(FracRenderVulkanDevice *device,
 
 	// Create sampler:
 	printf(" ---> Creating sampler.\n");
-	if (create_sampler(device, descriptors) != 0)
+	if (create_sampler(device, VK_SAMPLER_ADDRESS_MODE_REPEAT, &descriptors->sampler) != 0)
 	{
 		return -1;
 	}
 
 	// Create scene buffer:
-	printf(" ---> Creating scene buffer.\n");
+	printf(" ---> Creating scene buffer (%u slices).\n", descriptors->num_scene_slices);
 	if (create_scene_buffer(device, descriptors) != 0)
 	{
 		return -1;
@@ -139,6 +139,10 @@ void destroy_vulkan_descriptors(FracRenderVulkanDevice *device,
 	}
 
 	// Destroy scene uniform buffer:
+	if (descriptors->scene_data)
+	{
+		vkUnmapMemory(device->logical_device, descriptors->scene_memory);
+	}
 	if (descriptors->scene_buffer != VK_NULL_HANDLE)
 	{
 		vkDestroyBuffer(device->logical_device, descriptors->scene_buffer, NULL);
@@ -168,11 +172,23 @@ void destroy_vulkan_descriptors(FracRenderVulkanDevice *device,
 			descriptors->sdf_3d_descriptor_layout, NULL);
 	}
 
-	// Destroy 3D SDF buffer and associated device memory:
+	// Destroy 3D SDF buffer or image and associated device memory:
 	if (descriptors->sdf_3d_buffer != VK_NULL_HANDLE)
 	{
 		vkDestroyBuffer(device->logical_device, descriptors->sdf_3d_buffer, NULL);
 	}
+	if (descriptors->sdf_3d_image_view != VK_NULL_HANDLE)
+	{
+		vkDestroyImageView(device->logical_device, descriptors->sdf_3d_image_view, NULL);
+	}
+	if (descriptors->sdf_3d_image != VK_NULL_HANDLE)
+	{
+		vkDestroyImage(device->logical_device, descriptors->sdf_3d_image, NULL);
+	}
+	if (descriptors->sdf_3d_sampler != VK_NULL_HANDLE)
+	{
+		vkDestroySampler(device->logical_device, descriptors->sdf_3d_sampler, NULL);
+	}
 	if (descriptors->sdf_3d_memory != VK_NULL_HANDLE)
 	{
 		vkFreeMemory(device->logical_device, descriptors->sdf_3d_memory, NULL);
@@ -204,12 +220,18 @@ int create_descriptor_pool(FracRenderVulkanDevice *device,
 			FracRenderVulkanDescriptors *descriptors)
 {
 	// Define the descriptor pool types:
-	VkDescriptorPoolSize pools[2];
-	memset(pools, 0, 2 * sizeof(VkDescriptorPoolSize));
+	VkDescriptorPoolSize pools[5];
+	memset(pools, 0, 5 * sizeof(VkDescriptorPoolSize));
 	pools[0].type			= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	pools[0].descriptorCount	= 2048;
 	pools[1].type			= VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	pools[1].descriptorCount	= 2048;
+	pools[2].type			= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pools[2].descriptorCount	= 2048;
+	pools[3].type			= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	pools[3].descriptorCount	= 8;
+	pools[4].type			= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	pools[4].descriptorCount	= 8;
 
 	// Define the descriptor pool creation info:
 	VkDescriptorPoolCreateInfo pool_info;
@@ -218,7 +240,7 @@ int create_descriptor_pool(FracRenderVulkanDevice *device,
 	pool_info.pNext		= NULL;
 	pool_info.flags		= 0;
 	pool_info.maxSets	= 1024;
-	pool_info.poolSizeCount	= 2;
+	pool_info.poolSizeCount	= 5;
 	pool_info.pPoolSizes	= pools;
 
 	// Create the descriptor pool:
@@ -233,7 +255,8 @@ int create_descriptor_pool(FracRenderVulkanDevice *device,
 }
 
 // Create sampler:
-int create_sampler(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors)
+int create_sampler(FracRenderVulkanDevice *device, VkSamplerAddressMode address_mode,
+							VkSampler *sampler)
 {
 	// Define sampler creation info:
 	VkSamplerCreateInfo sampler_info;
@@ -244,9 +267,9 @@ int create_sampler(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *
 	sampler_info.magFilter			= VK_FILTER_LINEAR;
 	sampler_info.minFilter			= VK_FILTER_LINEAR;
 	sampler_info.mipmapMode			= VK_SAMPLER_MIPMAP_MODE_LINEAR;
-	sampler_info.addressModeU		= VK_SAMPLER_ADDRESS_MODE_REPEAT;
-	sampler_info.addressModeV		= VK_SAMPLER_ADDRESS_MODE_REPEAT;
-	sampler_info.addressModeW		= VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	sampler_info.addressModeU		= address_mode;
+	sampler_info.addressModeV		= address_mode;
+	sampler_info.addressModeW		= address_mode;
 	sampler_info.mipLodBias			= 0.f;
 	sampler_info.anisotropyEnable		= VK_FALSE;
 	sampler_info.maxAnisotropy		= 0.f;
@@ -258,8 +281,7 @@ int create_sampler(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *
 	sampler_info.unnormalizedCoordinates	= VK_FALSE;
 
 	// Create the sampler:
-	if (vkCreateSampler(device->logical_device, &sampler_info, NULL,
-				&descriptors->sampler) != VK_SUCCESS)
+	if (vkCreateSampler(device->logical_device, &sampler_info, NULL, sampler) != VK_SUCCESS)
 	{
 		fprintf(stderr, "Error, Unable to create the sampler!\n");
 		return -1;
@@ -268,19 +290,27 @@ int create_sampler(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *
 	return 0;
 }
 
-// Create scene buffer:
+// Create scene buffer (one slice per frame slot), and map it:
 int create_scene_buffer(FracRenderVulkanDevice *device,
 			FracRenderVulkanDescriptors *descriptors)
 {
+	// Slices start at multiples of the device's dynamic uniform offset alignment:
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device->physical_device, &properties);
+	VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+	if (alignment == 0) { alignment = 1; }
+	descriptors->scene_slice_size = ((sizeof(FracRenderVulkanSceneUniform) + alignment - 1) /
+								alignment) * alignment;
+
 	// Define buffer creation info:
 	VkBufferCreateInfo buffer_info;
 	memset(&buffer_info, 0, sizeof(VkBufferCreateInfo));
 	buffer_info.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	buffer_info.pNext			= NULL;
 	buffer_info.flags			= 0;
-	buffer_info.size			= sizeof(FracRenderVulkanSceneUniform);
-	buffer_info.usage			= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
-						VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	buffer_info.size			= descriptors->num_scene_slices *
+						descriptors->scene_slice_size;
+	buffer_info.usage			= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 	buffer_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
 	buffer_info.queueFamilyIndexCount	= 0;
 	buffer_info.pQueueFamilyIndices		= NULL;
@@ -341,6 +371,15 @@ int create_scene_buffer(FracRenderVulkanDevice *device,
 	vkBindBufferMemory(device->logical_device, descriptors->scene_buffer,
 						descriptors->scene_memory, 0);
 
+	// Map the memory once. It is host-coherent, so frames written into it need no flush:
+	if (vkMapMemory(device->logical_device, descriptors->scene_memory, 0, VK_WHOLE_SIZE,
+				0, &descriptors->scene_data) != VK_SUCCESS)
+	{
+		descriptors->scene_data = NULL;
+		fprintf(stderr, "Error: Unable to map scene buffer!\n");
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -352,10 +391,11 @@ int create_scene_descriptor_layout(FracRenderVulkanDevice *device,
 	VkDescriptorSetLayoutBinding bindings[1];
 	memset(bindings, 0, 1 * sizeof(VkDescriptorSetLayoutBinding));
 	bindings[0].binding		= 0;
-	bindings[0].descriptorType	= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	bindings[0].descriptorType	= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	bindings[0].descriptorCount	= 1;
 	bindings[0].stageFlags		= VK_SHADER_STAGE_VERTEX_BIT |
-					VK_SHADER_STAGE_FRAGMENT_BIT;
+					VK_SHADER_STAGE_FRAGMENT_BIT |
+					VK_SHADER_STAGE_COMPUTE_BIT;
 	bindings[0].pImmutableSamplers	= NULL;
 
 	// Create descriptor set layout:
@@ -397,12 +437,12 @@ int create_scene_descriptor(FracRenderVulkanDevice *device,
 		return -1;
 	}
 
-	// Create descriptor set:
+	// Create descriptor set (covering one slice, moved along by the dynamic offset):
 	VkDescriptorBufferInfo scene_UBO_info;
 	memset(&scene_UBO_info, 0, sizeof(VkDescriptorBufferInfo));
 	scene_UBO_info.buffer	= descriptors->scene_buffer;
 	scene_UBO_info.offset	= 0;
-	scene_UBO_info.range	= VK_WHOLE_SIZE;
+	scene_UBO_info.range	= sizeof(FracRenderVulkanSceneUniform);
 
 	VkWriteDescriptorSet descriptor_write[1];
 	memset(descriptor_write, 0, 1 * sizeof(VkWriteDescriptorSet));
@@ -412,7 +452,7 @@ int create_scene_descriptor(FracRenderVulkanDevice *device,
 	descriptor_write[0].dstBinding		= 0;
 	descriptor_write[0].dstArrayElement	= 0;
 	descriptor_write[0].descriptorCount	= 1;
-	descriptor_write[0].descriptorType	= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descriptor_write[0].descriptorType	= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	descriptor_write[0].pImageInfo		= NULL;
 	descriptor_write[0].pBufferInfo		= &scene_UBO_info;
 	descriptor_write[0].pTexelBufferView	= NULL;
@@ -554,8 +594,11 @@ void update_vulkan_g_buffer_descriptors(FracRenderVulkanDevice *device,
 int create_sdf_3d_buffer(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
 									FracRenderSDF3D *sdf_3d)
 {
+	// Dense SDF can be stored in a 3D texture instead, for hardware trilinear filtering:
+	if (sdf_3d->texture == 1) { return create_sdf_3d_image(device, descriptors, sdf_3d); }
+
 	// Define buffer creation info:
-	size_t sdf_memory = sdf_3d->num_voxels * sizeof(float);
+	size_t sdf_memory = get_sdf_3d_data_size(sdf_3d);
 	VkBufferCreateInfo buffer_info;
 	memset(&buffer_info, 0, sizeof(VkBufferCreateInfo));
 	buffer_info.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -589,11 +632,205 @@ int create_sdf_3d_buffer(FracRenderVulkanDevice *device, FracRenderVulkanDescrip
 	allocate_info.allocationSize	= memory_requirements.size;
 
 	printf("      - Memory needed: %lu bytes.\n", memory_requirements.size);
+	if (sdf_3d->predicted_memory > 0)
+	{
+		printf("      - Memory predicted: %lu bytes.\n", sdf_3d->predicted_memory);
+	}
 
 	// Find suitable memory type for buffer:
 	VkPhysicalDeviceMemoryProperties memory_properties;
 	vkGetPhysicalDeviceMemoryProperties(device->physical_device, &memory_properties);
 
+	// Voxels still to be calculated on the CPU can be written straight into device-local
+	// memory, if the host can see a big enough heap of it. Not when they have to be read back
+	// to save them in the cache, as reads from this memory are slow:
+	VkMemoryPropertyFlags mapped_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	if ((sdf_3d->deferred == 1) && (sdf_3d->bake == 0) && (sdf_3d->cache == 0))
+	{
+		for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+		{
+			VkMemoryType *type = &memory_properties.memoryTypes[i];
+			if ((memory_requirements.memoryTypeBits & (1 << i)) &&
+				((type->propertyFlags & mapped_properties) == mapped_properties) &&
+				(memory_properties.memoryHeaps[type->heapIndex].size >=
+							memory_requirements.size))
+			{
+				allocate_info.memoryTypeIndex = i;
+				if (vkAllocateMemory(device->logical_device, &allocate_info, NULL,
+					&descriptors->sdf_3d_memory) == VK_SUCCESS)
+				{
+					descriptors->sdf_3d_memory_mapped = 1;
+					printf("      - Host-visible (written directly).\n");
+				}
+				break;
+			}
+		}
+	}
+
+	if (descriptors->sdf_3d_memory_mapped == 0)
+	{
+		VkMemoryPropertyFlags required_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		int success_flag = -1;
+		for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+		{
+			if ((memory_requirements.memoryTypeBits & (1 << i)) &&
+				((memory_properties.memoryTypes[i].propertyFlags &
+				required_properties) == required_properties))
+			{
+				allocate_info.memoryTypeIndex = i;
+				success_flag = 0;
+				break;
+			}
+		}
+		if (success_flag != 0)
+		{
+			fprintf(stderr, "Error: No suitable memory type found for "
+							"3D SDF buffer!\n");
+			return -1;
+		}
+
+		// Allocate memory for buffer:
+		if (vkAllocateMemory(device->logical_device, &allocate_info, NULL,
+					&descriptors->sdf_3d_memory) != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to allocate memory for 3D SDF buffer!\n");
+			return -1;
+		}
+	}
+
+	// Bind buffer memory:
+	vkBindBufferMemory(device->logical_device, descriptors->sdf_3d_buffer,
+						descriptors->sdf_3d_memory, 0);
+
+	return 0;
+}
+
+// Get the most memory the 3D SDF can use on the device, in bytes. A quarter of the biggest
+// device-local heap is left for everything else, and a storage buffer can only cover so much:
+size_t get_vulkan_sdf_3d_memory_limit(FracRenderVulkanDevice *device, int texture)
+{
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	vkGetPhysicalDeviceMemoryProperties(device->physical_device, &memory_properties);
+
+	VkDeviceSize heap_size = 0;
+	for (uint32_t i = 0; i < memory_properties.memoryHeapCount; i++)
+	{
+		if ((memory_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+			(memory_properties.memoryHeaps[i].size > heap_size))
+		{
+			heap_size = memory_properties.memoryHeaps[i].size;
+		}
+	}
+
+	size_t memory_limit = (heap_size / 4) * 3;
+	if (texture == 0)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device->physical_device, &properties);
+		if (properties.limits.maxStorageBufferRange < memory_limit)
+		{
+			memory_limit = properties.limits.maxStorageBufferRange;
+		}
+	}
+
+	return memory_limit;
+}
+
+// Create 3D texture for dense 3D SDF:
+int create_sdf_3d_image(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
+									FracRenderSDF3D *sdf_3d)
+{
+	uint32_t resolution = 1u << sdf_3d->levels;
+
+	// Check the resolution is supported:
+	VkPhysicalDeviceProperties physical_device_properties;
+	vkGetPhysicalDeviceProperties(device->physical_device, &physical_device_properties);
+	if (resolution > physical_device_properties.limits.maxImageDimension3D)
+	{
+		fprintf(stderr, "Error: 3D SDF texture resolution (%u) is more than the device "
+			"limit (%u)!\n", resolution,
+			physical_device_properties.limits.maxImageDimension3D);
+		return -1;
+	}
+
+	// Match the storage format. 32-bit floats fall back to 16-bit if they can't be filtered:
+	VkFormatProperties format_properties;
+	vkGetPhysicalDeviceFormatProperties(device->physical_device, VK_FORMAT_R32_SFLOAT,
+								&format_properties);
+	if (sdf_3d->format == 1)
+	{
+		descriptors->sdf_3d_image_format = VK_FORMAT_R16_SFLOAT;
+		printf("      - Format: R16_SFLOAT.\n");
+	}
+	else if (sdf_3d->format == 2)
+	{
+		descriptors->sdf_3d_image_format = VK_FORMAT_R8_UNORM;
+		printf("      - Format: R8_UNORM.\n");
+	}
+	else if (format_properties.optimalTilingFeatures &
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)
+	{
+		descriptors->sdf_3d_image_format = VK_FORMAT_R32_SFLOAT;
+		printf("      - Format: R32_SFLOAT.\n");
+	}
+	else
+	{
+		descriptors->sdf_3d_image_format = VK_FORMAT_R16_SFLOAT;
+		printf("      - Format: R16_SFLOAT (R32_SFLOAT can't be filtered).\n");
+	}
+
+	// Define image creation info:
+	VkImageCreateInfo image_info;
+	memset(&image_info, 0, sizeof(VkImageCreateInfo));
+	image_info.sType			= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	image_info.pNext			= NULL;
+	image_info.flags			= 0;
+	image_info.imageType			= VK_IMAGE_TYPE_3D;
+	image_info.format			= descriptors->sdf_3d_image_format;
+	image_info.extent.width			= resolution;
+	image_info.extent.height		= resolution;
+	image_info.extent.depth			= resolution;
+	image_info.mipLevels			= 1;
+	image_info.arrayLayers			= 1;
+	image_info.samples			= VK_SAMPLE_COUNT_1_BIT;
+	image_info.tiling			= VK_IMAGE_TILING_OPTIMAL;
+	image_info.usage			= VK_IMAGE_USAGE_SAMPLED_BIT |
+						VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	image_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
+	image_info.queueFamilyIndexCount	= 0;
+	image_info.pQueueFamilyIndices		= NULL;
+
+	// Create image:
+	if (vkCreateImage(device->logical_device, &image_info, NULL,
+			&descriptors->sdf_3d_image) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create 3D SDF image!\n");
+		return -1;
+	}
+
+	// Get memory requirements of image:
+	VkMemoryRequirements memory_requirements;
+	vkGetImageMemoryRequirements(device->logical_device,
+		descriptors->sdf_3d_image, &memory_requirements);
+
+	// Get memory allocation info:
+	VkMemoryAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkMemoryAllocateInfo));
+	allocate_info.sType		= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate_info.pNext		= NULL;
+	allocate_info.allocationSize	= memory_requirements.size;
+
+	printf("      - Memory needed: %lu bytes.\n", memory_requirements.size);
+	if (sdf_3d->predicted_memory > 0)
+	{
+		printf("      - Memory predicted: %lu bytes.\n", sdf_3d->predicted_memory);
+	}
+
+	// Find suitable memory type for image:
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	vkGetPhysicalDeviceMemoryProperties(device->physical_device, &memory_properties);
+
 	VkMemoryPropertyFlags required_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 	int success_flag = -1;
 	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
@@ -609,21 +846,58 @@ int create_sdf_3d_buffer(FracRenderVulkanDevice *device, FracRenderVulkanDescrip
 	}
 	if (success_flag != 0)
 	{
-		fprintf(stderr, "Error: No suitable memory type found for 3D SDF buffer!\n");
+		fprintf(stderr, "Error: No suitable memory type found for 3D SDF image!\n");
 		return -1;
 	}
 
-	// Allocate memory for buffer:
+	// Allocate memory for image:
 	if (vkAllocateMemory(device->logical_device, &allocate_info, NULL,
 				&descriptors->sdf_3d_memory) != VK_SUCCESS)
 	{
-		fprintf(stderr, "Error: Unable to allocate memory for 3D SDF buffer!\n");
+		fprintf(stderr, "Error: Unable to allocate memory for 3D SDF image!\n");
 		return -1;
 	}
 
-	// Bind buffer memory:
-	vkBindBufferMemory(device->logical_device, descriptors->sdf_3d_buffer,
-						descriptors->sdf_3d_memory, 0);
+	// Bind image memory:
+	vkBindImageMemory(device->logical_device, descriptors->sdf_3d_image,
+					descriptors->sdf_3d_memory, 0);
+
+	// Define image view creation info:
+	VkImageViewCreateInfo view_info;
+	memset(&view_info, 0, sizeof(VkImageViewCreateInfo));
+	view_info.sType			= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	view_info.pNext			= NULL;
+	view_info.flags			= 0;
+	view_info.image			= descriptors->sdf_3d_image;
+	view_info.viewType		= VK_IMAGE_VIEW_TYPE_3D;
+	view_info.format		= descriptors->sdf_3d_image_format;
+
+	view_info.components.r	= VK_COMPONENT_SWIZZLE_IDENTITY;
+	view_info.components.g	= VK_COMPONENT_SWIZZLE_IDENTITY;
+	view_info.components.b	= VK_COMPONENT_SWIZZLE_IDENTITY;
+	view_info.components.a	= VK_COMPONENT_SWIZZLE_IDENTITY;
+
+	view_info.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	view_info.subresourceRange.baseMipLevel		= 0;
+	view_info.subresourceRange.levelCount		= 1;
+	view_info.subresourceRange.baseArrayLayer	= 0;
+	view_info.subresourceRange.layerCount		= 1;
+
+	// Create image view:
+	if (vkCreateImageView(device->logical_device, &view_info, NULL,
+		&descriptors->sdf_3d_image_view) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create image view for 3D SDF image!\n");
+		return -1;
+	}
+
+	// Its own sampler, clamping to the edge so lookups near a face never wrap around to the
+	// opposite one:
+	if (create_sampler(device, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+				&descriptors->sdf_3d_sampler) != 0)
+	{
+		return -1;
+	}
 
 	return 0;
 }
@@ -638,9 +912,15 @@ int create_sdf_3d_descriptor_layout(FracRenderVulkanDevice *device,
 	bindings[0].binding		= 0;
 	bindings[0].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	bindings[0].descriptorCount	= 1;
-	bindings[0].stageFlags		= VK_SHADER_STAGE_FRAGMENT_BIT;
+	bindings[0].stageFlags		= VK_SHADER_STAGE_FRAGMENT_BIT |
+					VK_SHADER_STAGE_COMPUTE_BIT;
 	bindings[0].pImmutableSamplers	= NULL;
 
+	if (descriptors->sdf_3d_image != VK_NULL_HANDLE)
+	{
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	}
+
 	// Create descriptor set layout:
 	VkDescriptorSetLayoutCreateInfo layout_info;
 	memset(&layout_info, 0, sizeof(VkDescriptorSetLayoutCreateInfo));
@@ -700,6 +980,20 @@ int create_sdf_3d_descriptor(FracRenderVulkanDevice *device,
 	descriptor_write[0].pBufferInfo		= &sdf_buffer_info;
 	descriptor_write[0].pTexelBufferView	= NULL;
 
+	// Or the 3D texture, read through its own sampler:
+	VkDescriptorImageInfo sdf_image_info;
+	memset(&sdf_image_info, 0, sizeof(VkDescriptorImageInfo));
+	if (descriptors->sdf_3d_image != VK_NULL_HANDLE)
+	{
+		sdf_image_info.sampler		= descriptors->sdf_3d_sampler;
+		sdf_image_info.imageView	= descriptors->sdf_3d_image_view;
+		sdf_image_info.imageLayout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		descriptor_write[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptor_write[0].pImageInfo		= &sdf_image_info;
+		descriptor_write[0].pBufferInfo		= NULL;
+	}
+
 	// Update descriptor sets:
 	vkUpdateDescriptorSets(device->logical_device, 1, descriptor_write, 0, NULL);
 
@@ -714,8 +1008,21 @@ int copy_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors
 	printf("----------------------------------------\n");
 	printf("Copying 3D SDF data into GPU buffer...\n");
 
+	// Voxels still to be calculated go straight into the buffer, if the host can see it:
+	if ((sdf_3d->deferred == 1) && (descriptors->sdf_3d_memory_mapped == 1))
+	{
+		return create_sdf_3d_in_place(device, descriptors, sdf_3d);
+	}
+
 	// Create staging buffer. First define buffer creation info:
-	size_t sdf_size = sdf_3d->num_voxels * sizeof(float);
+	size_t sdf_size = get_sdf_3d_data_size(sdf_3d);
+	int grid_format = sdf_3d->format;
+	if (descriptors->sdf_3d_image_format == VK_FORMAT_R16_SFLOAT) { grid_format = 1; }
+	if (descriptors->sdf_3d_image != VK_NULL_HANDLE)
+	{
+		sdf_size = (size_t)sdf_3d->num_voxels * get_sdf_3d_format_size(grid_format);
+	}
+
 	VkBufferCreateInfo staging_buffer_info;
 	memset(&staging_buffer_info, 0, sizeof(VkBufferCreateInfo));
 	staging_buffer_info.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -727,10 +1034,16 @@ int copy_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors
 	staging_buffer_info.queueFamilyIndexCount	= 0;
 	staging_buffer_info.pQueueFamilyIndices		= NULL;
 
+	// Temporary objects, destroyed by destroy_sdf_3d_copy_objects:
+	FracRenderVulkanSDF3DCopy copy;
+	memset(&copy, 0, sizeof(FracRenderVulkanSDF3DCopy));
+	copy.staging_buffer	= VK_NULL_HANDLE;
+	copy.staging_memory	= VK_NULL_HANDLE;
+	copy.fence		= VK_NULL_HANDLE;
+
 	// Create buffer:
-	VkBuffer staging_buffer = VK_NULL_HANDLE;
 	if (vkCreateBuffer(device->logical_device, &staging_buffer_info, NULL,
-						&staging_buffer) != VK_SUCCESS)
+					&copy.staging_buffer) != VK_SUCCESS)
 	{
 		fprintf(stderr, "Error: Unable to create staging buffer for 3D SDF copying!\n");
 		return -1;
@@ -739,7 +1052,7 @@ int copy_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors
 	// Get buffer memory requirements:
 	VkMemoryRequirements staging_memory_requirements;
 	vkGetBufferMemoryRequirements(device->logical_device,
-		staging_buffer, &staging_memory_requirements);
+		copy.staging_buffer, &staging_memory_requirements);
 
 	// Get memory allocation info:
 	VkMemoryAllocateInfo staging_allocate_info;
@@ -748,28 +1061,40 @@ int copy_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors
 	staging_allocate_info.pNext		= NULL;
 	staging_allocate_info.allocationSize	= staging_memory_requirements.size;
 
-	// Find suitable memory type for buffer:
+	// Find suitable memory type for buffer. Voxels calculated here are read back to save them
+	// in the cache, so cached memory is preferred for them:
 	VkPhysicalDeviceMemoryProperties staging_memory_properties;
 	vkGetPhysicalDeviceMemoryProperties(device->physical_device, &staging_memory_properties);
 
 	VkMemoryPropertyFlags required_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
 						VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	VkMemoryPropertyFlags preferred_properties = required_properties;
+	if (sdf_3d->deferred == 1)
+	{
+		preferred_properties |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+	}
+
 	int success_flag = -1;
-	for (uint32_t i = 0; i < staging_memory_properties.memoryTypeCount; i++)
+	for (int pass = 0; (pass < 2) && (success_flag != 0); pass++)
 	{
-		if ((staging_memory_requirements.memoryTypeBits & (1 << i)) &&
-			((staging_memory_properties.memoryTypes[i].propertyFlags &
-			required_properties) == required_properties))
+		VkMemoryPropertyFlags properties = preferred_properties;
+		if (pass == 1) { properties = required_properties; }
+
+		for (uint32_t i = 0; i < staging_memory_properties.memoryTypeCount; i++)
 		{
-			staging_allocate_info.memoryTypeIndex = i;
-			success_flag = 0;
-			break;
+			if ((staging_memory_requirements.memoryTypeBits & (1 << i)) &&
+				((staging_memory_properties.memoryTypes[i].propertyFlags &
+				properties) == properties))
+			{
+				staging_allocate_info.memoryTypeIndex = i;
+				success_flag = 0;
+				break;
+			}
 		}
 	}
 	if (success_flag != 0)
 	{
-		// Destroy temporary objects:
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
+		destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
 
 		fprintf(stderr, "Error: No suitable memory type found for staging "
 						"buffer for 3D SDF copying!\n");
@@ -777,12 +1102,10 @@ int copy_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors
 	}
 
 	// Allocate memory for buffer:
-	VkDeviceMemory staging_memory = VK_NULL_HANDLE;
 	if (vkAllocateMemory(device->logical_device, &staging_allocate_info, NULL,
-						&staging_memory) != VK_SUCCESS)
+					&copy.staging_memory) != VK_SUCCESS)
 	{
-		// Destroy temporary objects:
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
+		destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
 
 		fprintf(stderr, "Error: Unable to allocate memory for staging "
 						"buffer for 3D SDF copying!\n");
@@ -790,108 +1113,221 @@ int copy_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors
 	}
 
 	// Bind buffer memory:
-	vkBindBufferMemory(device->logical_device, staging_buffer, staging_memory, 0);
+	vkBindBufferMemory(device->logical_device, copy.staging_buffer, copy.staging_memory, 0);
 
 	// Map staging buffer memory:
 	void *staging_ptr;
-	if (vkMapMemory(device->logical_device, staging_memory, 0,
+	if (vkMapMemory(device->logical_device, copy.staging_memory, 0,
 		VK_WHOLE_SIZE, 0, &staging_ptr) != VK_SUCCESS)
 	{
-		// Destroy temporary objects:
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
-		vkFreeMemory(device->logical_device, staging_memory, NULL);
+		destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
 
 		fprintf(stderr, "Error: Unable to map memory for 3D SDF copying!\n");
 		return -1;
 	}
 
-	// Copy data into staging buffer:
-	memcpy(staging_ptr, sdf_3d->voxels, sdf_size);
+	// Voxels still to be calculated are written into the staging buffer, and copied over in
+	// chunks while the rest are calculated. Otherwise copy them in, in one go:
+	FracRenderSDF3DBuild build;
+	if (sdf_3d->deferred == 1)
+	{
+		printf(" ---> Calculating into the staging buffer.\n");
+		sdf_3d->voxels = staging_ptr;
+		if (begin_sdf_3d_build(sdf_3d, &build) != 0)
+		{
+			destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
+			return -1;
+		}
+
+		copy.num_chunks = FRACRENDER_SDF_3D_COPY_CHUNKS;
+		if (copy.num_chunks > build.num_tasks) { copy.num_chunks = build.num_tasks; }
+	}
+	else
+	{
+		// The 3D texture needs the voxels in grid order:
+		if (descriptors->sdf_3d_image != VK_NULL_HANDLE)
+		{
+			write_sdf_3d_grid(sdf_3d, staging_ptr, grid_format);
+		}
+		else { memcpy(staging_ptr, get_sdf_3d_data(sdf_3d), sdf_size); }
 
-	// Allocate command buffer:
+		copy.num_chunks = 1;
+	}
+
+	// Allocate command buffers, one per chunk:
 	VkCommandBufferAllocateInfo allocate_info;
 	memset(&allocate_info, 0, sizeof(VkCommandBufferAllocateInfo));
 	allocate_info.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	allocate_info.pNext			= NULL;
 	allocate_info.commandPool		= commands->command_pool;
 	allocate_info.level			= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocate_info.commandBufferCount	= 1;
+	allocate_info.commandBufferCount	= copy.num_chunks;
 
-	VkCommandBuffer command_buffer = VK_NULL_HANDLE;
 	if (vkAllocateCommandBuffers(device->logical_device, &allocate_info,
-						&command_buffer) != VK_SUCCESS)
+					copy.command_buffers) != VK_SUCCESS)
 	{
-		// Destroy temporary objects:
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
-		vkFreeMemory(device->logical_device, staging_memory, NULL);
+		copy.num_chunks = 0;
+		destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
 
 		fprintf(stderr, "Error: Unable to allocate command buffer for 3D SDF copying!\n");
 		return -1;
 	}
 
+	// Create fence for submitting commands:
+	VkFenceCreateInfo fence_info;
+	memset(&fence_info, 0, sizeof(VkFenceCreateInfo));
+	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fence_info.pNext = NULL;
+	fence_info.flags = 0;
+
+	if (vkCreateFence(device->logical_device, &fence_info, NULL, &copy.fence) != VK_SUCCESS)
+	{
+		destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
+
+		fprintf(stderr, "Error: Unable to create fence for 3D SDF copying!\n");
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < copy.num_chunks; i++)
+	{
+		// Calculate this chunk's subtrees, if needed. Their voxels are one range of bytes:
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = sdf_size;
+		if (sdf_3d->deferred == 1)
+		{
+			uint32_t first_task = (i * build.num_tasks) / copy.num_chunks;
+			uint32_t end_task = ((i + 1) * build.num_tasks) / copy.num_chunks;
+			if (run_sdf_3d_build(&build, first_task, end_task - first_task) != 0)
+			{
+				vkQueueWaitIdle(device->graphics_queue);
+				destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
+				return -1;
+			}
+
+			VkDeviceSize task_size = (VkDeviceSize)build.voxels_per_task *
+					get_sdf_3d_format_size(sdf_3d->format);
+			offset = first_task * task_size;
+			size = (end_task - first_task) * task_size;
+
+			// Any shading after the voxels goes with the last chunk:
+			if (i == (copy.num_chunks - 1)) { size = sdf_size - offset; }
+		}
+
+		// Copy the chunk. The fence goes on the last one, which comes after all the others:
+		VkFence fence = VK_NULL_HANDLE;
+		if (i == (copy.num_chunks - 1)) { fence = copy.fence; }
+
+		if (submit_sdf_3d_copy(device, descriptors, sdf_3d, copy.staging_buffer,
+			copy.command_buffers[i], offset, size, fence) != 0)
+		{
+			vkQueueWaitIdle(device->graphics_queue);
+			destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
+			return -1;
+		}
+	}
+
+	// Wait for fence:
+	if (vkWaitForFences(device->logical_device, 1, &copy.fence,
+				VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+	{
+		destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
+
+		fprintf(stderr, "Error: Failed to wait for fence for 3D SDF copying!\n");
+		return -1;
+	}
+
+	// Save calculated voxels for next time, while they are still mapped:
+	if (sdf_3d->deferred == 1)
+	{
+		end_sdf_3d_build(&build);
+		printf("      - Chunks copied: %u.\n", copy.num_chunks);
+		if (sdf_3d->cache == 1) { save_sdf_3d_cache(sdf_3d); }
+	}
+
+	// Destroy temporary objects:
+	destroy_sdf_3d_copy_objects(device, commands, sdf_3d, &copy);
+
+	printf("... done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Calculate 3D SDF voxels straight into the mapped 3D SDF buffer:
+int create_sdf_3d_in_place(FracRenderVulkanDevice *device,
+		FracRenderVulkanDescriptors *descriptors, FracRenderSDF3D *sdf_3d)
+{
+	printf(" ---> Calculating straight into device memory.\n");
+
+	if (vkMapMemory(device->logical_device, descriptors->sdf_3d_memory, 0,
+		VK_WHOLE_SIZE, 0, &sdf_3d->voxels) != VK_SUCCESS)
+	{
+		sdf_3d->voxels = NULL;
+		fprintf(stderr, "Error: Unable to map memory of 3D SDF buffer!\n");
+		return -1;
+	}
+
+	FracRenderSDF3DBuild build;
+	int result = begin_sdf_3d_build(sdf_3d, &build);
+	if (result == 0) { result = run_sdf_3d_build(&build, 0, build.num_tasks); }
+	if (result == 0) { end_sdf_3d_build(&build); }
+
+	vkUnmapMemory(device->logical_device, descriptors->sdf_3d_memory);
+	sdf_3d->voxels = NULL;
+
+	if (result != 0) { return -1; }
+
+	printf("... done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Record and submit copy of part of the staging buffer into the 3D SDF buffer or image:
+int submit_sdf_3d_copy(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
+	FracRenderSDF3D *sdf_3d, VkBuffer staging_buffer, VkCommandBuffer command_buffer,
+			VkDeviceSize offset, VkDeviceSize size, VkFence fence)
+{
 	// Begin command recording:
 	VkCommandBufferBeginInfo begin_info;
 	memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
 	begin_info.sType		= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	begin_info.pNext		= NULL;
-	begin_info.flags		= 0;
+	begin_info.flags		= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	begin_info.pInheritanceInfo	= NULL;
 
 	if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
 	{
-		// Destroy temporary objects:
-		vkFreeCommandBuffers(device->logical_device,
-			commands->command_pool, 1, &command_buffer);
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
-		vkFreeMemory(device->logical_device, staging_memory, NULL);
-
 		fprintf(stderr, "Error: Unable to begin recording commands for 3D SDF copying!\n");
 		return -1;
 	}
 
-	// Copy data from staging buffer into GPU SDF buffer:
-	VkBufferCopy buffer_copy_info[1];
-	memset(buffer_copy_info, 0, 1 * sizeof(VkBufferCopy));
-	buffer_copy_info[0].srcOffset	= 0;
-	buffer_copy_info[0].dstOffset	= 0;
-	buffer_copy_info[0].size	= sdf_size;
-
-	vkCmdCopyBuffer(command_buffer, staging_buffer, descriptors->sdf_3d_buffer,
-								1, buffer_copy_info);
+	// Copy data from staging buffer into GPU SDF buffer or image:
+	if (descriptors->sdf_3d_image != VK_NULL_HANDLE)
+	{
+		record_sdf_3d_image_copy(descriptors, sdf_3d, staging_buffer, command_buffer);
+	}
+	else
+	{
+		VkBufferCopy buffer_copy_info[1];
+		memset(buffer_copy_info, 0, 1 * sizeof(VkBufferCopy));
+		buffer_copy_info[0].srcOffset	= offset;
+		buffer_copy_info[0].dstOffset	= offset;
+		buffer_copy_info[0].size	= size;
+
+		vkCmdCopyBuffer(command_buffer, staging_buffer, descriptors->sdf_3d_buffer,
+									1, buffer_copy_info);
+	}
 
 	// Finish command recording:
 	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
 	{
-		// Destroy temporary objects:
-		vkFreeCommandBuffers(device->logical_device,
-			commands->command_pool, 1, &command_buffer);
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
-		vkFreeMemory(device->logical_device, staging_memory, NULL);
-
 		fprintf(stderr, "Error: Unable to stop recording commands for 3D SDF copying!\n");
 		return -1;
 	}
 
-	// Create fence for submitting commands:
-	VkFenceCreateInfo fence_info;
-	memset(&fence_info, 0, sizeof(VkFenceCreateInfo));
-	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fence_info.pNext = NULL;
-	fence_info.flags = 0;
-
-	VkFence fence = VK_NULL_HANDLE;
-	if (vkCreateFence(device->logical_device, &fence_info, NULL, &fence) != VK_SUCCESS)
-	{
-		// Destroy temporary objects:
-		vkFreeCommandBuffers(device->logical_device,
-			commands->command_pool, 1, &command_buffer);
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
-		vkFreeMemory(device->logical_device, staging_memory, NULL);
-
-		fprintf(stderr, "Error: Unable to create fence for 3D SDF copying!\n");
-		return -1;
-	}
-
 	// Submit commands:
 	VkSubmitInfo submit_info;
 	memset(&submit_info, 0, sizeof(VkSubmitInfo));
@@ -907,42 +1343,113 @@ int copy_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors
 
 	if (vkQueueSubmit(device->graphics_queue, 1, &submit_info, fence) != VK_SUCCESS)
 	{
-		// Destroy temporary objects:
-		vkDestroyFence(device->logical_device, fence, NULL);
-		vkFreeCommandBuffers(device->logical_device,
-			commands->command_pool, 1, &command_buffer);
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
-		vkFreeMemory(device->logical_device, staging_memory, NULL);
-
 		fprintf(stderr, "Error: Unable to submit commands for 3D SDF copying!\n");
 		return -1;
 	}
 
-	// Wait for fence:
-	if (vkWaitForFences(device->logical_device, 1, &fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
-	{
-		// Destroy temporary objects:
-		vkDestroyFence(device->logical_device, fence, NULL);
-		vkFreeCommandBuffers(device->logical_device,
-			commands->command_pool, 1, &command_buffer);
-		vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
-		vkFreeMemory(device->logical_device, staging_memory, NULL);
-
-		fprintf(stderr, "Error: Failed to wait for fence for 3D SDF copying!\n");
-		return -1;
-	}
+	return 0;
+}
 
-	// Destroy temporary objects:
-	vkDestroyFence(device->logical_device, fence, NULL);
-	vkFreeCommandBuffers(device->logical_device, commands->command_pool, 1, &command_buffer);
-	vkDestroyBuffer(device->logical_device, staging_buffer, NULL);
-	vkFreeMemory(device->logical_device, staging_memory, NULL);
+// Destroy temporary objects used for copying 3D SDF data:
+void destroy_sdf_3d_copy_objects(FracRenderVulkanDevice *device,
+		FracRenderVulkanCommands *commands, FracRenderSDF3D *sdf_3d,
+				FracRenderVulkanSDF3DCopy *copy)
+{
+	// Voxels calculated into the staging buffer go with it:
+	if (sdf_3d->deferred == 1) { sdf_3d->voxels = NULL; }
 
-	printf("... done.\n");
-	printf("----------------------------------------");
-	printf("----------------------------------------\n\n");
+	if (copy->fence != VK_NULL_HANDLE)
+	{
+		vkDestroyFence(device->logical_device, copy->fence, NULL);
+	}
+	if (copy->num_chunks > 0)
+	{
+		vkFreeCommandBuffers(device->logical_device, commands->command_pool,
+					copy->num_chunks, copy->command_buffers);
+	}
+	if (copy->staging_buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(device->logical_device, copy->staging_buffer, NULL);
+	}
+	if (copy->staging_memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device->logical_device, copy->staging_memory, NULL);
+	}
+}
 
-	return 0;
+// Record copy of staging buffer into 3D SDF image, with layout transitions:
+void record_sdf_3d_image_copy(FracRenderVulkanDescriptors *descriptors, FracRenderSDF3D *sdf_3d,
+				VkBuffer staging_buffer, VkCommandBuffer command_buffer)
+{
+	uint32_t resolution = 1u << sdf_3d->levels;
+
+	// Transition image layout for copying:
+	VkImageMemoryBarrier image_barrier_1;
+	memset(&image_barrier_1, 0, sizeof(VkImageMemoryBarrier));
+	image_barrier_1.sType 			= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	image_barrier_1.pNext			= NULL;
+	image_barrier_1.srcAccessMask		= VK_ACCESS_NONE;
+	image_barrier_1.dstAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	image_barrier_1.oldLayout		= VK_IMAGE_LAYOUT_UNDEFINED;
+	image_barrier_1.newLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	image_barrier_1.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	image_barrier_1.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	image_barrier_1.image			= descriptors->sdf_3d_image;
+
+	image_barrier_1.subresourceRange.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+	image_barrier_1.subresourceRange.baseMipLevel	= 0;
+	image_barrier_1.subresourceRange.levelCount	= 1;
+	image_barrier_1.subresourceRange.baseArrayLayer	= 0;
+	image_barrier_1.subresourceRange.layerCount	= 1;
+
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 0, NULL, 0, NULL, 1, &image_barrier_1);
+
+	// Copy the whole grid:
+	VkBufferImageCopy image_copy_info[1];
+	memset(image_copy_info, 0, 1 * sizeof(VkBufferImageCopy));
+	image_copy_info[0].bufferOffset		= 0;
+	image_copy_info[0].bufferRowLength	= 0;
+	image_copy_info[0].bufferImageHeight	= 0;
+
+	image_copy_info[0].imageSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	image_copy_info[0].imageSubresource.mipLevel		= 0;
+	image_copy_info[0].imageSubresource.baseArrayLayer	= 0;
+	image_copy_info[0].imageSubresource.layerCount		= 1;
+
+	image_copy_info[0].imageOffset.x	= 0;
+	image_copy_info[0].imageOffset.y	= 0;
+	image_copy_info[0].imageOffset.z	= 0;
+	image_copy_info[0].imageExtent.width	= resolution;
+	image_copy_info[0].imageExtent.height	= resolution;
+	image_copy_info[0].imageExtent.depth	= resolution;
+
+	vkCmdCopyBufferToImage(command_buffer, staging_buffer, descriptors->sdf_3d_image,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, image_copy_info);
+
+	// Transition image layout for sampling in the geometry pass:
+	VkImageMemoryBarrier image_barrier_2;
+	memset(&image_barrier_2, 0, sizeof(VkImageMemoryBarrier));
+	image_barrier_2.sType 			= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	image_barrier_2.pNext			= NULL;
+	image_barrier_2.srcAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	image_barrier_2.dstAccessMask		= VK_ACCESS_SHADER_READ_BIT;
+	image_barrier_2.oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	image_barrier_2.newLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	image_barrier_2.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	image_barrier_2.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	image_barrier_2.image			= descriptors->sdf_3d_image;
+
+	image_barrier_2.subresourceRange.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+	image_barrier_2.subresourceRange.baseMipLevel	= 0;
+	image_barrier_2.subresourceRange.levelCount	= 1;
+	image_barrier_2.subresourceRange.baseArrayLayer	= 0;
+	image_barrier_2.subresourceRange.layerCount	= 1;
+
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 0, NULL, 0, NULL, 1, &image_barrier_2);
 }
 
 // Create Temporal Cache descriptor set layout:
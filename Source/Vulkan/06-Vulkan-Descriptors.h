@@ -14,6 +14,7 @@
 #include "../../Third-Party/volk/include/volk/volk.h"
 #include "01-Vulkan-Structs.h"
 #include "../SDF/SDF-3D.h"
+#include "../SDF/SDF-3D-Cache.h"
 
 /***********************
  * Function Prototypes *
@@ -37,9 +38,10 @@ int create_descriptor_pool(FracRenderVulkanDevice *device,
 			FracRenderVulkanDescriptors *descriptors);
 
 // Create sampler:
-int create_sampler(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors);
+int create_sampler(FracRenderVulkanDevice *device, VkSamplerAddressMode address_mode,
+							VkSampler *sampler);
 
-// Create scene buffer:
+// Create scene buffer (one slice per frame slot), and map it:
 int create_scene_buffer(FracRenderVulkanDevice *device,
 			FracRenderVulkanDescriptors *descriptors);
 
@@ -67,6 +69,13 @@ void update_vulkan_g_buffer_descriptors(FracRenderVulkanDevice *device,
 int create_sdf_3d_buffer(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
 									FracRenderSDF3D *sdf_3d);
 
+// Get the most memory the 3D SDF can use on the device, in bytes:
+size_t get_vulkan_sdf_3d_memory_limit(FracRenderVulkanDevice *device, int texture);
+
+// Create 3D texture for dense 3D SDF:
+int create_sdf_3d_image(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
+									FracRenderSDF3D *sdf_3d);
+
 // Create 3D SDF descriptor set layout:
 int create_sdf_3d_descriptor_layout(FracRenderVulkanDevice *device,
 			FracRenderVulkanDescriptors *descriptors);
@@ -79,6 +88,24 @@ int create_sdf_3d_descriptor(FracRenderVulkanDevice *device,
 int copy_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
 				FracRenderVulkanCommands *commands, FracRenderSDF3D *sdf_3d);
 
+// Calculate 3D SDF voxels straight into the mapped 3D SDF buffer:
+int create_sdf_3d_in_place(FracRenderVulkanDevice *device,
+		FracRenderVulkanDescriptors *descriptors, FracRenderSDF3D *sdf_3d);
+
+// Record and submit copy of part of the staging buffer into the 3D SDF buffer or image:
+int submit_sdf_3d_copy(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
+	FracRenderSDF3D *sdf_3d, VkBuffer staging_buffer, VkCommandBuffer command_buffer,
+			VkDeviceSize offset, VkDeviceSize size, VkFence fence);
+
+// Destroy temporary objects used for copying 3D SDF data:
+void destroy_sdf_3d_copy_objects(FracRenderVulkanDevice *device,
+		FracRenderVulkanCommands *commands, FracRenderSDF3D *sdf_3d,
+				FracRenderVulkanSDF3DCopy *copy);
+
+// Record copy of staging buffer into 3D SDF image, with layout transitions:
+void record_sdf_3d_image_copy(FracRenderVulkanDescriptors *descriptors, FracRenderSDF3D *sdf_3d,
+				VkBuffer staging_buffer, VkCommandBuffer command_buffer);
+
 // Create Temporal Cache descriptor set layout:
 int create_temporal_cache_descriptor_layout(FracRenderVulkanDevice *device,
 				FracRenderVulkanDescriptors *descriptors);
@@ -309,6 +309,20 @@ int create_geometry_render_pass(FracRenderVulkanDevice *device,
 	subpasses[0].preserveAttachmentCount	= 0;
 	subpasses[0].pPreserveAttachments	= NULL;
 
+	// With frames in flight, the G-buffer is only cleared once the frame before has finished
+	// writing it, reading it in the colour pass and copying it to the Temporal Cache:
+	VkSubpassDependency dependencies[1];
+	memset(dependencies, 0, 1 * sizeof(VkSubpassDependency));
+	dependencies[0].srcSubpass	= VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass	= 0;
+	dependencies[0].srcStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+					VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+					VK_PIPELINE_STAGE_TRANSFER_BIT;
+	dependencies[0].dstStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[0].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dstAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dependencyFlags	= 0;
+
 	// Define render pass creation info:
 	VkRenderPassCreateInfo pass_info;
 	memset(&pass_info, 0, sizeof(VkRenderPassCreateInfo));
@@ -319,8 +333,8 @@ int create_geometry_render_pass(FracRenderVulkanDevice *device,
 	pass_info.pAttachments		= attachments;
 	pass_info.subpassCount		= 1;
 	pass_info.pSubpasses		= subpasses;
-	pass_info.dependencyCount	= 0;
-	pass_info.pDependencies		= NULL;
+	pass_info.dependencyCount	= 1;
+	pass_info.pDependencies		= dependencies;
 
 	// Create render pass:
 	if (vkCreateRenderPass(device->logical_device, &pass_info, NULL,
@@ -358,6 +372,12 @@ int create_colour_render_pass(FracRenderVulkanDevice *device,
 	attachments[0].initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
 	attachments[0].finalLayout	= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
+	// Offscreen images are never presented, but may be copied out:
+	if (swapchain->headless == 1)
+	{
+		attachments[0].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	}
+
 	// Create subpass attachments:
 	VkAttachmentReference subpass_attachments[1];
 	memset(subpass_attachments, 0, 1 * sizeof(VkAttachmentReference));
@@ -380,6 +400,18 @@ int create_colour_render_pass(FracRenderVulkanDevice *device,
 	subpasses[0].preserveAttachmentCount	= 0;
 	subpasses[0].pPreserveAttachments	= NULL;
 
+	// Start on the image once it has been acquired (at the stage the frame slot's semaphore is
+	// waited at), and once an earlier frame in flight has finished writing it:
+	VkSubpassDependency dependencies[1];
+	memset(dependencies, 0, 1 * sizeof(VkSubpassDependency));
+	dependencies[0].srcSubpass	= VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass	= 0;
+	dependencies[0].srcStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[0].dstStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[0].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dstAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dependencyFlags	= 0;
+
 	// Define render pass creation info:
 	VkRenderPassCreateInfo pass_info;
 	memset(&pass_info, 0, sizeof(VkRenderPassCreateInfo));
@@ -390,8 +422,8 @@ int create_colour_render_pass(FracRenderVulkanDevice *device,
 	pass_info.pAttachments		= attachments;
 	pass_info.subpassCount		= 1;
 	pass_info.pSubpasses		= subpasses;
-	pass_info.dependencyCount	= 0;
-	pass_info.pDependencies		= NULL;
+	pass_info.dependencyCount	= 1;
+	pass_info.pDependencies		= dependencies;
 
 	// Create render pass:
 	if (vkCreateRenderPass(device->logical_device, &pass_info, NULL,
@@ -437,11 +469,16 @@ int create_pipeline_layout(FracRenderVulkanDevice *device, FracRenderVulkanDescr
 	}
 	else
 	{
-		// Colour pipeline:
+		// Colour pipeline, reading the 3D SDF's stored shading if there is any:
 		num_layouts = 2;
+		if (pipeline->colour_sdf_3d == 1) { num_layouts = 3; }
 		layouts = malloc(num_layouts * sizeof(VkDescriptorSetLayout));
 		layouts[0] = descriptors->scene_descriptor_layout;
 		layouts[1] = descriptors->g_buffer_descriptor_layout;
+		if (pipeline->colour_sdf_3d == 1)
+		{
+			layouts[2] = descriptors->sdf_3d_descriptor_layout;
+		}
 	}
 
 	// Create the pipeline layout info:
@@ -230,6 +230,12 @@ int create_g_buffer_images(FracRenderVulkanDevice *device, FracRenderVulkanSwapc
 				VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 		}
 
+		// The compute geometry pass writes the G-buffer directly:
+		if (framebuffers->g_buffer_storage == 1)
+		{
+			image_info.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+		}
+
 		image_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
 		image_info.queueFamilyIndexCount	= 0;
 		image_info.pQueueFamilyIndices		= NULL;
@@ -7,6 +7,8 @@ int initialize_vulkan_commands(FracRenderVulkanDevice *device,
 	printf("----------------------------------------");
 	printf("----------------------------------------\n");
 	printf("Initializing Vulkan command pool, fences and semaphores...\n");
+	printf("      - Frames in flight: %u.\n", commands->num_frames_in_flight);
+	if (commands->prerecord == 1) { printf("      - Pre-recorded command buffers.\n"); }
 
 	// Create command pool:
 	printf(" ---> Creating command pool.\n");
@@ -17,25 +19,35 @@ int initialize_vulkan_commands(FracRenderVulkanDevice *device,
 
 	// Create command buffers:
 	printf(" ---> Creating command buffers.\n");
-	if (create_command_buffers(device, swapchain, commands) != 0)
+	if (create_command_buffers(device, commands) != 0)
 	{
 		return -1;
 	}
 
 	// Create fences:
 	printf(" ---> Creating fences.\n");
-	if (create_fences(device, swapchain, commands) != 0)
+	if (create_fences(device, commands) != 0)
 	{
 		return -1;
 	}
 
 	// Create semaphores:
 	printf(" ---> Creating semaphores.\n");
-	if (create_semaphores(device, commands) != 0)
+	if (create_semaphores(device, swapchain, commands) != 0)
 	{
 		return -1;
 	}
 
+	// Create pre-recorded command buffers:
+	if (commands->prerecord == 1)
+	{
+		printf(" ---> Creating pre-recorded command buffers.\n");
+		if (create_prerecorded_command_buffers(device, swapchain, commands) != 0)
+		{
+			return -1;
+		}
+	}
+
 	printf("... Done.\n");
 	printf("----------------------------------------");
 	printf("----------------------------------------\n\n");
@@ -44,11 +56,13 @@ int initialize_vulkan_commands(FracRenderVulkanDevice *device,
 }
 
 // Destroy Vulkan command structure:
-void destroy_vulkan_commands(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
-							FracRenderVulkanCommands *commands)
+void destroy_vulkan_commands(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands)
 {
 	printf(" ---> Destroying Vulkan command pool, fences and semaphores.\n");
 
+	// Free pre-recorded command buffers (while the pool is still there):
+	destroy_prerecorded_command_buffers(device, commands);
+
 	// Destroy command pool:
 	if (commands->command_pool != VK_NULL_HANDLE)
 	{
@@ -64,7 +78,7 @@ void destroy_vulkan_commands(FracRenderVulkanDevice *device, FracRenderVulkanSwa
 	// Destroy fences and free memory:
 	if (commands->fences)
 	{
-		for (uint32_t i = 0; i < swapchain->num_swapchain_images; i++)
+		for (uint32_t i = 0; i < commands->num_frames_in_flight; i++)
 		{
 			if (commands->fences[i] != VK_NULL_HANDLE)
 			{
@@ -74,15 +88,20 @@ void destroy_vulkan_commands(FracRenderVulkanDevice *device, FracRenderVulkanSwa
 		free(commands->fences);
 	}
 
-	// Destroy semaphores:
-	if (commands->image_available != VK_NULL_HANDLE)
-	{
-		vkDestroySemaphore(device->logical_device, commands->image_available, NULL);
-	}
-	if (commands->render_finished != VK_NULL_HANDLE)
+	// Destroy semaphores and free memory:
+	if (commands->image_available)
 	{
-		vkDestroySemaphore(device->logical_device, commands->render_finished, NULL);
+		for (uint32_t i = 0; i < commands->num_frames_in_flight; i++)
+		{
+			if (commands->image_available[i] != VK_NULL_HANDLE)
+			{
+				vkDestroySemaphore(device->logical_device,
+					commands->image_available[i], NULL);
+			}
+		}
+		free(commands->image_available);
 	}
+	destroy_render_finished_semaphores(device, commands);
 }
 
 // Create command pool:
@@ -108,16 +127,15 @@ int create_command_pool(FracRenderVulkanDevice *device, FracRenderVulkanCommands
 	return 0;
 }
 
-// Create command buffers:
-int create_command_buffers(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
-							FracRenderVulkanCommands *commands)
+// Create command buffers (one per frame slot):
+int create_command_buffers(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands)
 {
 	// Allocate memory for command buffers (free in destroy_vulkan_commands):
-	commands->command_buffers = malloc(swapchain->num_swapchain_images *
+	commands->command_buffers = malloc(commands->num_frames_in_flight *
 						sizeof(VkCommandBuffer));
 
-	// Loop through swapchain images:
-	for (uint32_t i = 0; i < swapchain->num_swapchain_images; i++)
+	// Loop through frame slots:
+	for (uint32_t i = 0; i < commands->num_frames_in_flight; i++)
 	{
 		// Define command buffer allocation info:
 		VkCommandBufferAllocateInfo allocate_info;
@@ -140,21 +158,20 @@ int create_command_buffers(FracRenderVulkanDevice *device, FracRenderVulkanSwapc
 	return 0;
 }
 
-// Create fences:
-int create_fences(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
-						FracRenderVulkanCommands *commands)
+// Create fences (one per frame slot):
+int create_fences(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands)
 {
 	// Allocate memory for fences (free in destroy_vulkan_commands):
-	commands->fences = malloc(swapchain->num_swapchain_images * sizeof(VkFence));
+	commands->fences = malloc(commands->num_frames_in_flight * sizeof(VkFence));
 
 	// Initialize the fences to VK_NULL_HANDLE:
-	for (uint32_t i = 0; i < swapchain->num_swapchain_images; i++)
+	for (uint32_t i = 0; i < commands->num_frames_in_flight; i++)
 	{
 		commands->fences[i] = VK_NULL_HANDLE;
 	}
 
-	// Loop through swapchain images:
-	for (uint32_t i = 0; i < swapchain->num_swapchain_images; i++)
+	// Loop through frame slots:
+	for (uint32_t i = 0; i < commands->num_frames_in_flight; i++)
 	{
 		// Define fence creation info:
 		VkFenceCreateInfo fence_info;
@@ -176,35 +193,199 @@ int create_fences(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swa
 }
 
 // Create semaphores:
-int create_semaphores(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands)
+int create_semaphores(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
+							FracRenderVulkanCommands *commands)
 {
-	// Create semaphore to signal that an image is available:
-	VkSemaphoreCreateInfo image_available_info;
-	memset(&image_available_info, 0, sizeof(VkSemaphoreCreateInfo));
-	image_available_info.sType	= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-	image_available_info.pNext	= NULL;
-	image_available_info.flags	= 0;
+	// Allocate memory for "image available" semaphores (free in destroy_vulkan_commands):
+	commands->image_available = malloc(commands->num_frames_in_flight * sizeof(VkSemaphore));
+
+	// Initialize the semaphores to VK_NULL_HANDLE:
+	for (uint32_t i = 0; i < commands->num_frames_in_flight; i++)
+	{
+		commands->image_available[i] = VK_NULL_HANDLE;
+	}
+
+	// Create semaphores to signal that an image is available, one per frame slot:
+	for (uint32_t i = 0; i < commands->num_frames_in_flight; i++)
+	{
+		VkSemaphoreCreateInfo image_available_info;
+		memset(&image_available_info, 0, sizeof(VkSemaphoreCreateInfo));
+		image_available_info.sType	= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		image_available_info.pNext	= NULL;
+		image_available_info.flags	= 0;
+
+		if (vkCreateSemaphore(device->logical_device, &image_available_info,
+				NULL, &commands->image_available[i]) != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to create \"image available\""
+							" semaphore %d!\n", i);
+			return -1;
+		}
+	}
 
-	if (vkCreateSemaphore(device->logical_device, &image_available_info,
-			NULL, &commands->image_available) != VK_SUCCESS)
+	// Create semaphores to signal that rendering is finished, one per swapchain image:
+	if (create_render_finished_semaphores(device, swapchain, commands) != 0)
 	{
-		fprintf(stderr, "Error: Unable to create \"image available\" semaphore!\n");
 		return -1;
 	}
 
-	// Create semaphore to signal that rendering is finished:
-	VkSemaphoreCreateInfo render_finished_info;
-	memset(&render_finished_info, 0, sizeof(VkSemaphoreCreateInfo));
-	render_finished_info.sType	= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-	render_finished_info.pNext	= NULL;
-	render_finished_info.flags	= 0;
+	return 0;
+}
+
+// Create "render finished" semaphores (one per swapchain image):
+int create_render_finished_semaphores(FracRenderVulkanDevice *device,
+	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands)
+{
+	// Allocate memory for semaphores (free in destroy_render_finished_semaphores):
+	commands->num_render_finished = swapchain->num_swapchain_images;
+	commands->render_finished = malloc(commands->num_render_finished * sizeof(VkSemaphore));
+
+	// Initialize the semaphores to VK_NULL_HANDLE:
+	for (uint32_t i = 0; i < commands->num_render_finished; i++)
+	{
+		commands->render_finished[i] = VK_NULL_HANDLE;
+	}
+
+	// Loop through swapchain images:
+	for (uint32_t i = 0; i < commands->num_render_finished; i++)
+	{
+		VkSemaphoreCreateInfo render_finished_info;
+		memset(&render_finished_info, 0, sizeof(VkSemaphoreCreateInfo));
+		render_finished_info.sType	= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		render_finished_info.pNext	= NULL;
+		render_finished_info.flags	= 0;
+
+		if (vkCreateSemaphore(device->logical_device, &render_finished_info,
+				NULL, &commands->render_finished[i]) != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to create \"render finished\""
+							" semaphore %d!\n", i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
 
-	if (vkCreateSemaphore(device->logical_device, &render_finished_info,
-			NULL, &commands->render_finished) != VK_SUCCESS)
+// Destroy "render finished" semaphores:
+void destroy_render_finished_semaphores(FracRenderVulkanDevice *device,
+					FracRenderVulkanCommands *commands)
+{
+	if (commands->render_finished)
 	{
-		fprintf(stderr, "Error: Unable to create \"render finished\" semaphore!\n");
+		for (uint32_t i = 0; i < commands->num_render_finished; i++)
+		{
+			if (commands->render_finished[i] != VK_NULL_HANDLE)
+			{
+				vkDestroySemaphore(device->logical_device,
+					commands->render_finished[i], NULL);
+			}
+		}
+		free(commands->render_finished);
+	}
+
+	commands->num_render_finished = 0;
+	commands->render_finished = NULL;
+}
+
+// Recreate "render finished" semaphores, after the swapchain is recreated:
+int recreate_render_finished_semaphores(FracRenderVulkanDevice *device,
+	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands)
+{
+	// Destroy current semaphores and free memory:
+	destroy_render_finished_semaphores(device, commands);
+
+	// Create new ones, as the number of swapchain images can change:
+	if (create_render_finished_semaphores(device, swapchain, commands) != 0)
+	{
+		return -1;
+	}
+
+	return 0;
+}
+
+// Create pre-recorded command buffers (one per frame slot and swapchain image):
+int create_prerecorded_command_buffers(FracRenderVulkanDevice *device,
+	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands)
+{
+	uint32_t num_buffers = commands->num_frames_in_flight * swapchain->num_swapchain_images;
+
+	// Allocate memory (free in destroy_prerecorded_command_buffers). Generation 0 is never
+	// current, so each command buffer is recorded before it is first submitted:
+	commands->num_prerecorded_images = swapchain->num_swapchain_images;
+	commands->prerecorded_command_buffers = malloc(num_buffers * sizeof(VkCommandBuffer));
+	commands->prerecorded_generations = malloc(num_buffers * sizeof(uint64_t));
+	memset(commands->prerecorded_generations, 0, num_buffers * sizeof(uint64_t));
+	commands->generation = 1;
+	commands->prerecorded_sdf_3d_descriptor = VK_NULL_HANDLE;
+
+	// Define command buffer allocation info:
+	VkCommandBufferAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkCommandBufferAllocateInfo));
+	allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocate_info.pNext			= NULL;
+	allocate_info.commandPool		= commands->command_pool;
+	allocate_info.level			= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount	= num_buffers;
+
+	// Allocate command buffers from pool:
+	if (vkAllocateCommandBuffers(device->logical_device, &allocate_info,
+			commands->prerecorded_command_buffers) != VK_SUCCESS)
+	{
+		free(commands->prerecorded_command_buffers);
+		commands->prerecorded_command_buffers = NULL;
+		fprintf(stderr, "Error: Unable to allocate pre-recorded command buffers!\n");
 		return -1;
 	}
 
 	return 0;
 }
+
+// Destroy pre-recorded command buffers (before the command pool):
+void destroy_prerecorded_command_buffers(FracRenderVulkanDevice *device,
+					FracRenderVulkanCommands *commands)
+{
+	if (commands->prerecorded_command_buffers)
+	{
+		vkFreeCommandBuffers(device->logical_device, commands->command_pool,
+			commands->num_frames_in_flight * commands->num_prerecorded_images,
+			commands->prerecorded_command_buffers);
+		free(commands->prerecorded_command_buffers);
+	}
+	if (commands->prerecorded_generations)
+	{
+		free(commands->prerecorded_generations);
+	}
+
+	commands->num_prerecorded_images = 0;
+	commands->prerecorded_command_buffers = NULL;
+	commands->prerecorded_generations = NULL;
+}
+
+// Recreate pre-recorded command buffers, after the swapchain is recreated:
+int recreate_prerecorded_command_buffers(FracRenderVulkanDevice *device,
+	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands)
+{
+	if (commands->prerecord == 0) { return 0; }
+
+	// Destroy current command buffers and free memory:
+	destroy_prerecorded_command_buffers(device, commands);
+
+	// Create new ones, all to be recorded again:
+	if (create_prerecorded_command_buffers(device, swapchain, commands) != 0)
+	{
+		return -1;
+	}
+
+	return 0;
+}
+
+// Get the command buffer a frame is recorded into and submitted from:
+VkCommandBuffer get_frame_command_buffer(FracRenderVulkanCommands *commands,
+				uint32_t frame_slot, uint32_t image_index)
+{
+	if (commands->prerecord == 0) { return commands->command_buffers[frame_slot]; }
+
+	return commands->prerecorded_command_buffers[(frame_slot *
+					commands->num_prerecorded_images) + image_index];
+}
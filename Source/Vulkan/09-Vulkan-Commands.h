@@ -14,6 +14,31 @@
 #include "../../Third-Party/volk/include/volk/volk.h"
 #include "01-Vulkan-Structs.h"
 
+/*
+ * Frames are recorded into a ring of frame slots, separate from the swapchain images. Each slot
+ * has its own command buffer, fence, "image available" semaphore and timestamp queries, so the
+ * CPU only waits for the frame that last used the slot it is about to record into, and up to
+ * num_frames_in_flight frames can be queued on the GPU at once.
+ *
+ * A "render finished" semaphore is still kept for each swapchain image. Presenting waits on it
+ * after the slot's fence has signalled, so it can only be reused once its image comes back from
+ * the presentation engine (recreated with the swapchain, as the image count can change).
+ */
+
+/*
+ * In pre-recorded mode, each frame slot also has a command buffer for each swapchain image,
+ * recorded the first time that pair comes up and submitted again after that. Everything that
+ * changes from frame to frame reaches the GPU through buffers (the scene uniform ring and the
+ * 3D SDF), so a command buffer is only re-recorded when the generation moves on: when the
+ * swapchain is recreated (with the framebuffers, pipelines and descriptors that go with it),
+ * or when a new 3D SDF is swapped in under another descriptor set. Frames then cost the CPU
+ * little more than writing the uniform, acquiring, submitting and presenting.
+ */
+
+// Frames in flight by default, and most allowed:
+#define FRACRENDER_DEFAULT_FRAMES_IN_FLIGHT 2
+#define FRACRENDER_MAX_FRAMES_IN_FLIGHT 4
+
 /***********************
  * Function Prototypes *
 ************************/
@@ -23,21 +48,47 @@ int initialize_vulkan_commands(FracRenderVulkanDevice *device,
 	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands);
 
 // Destroy Vulkan command structure:
-void destroy_vulkan_commands(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
-							FracRenderVulkanCommands *commands);
+void destroy_vulkan_commands(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands);
 
 // Create command pool:
 int create_command_pool(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands);
 
-// Create command buffers:
-int create_command_buffers(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
-							FracRenderVulkanCommands *commands);
+// Create command buffers (one per frame slot):
+int create_command_buffers(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands);
 
-// Create fences:
-int create_fences(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
-							FracRenderVulkanCommands *commands);
+// Create fences (one per frame slot):
+int create_fences(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands);
 
 // Create semaphores:
-int create_semaphores(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands);
+int create_semaphores(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
+							FracRenderVulkanCommands *commands);
+
+// Create "render finished" semaphores (one per swapchain image):
+int create_render_finished_semaphores(FracRenderVulkanDevice *device,
+	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands);
+
+// Destroy "render finished" semaphores:
+void destroy_render_finished_semaphores(FracRenderVulkanDevice *device,
+					FracRenderVulkanCommands *commands);
+
+// Recreate "render finished" semaphores, after the swapchain is recreated:
+int recreate_render_finished_semaphores(FracRenderVulkanDevice *device,
+	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands);
+
+// Create pre-recorded command buffers (one per frame slot and swapchain image):
+int create_prerecorded_command_buffers(FracRenderVulkanDevice *device,
+	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands);
+
+// Destroy pre-recorded command buffers (before the command pool):
+void destroy_prerecorded_command_buffers(FracRenderVulkanDevice *device,
+					FracRenderVulkanCommands *commands);
+
+// Recreate pre-recorded command buffers, after the swapchain is recreated:
+int recreate_prerecorded_command_buffers(FracRenderVulkanDevice *device,
+	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanCommands *commands);
+
+// Get the command buffer a frame is recorded into and submitted from:
+VkCommandBuffer get_frame_command_buffer(FracRenderVulkanCommands *commands,
+				uint32_t frame_slot, uint32_t image_index);
 
 #endif
@@ -32,20 +32,22 @@ void update_scene_uniform(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 int record_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescriptors *descriptors,
 		FracRenderVulkanPipeline *pipeline, FracRenderVulkanFramebuffers *framebuffers,
 		FracRenderVulkanCommands *commands, FracRenderVulkanPerformance *performance,
-		FracRenderVulkanSceneUniform *scene_uniform, FracRenderProgramState *program_state,
-		uint32_t image_index)
+		FracRenderProgramState *program_state, uint32_t frame_slot, uint32_t image_index)
 {
-	// Create command buffer begin info:
+	VkCommandBuffer command_buffer = get_frame_command_buffer(commands, frame_slot,
+									image_index);
+
+	// Create command buffer begin info (pre-recorded command buffers are submitted again):
 	VkCommandBufferBeginInfo begin_info;
 	memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
 	begin_info.sType		= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	begin_info.pNext		= NULL;
 	begin_info.flags		= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	begin_info.pInheritanceInfo	= NULL;
+	if (commands->prerecord == 1) { begin_info.flags = 0; }
 
 	// Begin recording commands:
-	if (vkBeginCommandBuffer(commands->command_buffers[image_index],
-					&begin_info) != VK_SUCCESS)
+	if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
 	{
 		fprintf(stderr, "Error: Unable to begin recording commands!\n");
 		return -1;
@@ -55,141 +57,44 @@ int record_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescri
 	if (program_state->performance > -1)
 	{
 		vkCmdResetQueryPool(
-			commands->command_buffers[image_index],
+			command_buffer,
 			performance->query_pool,
-			2 * image_index,
+			2 * frame_slot,
 			2
 		);
 
 		vkCmdWriteTimestamp(
-			commands->command_buffers[image_index],
+			command_buffer,
 			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
 			performance->query_pool,
-			2 * image_index
+			2 * frame_slot
 		);
 	}
 
-	// Upload scene uniform data. First put up a barrier:
-	VkBufferMemoryBarrier buffer_barrier_1;
-	memset(&buffer_barrier_1, 0, sizeof(VkBufferMemoryBarrier));
-	buffer_barrier_1.sType			= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-	buffer_barrier_1.pNext			= NULL;
-	buffer_barrier_1.srcAccessMask		= VK_ACCESS_UNIFORM_READ_BIT;
-	buffer_barrier_1.dstAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
-	buffer_barrier_1.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
-	buffer_barrier_1.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
-	buffer_barrier_1.buffer			= descriptors->scene_buffer;
-	buffer_barrier_1.offset			= 0;
-	buffer_barrier_1.size			= VK_WHOLE_SIZE;
-
-	vkCmdPipelineBarrier(commands->command_buffers[image_index],
-		VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-		VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 1, &buffer_barrier_1, 0, NULL);
-
-	// Update buffer:
-	vkCmdUpdateBuffer(commands->command_buffers[image_index], descriptors->scene_buffer,
-				0, sizeof(FracRenderVulkanSceneUniform), scene_uniform);
-
-	// Put up a final barrier:
-	VkBufferMemoryBarrier buffer_barrier_2;
-	memset(&buffer_barrier_2, 0, sizeof(VkBufferMemoryBarrier));
-	buffer_barrier_2.sType			= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-	buffer_barrier_2.pNext			= NULL;
-	buffer_barrier_2.srcAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
-	buffer_barrier_2.dstAccessMask		= VK_ACCESS_UNIFORM_READ_BIT;
-	buffer_barrier_2.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
-	buffer_barrier_2.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
-	buffer_barrier_2.buffer			= descriptors->scene_buffer;
-	buffer_barrier_2.offset			= 0;
-	buffer_barrier_2.size			= VK_WHOLE_SIZE;
-
-	vkCmdPipelineBarrier(commands->command_buffers[image_index],
-		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
-		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 1, &buffer_barrier_2, 0, NULL);
-
-	// Set G-buffer clear colour:
-	int num_clear_values;
-	if (program_state->optimize == 1) { num_clear_values = 2; }
-	else { num_clear_values = 1; }
-
-	VkClearValue *geometry_clear_values;
-	geometry_clear_values = malloc(num_clear_values * sizeof(VkClearValue));
-	memset(geometry_clear_values, 0, num_clear_values * sizeof(VkClearValue));
-
-	// Position/iteration:
-	geometry_clear_values[0].color.float32[0] = 0.f;
-	geometry_clear_values[0].color.float32[1] = 0.f;
-	geometry_clear_values[0].color.float32[2] = 0.f;
-	geometry_clear_values[0].color.float32[3] = 1.f;
-
-	if (program_state->optimize == 1)
-	{
-		// Distance write:
-		geometry_clear_values[1].color.float32[0] = 0.f;
-		geometry_clear_values[1].color.float32[1] = 0.f;
-		geometry_clear_values[1].color.float32[2] = 0.f;
-		geometry_clear_values[1].color.float32[3] = 1.f;
-	}
-
-	// Define render pass begin info:
-	VkRenderPassBeginInfo geometry_pass_info;
-	memset(&geometry_pass_info, 0, sizeof(VkRenderPassBeginInfo));
-	geometry_pass_info.sType			= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	geometry_pass_info.pNext			= NULL;
-	geometry_pass_info.renderPass			= pipeline->geometry_render_pass;
-	geometry_pass_info.framebuffer			= framebuffers->g_buffer;
-	geometry_pass_info.renderArea.offset.x		= 0;
-	geometry_pass_info.renderArea.offset.y		= 0;
-	geometry_pass_info.renderArea.extent.width	= swapchain->swapchain_extent.width;
-	geometry_pass_info.renderArea.extent.height	= swapchain->swapchain_extent.height;
-	geometry_pass_info.clearValueCount		= num_clear_values;
-	geometry_pass_info.pClearValues			= geometry_clear_values;
-
-	// Begin render pass:
-	vkCmdBeginRenderPass(commands->command_buffers[image_index],
-		&geometry_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-
-	// Free memory for geometry clear values:
-	free(geometry_clear_values);
-
-	// Bind geometry pipeline:
-	vkCmdBindPipeline(commands->command_buffers[image_index],
-		VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->geometry_pipeline);
-
-	// Bind scene descriptor:
-	vkCmdBindDescriptorSets(commands->command_buffers[image_index],
-		VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->geometry_pipeline_layout,
-		0, 1, &descriptors->scene_descriptor, 0, NULL);
+	// Scene uniform data is read from the frame slot's slice of the ring:
+	uint32_t scene_offset = get_scene_uniform_offset(descriptors, frame_slot);
 
-	if (program_state->optimize == 0)
+	if (pipeline->compute_geometry == 1)
 	{
-		// Bind 3D SDF descriptor:
-		vkCmdBindDescriptorSets(commands->command_buffers[image_index],
-			VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->geometry_pipeline_layout,
-			1, 1, &descriptors->sdf_3d_descriptor, 0, NULL);
+		// Trace the G-buffer in tiles with the compute pipeline:
+		record_compute_geometry(swapchain, descriptors, pipeline, framebuffers,
+						command_buffer, scene_offset);
 	}
-	else if (program_state->optimize == 1)
+	else
 	{
-		// Bind Temporal Cache descriptor:
-		vkCmdBindDescriptorSets(commands->command_buffers[image_index],
-			VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->geometry_pipeline_layout,
-			1, 1, &descriptors->temporal_cache_descriptor, 0, NULL);
+		// Draw the G-buffer with the geometry render pass:
+		record_geometry_render_pass(swapchain, descriptors, pipeline, framebuffers,
+				program_state, command_buffer, scene_offset);
 	}
 
-	// Draw fullscreen triangle:
-	vkCmdDraw(commands->command_buffers[image_index], 3, 1, 0, 0);
-
-	// End the render pass:
-	vkCmdEndRenderPass(commands->command_buffers[image_index]);
-
 	// Write second timestamp:
 	if (program_state->performance > -1)
 	{
 		vkCmdWriteTimestamp(
-			commands->command_buffers[image_index],
+			command_buffer,
 			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
 			performance->query_pool,
-			(2 * image_index) + 1
+			(2 * frame_slot) + 1
 		);
 	}
 
@@ -198,12 +103,16 @@ int record_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescri
 	{
 		// Copy data from third G-Buffer image to Temporal Cache and transition layouts:
 		max_images = framebuffers->num_g_buffer_images - 1;
-		if (copy_g_buffer_image(swapchain, framebuffers,
-			commands->command_buffers[image_index]) != 0)
+		if (copy_g_buffer_image(swapchain, framebuffers, command_buffer) != 0)
 		{
 			return -1;
 		}
 	}
+	else if (pipeline->compute_geometry == 1)
+	{
+		// Already moved to the shader read-only layout at the end of the compute pass:
+		max_images = 0;
+	}
 	else { max_images = framebuffers->num_g_buffer_images; }
 
 	for (uint32_t i = 0; i < max_images; i++)
@@ -226,7 +135,7 @@ int record_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescri
 		image_barrier.subresourceRange.baseArrayLayer	= 0;
 		image_barrier.subresourceRange.layerCount	= 1;
 
-		vkCmdPipelineBarrier(commands->command_buffers[image_index],
+		vkCmdPipelineBarrier(command_buffer,
 			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
 			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL,
 			0, NULL, 1, &image_barrier);
@@ -256,34 +165,42 @@ int record_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescri
 	colour_pass_info.pClearValues			= colour_clear_values;
 
 	// Begin render pass:
-	vkCmdBeginRenderPass(commands->command_buffers[image_index],
+	vkCmdBeginRenderPass(command_buffer,
 		&colour_pass_info, VK_SUBPASS_CONTENTS_INLINE);
 
 	// Bind colour pipeline:
-	vkCmdBindPipeline(commands->command_buffers[image_index],
+	vkCmdBindPipeline(command_buffer,
 		VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->colour_pipeline);
 
 	// Bind scene descriptor:
-	vkCmdBindDescriptorSets(commands->command_buffers[image_index],
+	vkCmdBindDescriptorSets(command_buffer,
 		VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->colour_pipeline_layout,
-		0, 1, &descriptors->scene_descriptor, 0, NULL);
+		0, 1, &descriptors->scene_descriptor, 1, &scene_offset);
 
 	// Bind G-buffer descriptors:
 	for (uint32_t i = 0; i < descriptors->num_g_buffer_descriptors; i++)
 	{
-		vkCmdBindDescriptorSets(commands->command_buffers[image_index],
+		vkCmdBindDescriptorSets(command_buffer,
 			VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->colour_pipeline_layout,
 			i + 1, 1, &descriptors->g_buffer_descriptors[i], 0, NULL);
 	}
 
+	if (pipeline->colour_sdf_3d == 1)
+	{
+		// Bind 3D SDF descriptor, after the G-buffer:
+		vkCmdBindDescriptorSets(command_buffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->colour_pipeline_layout,
+			2, 1, &descriptors->sdf_3d_descriptor, 0, NULL);
+	}
+
 	// Draw fullscreen triangle:
-	vkCmdDraw(commands->command_buffers[image_index], 3, 1, 0, 0);
+	vkCmdDraw(command_buffer, 3, 1, 0, 0);
 
 	// End the render pass:
-	vkCmdEndRenderPass(commands->command_buffers[image_index]);
+	vkCmdEndRenderPass(command_buffer);
 
 	// End recording:
-	if (vkEndCommandBuffer(commands->command_buffers[image_index]) != VK_SUCCESS)
+	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
 	{
 		fprintf(stderr, "Error: Unable to end command recording!\n");
 		return -1;
@@ -292,10 +209,141 @@ int record_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescri
 	return 0;
 }
 
+// Record the geometry render pass, drawing a fullscreen triangle into the G-buffer:
+void record_geometry_render_pass(FracRenderVulkanSwapchain *swapchain,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline,
+	FracRenderVulkanFramebuffers *framebuffers, FracRenderProgramState *program_state,
+			VkCommandBuffer command_buffer, uint32_t scene_offset)
+{
+	// Set G-buffer clear colour:
+	int num_clear_values;
+	if (program_state->optimize == 1) { num_clear_values = 2; }
+	else { num_clear_values = 1; }
+
+	VkClearValue geometry_clear_values[2];
+	memset(geometry_clear_values, 0, 2 * sizeof(VkClearValue));
+
+	// Position/iteration:
+	geometry_clear_values[0].color.float32[0] = 0.f;
+	geometry_clear_values[0].color.float32[1] = 0.f;
+	geometry_clear_values[0].color.float32[2] = 0.f;
+	geometry_clear_values[0].color.float32[3] = 1.f;
+
+	if (program_state->optimize == 1)
+	{
+		// Distance write:
+		geometry_clear_values[1].color.float32[0] = 0.f;
+		geometry_clear_values[1].color.float32[1] = 0.f;
+		geometry_clear_values[1].color.float32[2] = 0.f;
+		geometry_clear_values[1].color.float32[3] = 1.f;
+	}
+
+	// Define render pass begin info:
+	VkRenderPassBeginInfo geometry_pass_info;
+	memset(&geometry_pass_info, 0, sizeof(VkRenderPassBeginInfo));
+	geometry_pass_info.sType			= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	geometry_pass_info.pNext			= NULL;
+	geometry_pass_info.renderPass			= pipeline->geometry_render_pass;
+	geometry_pass_info.framebuffer			= framebuffers->g_buffer;
+	geometry_pass_info.renderArea.offset.x		= 0;
+	geometry_pass_info.renderArea.offset.y		= 0;
+	geometry_pass_info.renderArea.extent.width	= swapchain->swapchain_extent.width;
+	geometry_pass_info.renderArea.extent.height	= swapchain->swapchain_extent.height;
+	geometry_pass_info.clearValueCount		= num_clear_values;
+	geometry_pass_info.pClearValues			= geometry_clear_values;
+
+	// Begin render pass:
+	vkCmdBeginRenderPass(command_buffer,
+		&geometry_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+
+	// Bind geometry pipeline:
+	vkCmdBindPipeline(command_buffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->geometry_pipeline);
+
+	// Bind scene descriptor:
+	vkCmdBindDescriptorSets(command_buffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->geometry_pipeline_layout,
+		0, 1, &descriptors->scene_descriptor, 1, &scene_offset);
+
+	if (program_state->optimize == 0)
+	{
+		// Bind 3D SDF descriptor:
+		vkCmdBindDescriptorSets(command_buffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->geometry_pipeline_layout,
+			1, 1, &descriptors->sdf_3d_descriptor, 0, NULL);
+	}
+	else if (program_state->optimize == 1)
+	{
+		// Bind Temporal Cache descriptor:
+		vkCmdBindDescriptorSets(command_buffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->geometry_pipeline_layout,
+			1, 1, &descriptors->temporal_cache_descriptor, 0, NULL);
+	}
+
+	// Draw fullscreen triangle:
+	vkCmdDraw(command_buffer, 3, 1, 0, 0);
+
+	// End the render pass:
+	vkCmdEndRenderPass(command_buffer);
+}
+
+// Record commands for a frame, or reuse the pre-recorded ones if nothing they use has changed:
+int prepare_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescriptors *descriptors,
+		FracRenderVulkanPipeline *pipeline, FracRenderVulkanFramebuffers *framebuffers,
+		FracRenderVulkanCommands *commands, FracRenderVulkanPerformance *performance,
+		FracRenderProgramState *program_state, uint32_t frame_slot, uint32_t image_index)
+{
+	if (commands->prerecord == 0)
+	{
+		return record_commands(swapchain, descriptors, pipeline, framebuffers, commands,
+			performance, program_state, frame_slot, image_index);
+	}
+
+	// A new 3D SDF was swapped in under the other descriptor set:
+	if (descriptors->sdf_3d_descriptor != commands->prerecorded_sdf_3d_descriptor)
+	{
+		commands->prerecorded_sdf_3d_descriptor = descriptors->sdf_3d_descriptor;
+		commands->generation++;
+	}
+
+	// The slot's fence has signalled, so the command buffer isn't pending and can be
+	// recorded again:
+	uint32_t index = (frame_slot * commands->num_prerecorded_images) + image_index;
+	if (commands->prerecorded_generations[index] == commands->generation) { return 0; }
+
+	if (record_commands(swapchain, descriptors, pipeline, framebuffers, commands,
+		performance, program_state, frame_slot, image_index) != 0)
+	{
+		return -1;
+	}
+	commands->prerecorded_generations[index] = commands->generation;
+
+	return 0;
+}
+
+// Get the offset of a frame slot's slice of the scene uniform ring:
+uint32_t get_scene_uniform_offset(FracRenderVulkanDescriptors *descriptors, uint32_t frame_slot)
+{
+	return (uint32_t)((frame_slot % descriptors->num_scene_slices) *
+						descriptors->scene_slice_size);
+}
+
+// Write scene uniform data into a frame slot's slice of the ring (once the slot's fence has
+// signalled, so no frame on the GPU is still reading it):
+void write_scene_uniform(FracRenderVulkanDescriptors *descriptors,
+	FracRenderVulkanSceneUniform *scene_uniform, uint32_t frame_slot)
+{
+	memcpy((char *)descriptors->scene_data + get_scene_uniform_offset(descriptors, frame_slot),
+				scene_uniform, sizeof(FracRenderVulkanSceneUniform));
+}
+
 // Submit commands:
-int submit_commands(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands,
-								uint32_t image_index)
+int submit_commands(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
+		FracRenderVulkanCommands *commands, uint32_t frame_slot, uint32_t image_index)
 {
+	VkCommandBuffer command_buffer = get_frame_command_buffer(commands, frame_slot,
+									image_index);
+
 	// Define which stage to wait at for the semaphore:
 	VkPipelineStageFlags wait_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
@@ -305,16 +353,26 @@ int submit_commands(FracRenderVulkanDevice *device, FracRenderVulkanCommands *co
 	submit_info.sType			= VK_STRUCTURE_TYPE_SUBMIT_INFO;
 	submit_info.pNext			= NULL;
 	submit_info.waitSemaphoreCount		= 1;
-	submit_info.pWaitSemaphores		= &commands->image_available;
+	submit_info.pWaitSemaphores		= &commands->image_available[frame_slot];
 	submit_info.pWaitDstStageMask		= &wait_stages;
 	submit_info.commandBufferCount		= 1;
-	submit_info.pCommandBuffers		= &commands->command_buffers[image_index];
+	submit_info.pCommandBuffers		= &command_buffer;
 	submit_info.signalSemaphoreCount	= 1;
-	submit_info.pSignalSemaphores		= &commands->render_finished;
+	submit_info.pSignalSemaphores		= &commands->render_finished[image_index];
+
+	// Offscreen images aren't acquired or presented, so there is nothing to wait for or signal:
+	if (swapchain->headless == 1)
+	{
+		submit_info.waitSemaphoreCount		= 0;
+		submit_info.pWaitSemaphores		= NULL;
+		submit_info.pWaitDstStageMask		= NULL;
+		submit_info.signalSemaphoreCount	= 0;
+		submit_info.pSignalSemaphores		= NULL;
+	}
 
 	// Submit commands:
 	if (vkQueueSubmit(device->graphics_queue, 1, &submit_info,
-		commands->fences[image_index]) != VK_SUCCESS)
+		commands->fences[frame_slot]) != VK_SUCCESS)
 	{
 		fprintf(stderr, "Error: Unable to submit commands!\n");
 		return -1;
@@ -333,7 +391,7 @@ int present_results(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *s
 	present_info.sType		= VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	present_info.pNext		= NULL;
 	present_info.waitSemaphoreCount	= 1;
-	present_info.pWaitSemaphores	= &commands->render_finished;
+	present_info.pWaitSemaphores	= &commands->render_finished[image_index];
 	present_info.swapchainCount	= 1;
 	present_info.pSwapchains	= &swapchain->swapchain;
 	present_info.pImageIndices	= &image_index;
@@ -13,6 +13,8 @@
 // Local includes:
 #include "../../Third-Party/volk/include/volk/volk.h"
 #include "01-Vulkan-Structs.h"
+#include "09-Vulkan-Commands.h"
+#include "17-Vulkan-Compute-Geometry.h"
 #include "../Utility/Program-State.h"
 #include "../Utility/Vectors.h"
 
@@ -24,16 +26,35 @@ void update_scene_uniform(FracRenderVulkanBase *base, FracRenderVulkanDevice *de
 	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanSceneUniform *scene_uniform,
 	FracRenderProgramState *program_state);
 
-// Record commands:
+// Record commands into a frame slot's command buffer, drawing to a swapchain image:
 int record_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescriptors *descriptors,
 		FracRenderVulkanPipeline *pipeline, FracRenderVulkanFramebuffers *framebuffers,
 		FracRenderVulkanCommands *commands, FracRenderVulkanPerformance *performance,
-		FracRenderVulkanSceneUniform *scene_uniform, FracRenderProgramState *program_state,
-		uint32_t image_index);
+		FracRenderProgramState *program_state, uint32_t frame_slot, uint32_t image_index);
+
+// Record the geometry render pass, drawing a fullscreen triangle into the G-buffer:
+void record_geometry_render_pass(FracRenderVulkanSwapchain *swapchain,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline,
+	FracRenderVulkanFramebuffers *framebuffers, FracRenderProgramState *program_state,
+			VkCommandBuffer command_buffer, uint32_t scene_offset);
+
+// Record commands for a frame, or reuse the pre-recorded ones if nothing they use has changed:
+int prepare_commands(FracRenderVulkanSwapchain *swapchain, FracRenderVulkanDescriptors *descriptors,
+		FracRenderVulkanPipeline *pipeline, FracRenderVulkanFramebuffers *framebuffers,
+		FracRenderVulkanCommands *commands, FracRenderVulkanPerformance *performance,
+		FracRenderProgramState *program_state, uint32_t frame_slot, uint32_t image_index);
+
+// Get the offset of a frame slot's slice of the scene uniform ring:
+uint32_t get_scene_uniform_offset(FracRenderVulkanDescriptors *descriptors, uint32_t frame_slot);
+
+// Write scene uniform data into a frame slot's slice of the ring (once the slot's fence has
+// signalled, so no frame on the GPU is still reading it):
+void write_scene_uniform(FracRenderVulkanDescriptors *descriptors,
+	FracRenderVulkanSceneUniform *scene_uniform, uint32_t frame_slot);
 
 // Submit commands:
-int submit_commands(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands,
-								uint32_t image_index);
+int submit_commands(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
+		FracRenderVulkanCommands *commands, uint32_t frame_slot, uint32_t image_index);
 
 // Present results:
 int present_results(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
@@ -2,7 +2,7 @@
 
 // Create Vulkan performance structure:
 int initialize_vulkan_performance(FracRenderVulkanDevice *device,
-	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanPerformance *performance)
+	FracRenderVulkanCommands *commands, FracRenderVulkanPerformance *performance)
 {
 	printf("----------------------------------------");
 	printf("----------------------------------------\n");
@@ -17,7 +17,7 @@ int initialize_vulkan_performance(FracRenderVulkanDevice *device,
 
 	// Create query pool:
 	printf(" ---> Creating timestamp query pool.\n");
-	if (create_query_pool(device, swapchain, performance) != 0)
+	if (create_query_pool(device, commands, performance) != 0)
 	{
 		return -1;
 	}
@@ -62,8 +62,8 @@ int query_timestamp_support(FracRenderVulkanDevice *device,
 	return 0;
 }
 
-// Create query pool:
-int create_query_pool(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
+// Create query pool (2 timestamps per frame slot):
+int create_query_pool(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands,
 						FracRenderVulkanPerformance *performance)
 {
 	// Define pool creation info:
@@ -73,7 +73,7 @@ int create_query_pool(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain
 	pool_info.pNext			= NULL;
 	pool_info.flags			= 0;
 	pool_info.queryType		= VK_QUERY_TYPE_TIMESTAMP;
-	pool_info.queryCount		= 2 * swapchain->num_swapchain_images;
+	pool_info.queryCount		= 2 * commands->num_frames_in_flight;
 	pool_info.pipelineStatistics	= 0;
 
 	// Create the pool:
@@ -83,10 +83,12 @@ int create_query_pool(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain
 		fprintf(stderr, "Error: Unable to create timestamp query pool!\n");
 		return -1;
 	}
+
+	return 0;
 }
 
-// Get difference between 2 timestamps:
-void get_shader_time(double *shader_time, int num_frames, uint32_t image_index, int order,
+// Get difference between a frame slot's 2 timestamps:
+void get_shader_time(double *shader_time, int num_frames, uint32_t frame_slot, int order,
 		FracRenderVulkanDevice *device, FracRenderVulkanPerformance *performance)
 {
 	// Get values in timestamp queries. Get 64-bit values and wait for availability:
@@ -94,7 +96,7 @@ void get_shader_time(double *shader_time, int num_frames, uint32_t image_index,
 	VkResult result = vkGetQueryPoolResults(
 		device->logical_device,
 		performance->query_pool,
-		2 * image_index,	// First query.
+		2 * frame_slot,	// First query.
 		2,			// Query count.
 		2 * sizeof(uint64_t),
 		timestamps,
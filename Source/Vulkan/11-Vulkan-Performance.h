@@ -20,7 +20,7 @@
 
 // Create Vulkan performance structure:
 int initialize_vulkan_performance(FracRenderVulkanDevice *device,
-	FracRenderVulkanSwapchain *swapchain, FracRenderVulkanPerformance *performance);
+	FracRenderVulkanCommands *commands, FracRenderVulkanPerformance *performance);
 
 // Destroy Vulkan performance structure:
 void destroy_vulkan_performance(FracRenderVulkanDevice *device,
@@ -30,12 +30,12 @@ void destroy_vulkan_performance(FracRenderVulkanDevice *device,
 int query_timestamp_support(FracRenderVulkanDevice *device,
 		FracRenderVulkanPerformance *performance);
 
-// Create query pool:
-int create_query_pool(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
+// Create query pool (2 timestamps per frame slot):
+int create_query_pool(FracRenderVulkanDevice *device, FracRenderVulkanCommands *commands,
 						FracRenderVulkanPerformance *performance);
 
-// Get difference between 2 timestamps:
-void get_shader_time(double *shader_time, int num_frames, uint32_t image_index, int order,
+// Get difference between a frame slot's 2 timestamps:
+void get_shader_time(double *shader_time, int num_frames, uint32_t frame_slot, int order,
 		FracRenderVulkanDevice *device, FracRenderVulkanPerformance *performance);
 
 // Write measurements to file:
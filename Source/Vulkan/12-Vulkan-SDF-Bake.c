@@ -0,0 +1,310 @@
+#include "12-Vulkan-SDF-Bake.h"
+
+// Calculate 3D SDF voxels on the GPU, straight into the 3D SDF buffer:
+int bake_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
+	FracRenderVulkanPipeline *pipeline, FracRenderVulkanCommands *commands,
+						FracRenderSDF3D *sdf_3d)
+{
+	printf("----------------------------------------");
+	printf("----------------------------------------\n");
+	printf("Calculating 3D SDF on the GPU...\n");
+
+	if (sdf_3d->levels < 1)
+	{
+		fprintf(stderr, "Error: 3D SDF needs at least 1 level!\n");
+		return -1;
+	}
+
+	// Temporary objects, destroyed by destroy_sdf_3d_bake_objects:
+	FracRenderVulkanSDF3DBake bake;
+	memset(&bake, 0, sizeof(FracRenderVulkanSDF3DBake));
+	bake.shader		= VK_NULL_HANDLE;
+	bake.pipeline_layout	= VK_NULL_HANDLE;
+	bake.pipeline		= VK_NULL_HANDLE;
+	bake.command_buffer	= VK_NULL_HANDLE;
+	bake.fence		= VK_NULL_HANDLE;
+
+	// Create compute pipeline:
+	printf(" ---> Creating compute pipeline.\n");
+	if (create_sdf_3d_bake_pipeline(device, descriptors, pipeline, &bake) != 0)
+	{
+		destroy_sdf_3d_bake_objects(device, commands, &bake);
+		return -1;
+	}
+
+	// Allocate command buffer:
+	VkCommandBufferAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkCommandBufferAllocateInfo));
+	allocate_info.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocate_info.pNext			= NULL;
+	allocate_info.commandPool		= commands->command_pool;
+	allocate_info.level			= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount	= 1;
+
+	if (vkAllocateCommandBuffers(device->logical_device, &allocate_info,
+					&bake.command_buffer) != VK_SUCCESS)
+	{
+		bake.command_buffer = VK_NULL_HANDLE;
+		destroy_sdf_3d_bake_objects(device, commands, &bake);
+
+		fprintf(stderr, "Error: Unable to allocate command buffer for "
+						"3D SDF calculation!\n");
+		return -1;
+	}
+
+	// Create fence for submitting commands:
+	VkFenceCreateInfo fence_info;
+	memset(&fence_info, 0, sizeof(VkFenceCreateInfo));
+	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fence_info.pNext = NULL;
+	fence_info.flags = 0;
+
+	if (vkCreateFence(device->logical_device, &fence_info, NULL, &bake.fence) != VK_SUCCESS)
+	{
+		destroy_sdf_3d_bake_objects(device, commands, &bake);
+
+		fprintf(stderr, "Error: Unable to create fence for 3D SDF calculation!\n");
+		return -1;
+	}
+
+	// Record dispatches:
+	printf(" ---> Calculating distance values (compute shader).\n");
+	printf("      - Format: %s.\n", get_sdf_3d_format_name(sdf_3d->format));
+
+	struct timespec start_time;
+	struct timespec end_time;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	if (record_sdf_3d_bake(descriptors, sdf_3d, &bake) != 0)
+	{
+		destroy_sdf_3d_bake_objects(device, commands, &bake);
+		return -1;
+	}
+
+	// Submit commands:
+	VkSubmitInfo submit_info;
+	memset(&submit_info, 0, sizeof(VkSubmitInfo));
+	submit_info.sType			= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.pNext			= NULL;
+	submit_info.waitSemaphoreCount		= 0;
+	submit_info.pWaitSemaphores		= NULL;
+	submit_info.pWaitDstStageMask		= NULL;
+	submit_info.commandBufferCount		= 1;
+	submit_info.pCommandBuffers		= &bake.command_buffer;
+	submit_info.signalSemaphoreCount	= 0;
+	submit_info.pSignalSemaphores		= NULL;
+
+	if (vkQueueSubmit(device->graphics_queue, 1, &submit_info, bake.fence) != VK_SUCCESS)
+	{
+		destroy_sdf_3d_bake_objects(device, commands, &bake);
+
+		fprintf(stderr, "Error: Unable to submit commands for 3D SDF calculation!\n");
+		return -1;
+	}
+
+	// Wait for fence:
+	if (vkWaitForFences(device->logical_device, 1, &bake.fence,
+				VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+	{
+		destroy_sdf_3d_bake_objects(device, commands, &bake);
+
+		fprintf(stderr, "Error: Failed to wait for fence for 3D SDF calculation!\n");
+		return -1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	double seconds = (double)(end_time.tv_sec - start_time.tv_sec) +
+			((double)(end_time.tv_nsec - start_time.tv_nsec) / 1000000000.0);
+
+	size_t memory_used = get_sdf_3d_data_size(sdf_3d);
+	printf("      - Time taken: %.3lf seconds.\n", seconds);
+	printf("      - Memory used: %lu bytes (%lu MB).\n", memory_used,
+						memory_used / (1024 * 1024));
+
+	// Destroy temporary objects:
+	destroy_sdf_3d_bake_objects(device, commands, &bake);
+
+	printf("... done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Create compute pipeline for calculating the 3D SDF:
+int create_sdf_3d_bake_pipeline(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline,
+					FracRenderVulkanSDF3DBake *bake)
+{
+	// Load shader module:
+	bake->shader = load_shader_module(device, pipeline->sdf_3d_bake_shader_path);
+	if (bake->shader == VK_NULL_HANDLE)
+	{
+		return -1;
+	}
+
+	// Define push constant range:
+	VkPushConstantRange push_constant_range;
+	memset(&push_constant_range, 0, sizeof(VkPushConstantRange));
+	push_constant_range.stageFlags	= VK_SHADER_STAGE_COMPUTE_BIT;
+	push_constant_range.offset	= 0;
+	push_constant_range.size	= sizeof(FracRenderVulkanSDF3DBakeConstants);
+
+	// Define pipeline layout creation info. Set 0 is the 3D SDF buffer:
+	VkPipelineLayoutCreateInfo layout_info;
+	memset(&layout_info, 0, sizeof(VkPipelineLayoutCreateInfo));
+	layout_info.sType			= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layout_info.pNext			= NULL;
+	layout_info.flags			= 0;
+	layout_info.setLayoutCount		= 1;
+	layout_info.pSetLayouts			= &descriptors->sdf_3d_descriptor_layout;
+	layout_info.pushConstantRangeCount	= 1;
+	layout_info.pPushConstantRanges		= &push_constant_range;
+
+	// Create the pipeline layout:
+	if (vkCreatePipelineLayout(device->logical_device, &layout_info, NULL,
+				&bake->pipeline_layout) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create 3D SDF compute pipeline layout!\n");
+		return -1;
+	}
+
+	// Define pipeline creation info:
+	VkComputePipelineCreateInfo pipeline_info;
+	memset(&pipeline_info, 0, sizeof(VkComputePipelineCreateInfo));
+	pipeline_info.sType			= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipeline_info.pNext			= NULL;
+	pipeline_info.flags			= 0;
+	pipeline_info.layout			= bake->pipeline_layout;
+	pipeline_info.basePipelineHandle	= VK_NULL_HANDLE;
+	pipeline_info.basePipelineIndex		= -1;
+
+	pipeline_info.stage.sType		=
+				VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipeline_info.stage.pNext		= NULL;
+	pipeline_info.stage.flags		= 0;
+	pipeline_info.stage.stage		= VK_SHADER_STAGE_COMPUTE_BIT;
+	pipeline_info.stage.module		= bake->shader;
+	pipeline_info.stage.pName		= "main";
+	pipeline_info.stage.pSpecializationInfo	= NULL;
+
+	// Create the pipeline:
+	if (vkCreateComputePipelines(device->logical_device, VK_NULL_HANDLE, 1,
+			&pipeline_info, NULL, &bake->pipeline) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create 3D SDF compute pipeline!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Record dispatches filling the 3D SDF buffer, and make the result visible to the geometry pass:
+int record_sdf_3d_bake(FracRenderVulkanDescriptors *descriptors, FracRenderSDF3D *sdf_3d,
+					FracRenderVulkanSDF3DBake *bake)
+{
+	// Begin command recording:
+	VkCommandBufferBeginInfo begin_info;
+	memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
+	begin_info.sType		= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.pNext		= NULL;
+	begin_info.flags		= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	begin_info.pInheritanceInfo	= NULL;
+
+	if (vkBeginCommandBuffer(bake->command_buffer, &begin_info) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to begin recording commands for "
+						"3D SDF calculation!\n");
+		return -1;
+	}
+
+	vkCmdBindPipeline(bake->command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, bake->pipeline);
+	vkCmdBindDescriptorSets(bake->command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+		bake->pipeline_layout, 0, 1, &descriptors->sdf_3d_descriptor, 0, NULL);
+
+	FracRenderVulkanSDF3DBakeConstants constants;
+	memset(&constants, 0, sizeof(FracRenderVulkanSDF3DBakeConstants));
+	constants.sdf_3d_centre		= sdf_3d->centre;
+	constants.sdf_3d_size		= sdf_3d->size;
+	constants.sdf_3d_levels		= sdf_3d->levels;
+	constants.sdf_3d_format		= sdf_3d->format;
+	constants.fractal_parameter	= sdf_3d->parameter;
+	constants.num_entries		= get_sdf_3d_data_size(sdf_3d) / sizeof(uint32_t);
+
+	// Devices only have to allow so many workgroups per dispatch, so split it up:
+	uint32_t entries_per_dispatch = FRACRENDER_SDF_3D_BAKE_MAX_GROUPS *
+					FRACRENDER_SDF_3D_BAKE_GROUP_SIZE;
+	uint32_t num_dispatches = 0;
+	for (uint32_t first_entry = 0; first_entry < constants.num_entries;
+					first_entry += entries_per_dispatch)
+	{
+		uint32_t num_entries = constants.num_entries - first_entry;
+		if (num_entries > entries_per_dispatch) { num_entries = entries_per_dispatch; }
+
+		constants.first_entry = first_entry;
+		vkCmdPushConstants(bake->command_buffer, bake->pipeline_layout,
+			VK_SHADER_STAGE_COMPUTE_BIT, 0,
+			sizeof(FracRenderVulkanSDF3DBakeConstants), &constants);
+
+		uint32_t num_groups = (num_entries + FRACRENDER_SDF_3D_BAKE_GROUP_SIZE - 1) /
+						FRACRENDER_SDF_3D_BAKE_GROUP_SIZE;
+		vkCmdDispatch(bake->command_buffer, num_groups, 1, 1);
+		num_dispatches++;
+	}
+
+	printf("      - Dispatches: %u.\n", num_dispatches);
+
+	// Make shader writes visible to the geometry pass:
+	VkBufferMemoryBarrier buffer_barrier;
+	memset(&buffer_barrier, 0, sizeof(VkBufferMemoryBarrier));
+	buffer_barrier.sType			= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	buffer_barrier.pNext			= NULL;
+	buffer_barrier.srcAccessMask		= VK_ACCESS_SHADER_WRITE_BIT;
+	buffer_barrier.dstAccessMask		= VK_ACCESS_SHADER_READ_BIT;
+	buffer_barrier.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.buffer			= descriptors->sdf_3d_buffer;
+	buffer_barrier.offset			= 0;
+	buffer_barrier.size			= VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(bake->command_buffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 0, NULL, 1, &buffer_barrier, 0, NULL);
+
+	// Finish command recording:
+	if (vkEndCommandBuffer(bake->command_buffer) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to stop recording commands for "
+						"3D SDF calculation!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Destroy temporary objects used for calculating the 3D SDF on the GPU:
+void destroy_sdf_3d_bake_objects(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderVulkanSDF3DBake *bake)
+{
+	if (bake->fence != VK_NULL_HANDLE)
+	{
+		vkDestroyFence(device->logical_device, bake->fence, NULL);
+	}
+	if (bake->command_buffer != VK_NULL_HANDLE)
+	{
+		vkFreeCommandBuffers(device->logical_device, commands->command_pool,
+						1, &bake->command_buffer);
+	}
+	if (bake->pipeline != VK_NULL_HANDLE)
+	{
+		vkDestroyPipeline(device->logical_device, bake->pipeline, NULL);
+	}
+	if (bake->pipeline_layout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(device->logical_device, bake->pipeline_layout, NULL);
+	}
+	if (bake->shader != VK_NULL_HANDLE)
+	{
+		vkDestroyShaderModule(device->logical_device, bake->shader, NULL);
+	}
+}
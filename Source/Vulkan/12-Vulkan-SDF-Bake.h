@@ -0,0 +1,49 @@
+#ifndef FRACRENDER_VULKAN_SDF_BAKE_H
+#define FRACRENDER_VULKAN_SDF_BAKE_H
+
+/*******************************************************************
+ * To calculate the dense 3D SDF on the GPU, with a compute shader *
+ *******************************************************************/
+
+// Library includes:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local includes:
+#include "../../Third-Party/volk/include/volk/volk.h"
+#include "01-Vulkan-Structs.h"
+#include "07-Vulkan-Pipeline.h"
+#include "../SDF/SDF-3D.h"
+
+/*
+ * The compute shader (Bake-<Fractal>-SDF-3D.comp) fills the 3D SDF storage buffer through the
+ * 3D SDF descriptor set, one invocation per buffer entry. Voxels are worked out from their
+ * Morton code, and use the same distance estimator, parameter and rounding as the CPU, so the
+ * buffer holds the same SDF either way. Only core Vulkan 1.0 compute is used.
+ */
+
+/***********************
+ * Function Prototypes *
+************************/
+
+// Calculate 3D SDF voxels on the GPU, straight into the 3D SDF buffer:
+int bake_sdf_3d_data(FracRenderVulkanDevice *device, FracRenderVulkanDescriptors *descriptors,
+	FracRenderVulkanPipeline *pipeline, FracRenderVulkanCommands *commands,
+						FracRenderSDF3D *sdf_3d);
+
+// Create compute pipeline for calculating the 3D SDF:
+int create_sdf_3d_bake_pipeline(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline,
+					FracRenderVulkanSDF3DBake *bake);
+
+// Record dispatches filling the 3D SDF buffer, and make the result visible to the geometry pass:
+int record_sdf_3d_bake(FracRenderVulkanDescriptors *descriptors, FracRenderSDF3D *sdf_3d,
+					FracRenderVulkanSDF3DBake *bake);
+
+// Destroy temporary objects used for calculating the 3D SDF on the GPU:
+void destroy_sdf_3d_bake_objects(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderVulkanSDF3DBake *bake);
+
+#endif
@@ -0,0 +1,496 @@
+#include "13-Vulkan-SDF-Rebake.h"
+
+// Set up recalculating the 3D SDF when the fractal parameter is animated:
+int initialize_vulkan_sdf_3d_rebake(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanCommands *commands,
+	FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d,
+					FracRenderVulkanSDF3DRebake *rebake)
+{
+	memset(rebake, 0, sizeof(FracRenderVulkanSDF3DRebake));
+	rebake->enabled			= 0;
+	rebake->spare_buffer		= VK_NULL_HANDLE;
+	rebake->spare_memory		= VK_NULL_HANDLE;
+	rebake->spare_descriptor	= VK_NULL_HANDLE;
+	rebake->staging_buffer		= VK_NULL_HANDLE;
+	rebake->staging_memory		= VK_NULL_HANDLE;
+	rebake->staging_data		= NULL;
+	rebake->command_buffer		= VK_NULL_HANDLE;
+	rebake->fence			= VK_NULL_HANDLE;
+	rebake->state			= 0;
+	rebake->parameter		= sdf_3d->parameter;
+	rebake->active_parameter	= sdf_3d->parameter;
+	rebake->frames_ahead		= FRACRENDER_SDF_3D_REBAKE_FRAMES_AHEAD;
+
+	// Only needed for the parameter animation, with dense voxels in a storage buffer:
+	if ((program_state->sdf_rebake != 1) || (program_state->optimize != 0) ||
+		(program_state->fractal_type == -1) || (program_state->animation != 0) ||
+		(sdf_3d->layout != 0) || (sdf_3d->texture != 0) || (sdf_3d->num_voxels == 0))
+	{
+		return 0;
+	}
+
+	printf("----------------------------------------");
+	printf("----------------------------------------\n");
+	printf("Initializing 3D SDF recalculation...\n");
+
+	set_up_sdf_3d_rebake(sdf_3d, &rebake->rebake);
+	rebake->size = get_sdf_3d_data_size(sdf_3d);
+
+	// Create spare buffer and descriptor set:
+	printf(" ---> Creating spare 3D SDF buffer.\n");
+	if (create_sdf_3d_rebake_spare(device, descriptors, rebake) != 0)
+	{
+		return -1;
+	}
+
+	// Create staging buffer:
+	printf(" ---> Creating staging buffer.\n");
+	if (create_sdf_3d_staging_buffer(device, rebake->size, &rebake->staging_buffer,
+			&rebake->staging_memory, &rebake->staging_data) != 0)
+	{
+		return -1;
+	}
+
+	// Allocate command buffer:
+	VkCommandBufferAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkCommandBufferAllocateInfo));
+	allocate_info.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocate_info.pNext			= NULL;
+	allocate_info.commandPool		= commands->command_pool;
+	allocate_info.level			= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount	= 1;
+
+	if (vkAllocateCommandBuffers(device->logical_device, &allocate_info,
+					&rebake->command_buffer) != VK_SUCCESS)
+	{
+		rebake->command_buffer = VK_NULL_HANDLE;
+		fprintf(stderr, "Error: Unable to allocate command buffer for "
+						"3D SDF recalculation!\n");
+		return -1;
+	}
+
+	// Create fence for submitting copies:
+	VkFenceCreateInfo fence_info;
+	memset(&fence_info, 0, sizeof(VkFenceCreateInfo));
+	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fence_info.pNext = NULL;
+	fence_info.flags = 0;
+
+	if (vkCreateFence(device->logical_device, &fence_info, NULL,
+					&rebake->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create fence for 3D SDF recalculation!\n");
+		return -1;
+	}
+
+	rebake->enabled = 1;
+
+	printf("      - Threads: %d.\n", rebake->rebake.sdf_3d.num_threads);
+	printf("      - Memory used: %lu bytes (%lu MB) x 2.\n", rebake->size,
+						rebake->size / (1024 * 1024));
+	printf("... Done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Move the recalculation on by a frame, swapping in a new SDF when the animation reaches it:
+int update_vulkan_sdf_3d_rebake(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderProgramState *program_state,
+					FracRenderVulkanSDF3DRebake *rebake)
+{
+	if (rebake->enabled == 0) { return 0; }
+
+	rebake->frames_waited++;
+
+	// Start calculating the SDF for the parameter a few frames ahead:
+	if (rebake->state == 0)
+	{
+		rebake->parameter = get_animation_parameter(program_state,
+				program_state->animation_frames + rebake->frames_ahead);
+		if (start_sdf_3d_rebake(&rebake->rebake, rebake->staging_data,
+							rebake->parameter) != 0)
+		{
+			return -1;
+		}
+		rebake->frames_waited	= 0;
+		rebake->state		= 1;
+	}
+
+	// Copy it to the spare buffer once calculated:
+	else if (rebake->state == 1)
+	{
+		int rebake_state = get_sdf_3d_rebake_state(&rebake->rebake);
+		if (rebake_state == 1) { return 0; }
+		if (rebake_state != 2)
+		{
+			fprintf(stderr, "Error: Unable to recalculate 3D SDF!\n");
+			return -1;
+		}
+
+		rebake->total_seconds += rebake->rebake.seconds;
+		if (submit_sdf_3d_rebake_copy(device, rebake) != 0) { return -1; }
+		rebake->state = 2;
+	}
+
+	// Wait for the copy, without blocking the frame:
+	else if (rebake->state == 2)
+	{
+		VkResult fence_status = vkGetFenceStatus(device->logical_device, rebake->fence);
+		if (fence_status == VK_NOT_READY) { return 0; }
+		if (fence_status != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to copy recalculated 3D SDF!\n");
+			return -1;
+		}
+
+		rebake->frames_taken = rebake->frames_waited;
+		rebake->state = 3;
+	}
+
+	// Swap buffers when the animation reaches the parameter (or straight away if late):
+	if ((rebake->state == 3) && (rebake->frames_waited >= rebake->frames_ahead))
+	{
+		VkBuffer buffer				= descriptors->sdf_3d_buffer;
+		VkDeviceMemory memory			= descriptors->sdf_3d_memory;
+		VkDescriptorSet descriptor		= descriptors->sdf_3d_descriptor;
+		descriptors->sdf_3d_buffer		= rebake->spare_buffer;
+		descriptors->sdf_3d_memory		= rebake->spare_memory;
+		descriptors->sdf_3d_descriptor		= rebake->spare_descriptor;
+		rebake->spare_buffer			= buffer;
+		rebake->spare_memory			= memory;
+		rebake->spare_descriptor		= descriptor;
+
+		rebake->active_parameter = rebake->parameter;
+		rebake->num_swaps++;
+		rebake->state = 0;
+
+		// Aim further ahead next time if it was late, or closer if it was early:
+		rebake->frames_ahead = ((rebake->frames_taken * 5) / 4) + 2;
+	}
+
+	return 0;
+}
+
+// Record copying the staging buffer into the spare buffer, and submit it:
+int submit_sdf_3d_rebake_copy(FracRenderVulkanDevice *device,
+					FracRenderVulkanSDF3DRebake *rebake)
+{
+	// Begin command recording:
+	VkCommandBufferBeginInfo begin_info;
+	memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
+	begin_info.sType		= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.pNext		= NULL;
+	begin_info.flags		= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	begin_info.pInheritanceInfo	= NULL;
+
+	if (vkBeginCommandBuffer(rebake->command_buffer, &begin_info) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to begin recording commands for "
+						"3D SDF recalculation!\n");
+		return -1;
+	}
+
+	// The spare buffer was shown until recently. Wait for frames still reading it:
+	VkBufferMemoryBarrier buffer_barrier;
+	memset(&buffer_barrier, 0, sizeof(VkBufferMemoryBarrier));
+	buffer_barrier.sType			= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	buffer_barrier.pNext			= NULL;
+	buffer_barrier.srcAccessMask		= 0;
+	buffer_barrier.dstAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	buffer_barrier.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.buffer			= rebake->spare_buffer;
+	buffer_barrier.offset			= 0;
+	buffer_barrier.size			= VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(rebake->command_buffer,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 0, NULL, 1, &buffer_barrier, 0, NULL);
+
+	VkBufferCopy copy_region;
+	memset(&copy_region, 0, sizeof(VkBufferCopy));
+	copy_region.srcOffset	= 0;
+	copy_region.dstOffset	= 0;
+	copy_region.size	= rebake->size;
+
+	vkCmdCopyBuffer(rebake->command_buffer, rebake->staging_buffer, rebake->spare_buffer,
+								1, &copy_region);
+
+	// Make the copy visible to the geometry pass:
+	buffer_barrier.srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
+	buffer_barrier.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(rebake->command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 0, NULL, 1, &buffer_barrier, 0, NULL);
+
+	// Finish command recording:
+	if (vkEndCommandBuffer(rebake->command_buffer) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to stop recording commands for "
+						"3D SDF recalculation!\n");
+		return -1;
+	}
+
+	// Submit commands:
+	VkSubmitInfo submit_info;
+	memset(&submit_info, 0, sizeof(VkSubmitInfo));
+	submit_info.sType			= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.pNext			= NULL;
+	submit_info.waitSemaphoreCount		= 0;
+	submit_info.pWaitSemaphores		= NULL;
+	submit_info.pWaitDstStageMask		= NULL;
+	submit_info.commandBufferCount		= 1;
+	submit_info.pCommandBuffers		= &rebake->command_buffer;
+	submit_info.signalSemaphoreCount	= 0;
+	submit_info.pSignalSemaphores		= NULL;
+
+	if (vkResetFences(device->logical_device, 1, &rebake->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to reset fence for 3D SDF recalculation!\n");
+		return -1;
+	}
+
+	if (vkQueueSubmit(device->graphics_queue, 1, &submit_info, rebake->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to submit commands for 3D SDF recalculation!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Create the spare buffer and its descriptor set:
+int create_sdf_3d_rebake_spare(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanSDF3DRebake *rebake)
+{
+	// Define buffer creation info (same as the 3D SDF buffer):
+	VkBufferCreateInfo buffer_info;
+	memset(&buffer_info, 0, sizeof(VkBufferCreateInfo));
+	buffer_info.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_info.pNext			= NULL;
+	buffer_info.flags			= 0;
+	buffer_info.size			= rebake->size;
+	buffer_info.usage			= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+						VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	buffer_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
+	buffer_info.queueFamilyIndexCount	= 0;
+	buffer_info.pQueueFamilyIndices		= NULL;
+
+	if (vkCreateBuffer(device->logical_device, &buffer_info, NULL,
+				&rebake->spare_buffer) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create spare 3D SDF buffer!\n");
+		return -1;
+	}
+
+	// Get buffer memory requirements:
+	VkMemoryRequirements memory_requirements;
+	vkGetBufferMemoryRequirements(device->logical_device, rebake->spare_buffer,
+							&memory_requirements);
+
+	VkMemoryAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkMemoryAllocateInfo));
+	allocate_info.sType		= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate_info.pNext		= NULL;
+	allocate_info.allocationSize	= memory_requirements.size;
+
+	// Find suitable memory type for buffer:
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	vkGetPhysicalDeviceMemoryProperties(device->physical_device, &memory_properties);
+
+	VkMemoryPropertyFlags required_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	int success_flag = -1;
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+	{
+		if ((memory_requirements.memoryTypeBits & (1 << i)) &&
+			((memory_properties.memoryTypes[i].propertyFlags &
+			required_properties) == required_properties))
+		{
+			allocate_info.memoryTypeIndex = i;
+			success_flag = 0;
+			break;
+		}
+	}
+	if (success_flag != 0)
+	{
+		fprintf(stderr, "Error: No suitable memory type found for spare 3D SDF buffer!\n");
+		return -1;
+	}
+
+	// Allocate memory for buffer:
+	if (vkAllocateMemory(device->logical_device, &allocate_info, NULL,
+				&rebake->spare_memory) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for spare 3D SDF buffer!\n");
+		return -1;
+	}
+
+	// Bind buffer memory:
+	vkBindBufferMemory(device->logical_device, rebake->spare_buffer,
+						rebake->spare_memory, 0);
+
+	// Allocate descriptor set:
+	VkDescriptorSetAllocateInfo set_info;
+	memset(&set_info, 0, sizeof(VkDescriptorSetAllocateInfo));
+	set_info.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	set_info.pNext			= NULL;
+	set_info.descriptorPool		= descriptors->descriptor_pool;
+	set_info.descriptorSetCount	= 1;
+	set_info.pSetLayouts		= &descriptors->sdf_3d_descriptor_layout;
+
+	if (vkAllocateDescriptorSets(device->logical_device, &set_info,
+			&rebake->spare_descriptor) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to allocate spare 3D SDF descriptor set!\n");
+		return -1;
+	}
+
+	// Create descriptor set:
+	VkDescriptorBufferInfo sdf_buffer_info;
+	memset(&sdf_buffer_info, 0, sizeof(VkDescriptorBufferInfo));
+	sdf_buffer_info.buffer	= rebake->spare_buffer;
+	sdf_buffer_info.offset	= 0;
+	sdf_buffer_info.range	= VK_WHOLE_SIZE;
+
+	VkWriteDescriptorSet descriptor_write[1];
+	memset(descriptor_write, 0, 1 * sizeof(VkWriteDescriptorSet));
+	descriptor_write[0].sType		= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptor_write[0].pNext		= NULL;
+	descriptor_write[0].dstSet		= rebake->spare_descriptor;
+	descriptor_write[0].dstBinding		= 0;
+	descriptor_write[0].dstArrayElement	= 0;
+	descriptor_write[0].descriptorCount	= 1;
+	descriptor_write[0].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descriptor_write[0].pImageInfo		= NULL;
+	descriptor_write[0].pBufferInfo		= &sdf_buffer_info;
+	descriptor_write[0].pTexelBufferView	= NULL;
+
+	vkUpdateDescriptorSets(device->logical_device, 1, descriptor_write, 0, NULL);
+
+	return 0;
+}
+
+// Create a persistently mapped staging buffer, for the CPU to calculate 3D SDF voxels into:
+int create_sdf_3d_staging_buffer(FracRenderVulkanDevice *device, VkDeviceSize size,
+			VkBuffer *buffer, VkDeviceMemory *memory, void **data)
+{
+	VkBufferCreateInfo buffer_info;
+	memset(&buffer_info, 0, sizeof(VkBufferCreateInfo));
+	buffer_info.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_info.pNext			= NULL;
+	buffer_info.flags			= 0;
+	buffer_info.size			= size;
+	buffer_info.usage			= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	buffer_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
+	buffer_info.queueFamilyIndexCount	= 0;
+	buffer_info.pQueueFamilyIndices		= NULL;
+
+	if (vkCreateBuffer(device->logical_device, &buffer_info, NULL, buffer) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create 3D SDF staging buffer!\n");
+		return -1;
+	}
+
+	VkMemoryRequirements memory_requirements;
+	vkGetBufferMemoryRequirements(device->logical_device, *buffer, &memory_requirements);
+
+	VkMemoryAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkMemoryAllocateInfo));
+	allocate_info.sType		= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate_info.pNext		= NULL;
+	allocate_info.allocationSize	= memory_requirements.size;
+
+	// Host-visible and coherent, so the worker threads can write it directly:
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	vkGetPhysicalDeviceMemoryProperties(device->physical_device, &memory_properties);
+
+	VkMemoryPropertyFlags required_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+						VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	int success_flag = -1;
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+	{
+		if ((memory_requirements.memoryTypeBits & (1 << i)) &&
+			((memory_properties.memoryTypes[i].propertyFlags &
+			required_properties) == required_properties))
+		{
+			allocate_info.memoryTypeIndex = i;
+			success_flag = 0;
+			break;
+		}
+	}
+	if (success_flag != 0)
+	{
+		fprintf(stderr, "Error: No suitable memory type found for "
+						"3D SDF staging buffer!\n");
+		return -1;
+	}
+
+	if (vkAllocateMemory(device->logical_device, &allocate_info, NULL, memory) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for 3D SDF staging buffer!\n");
+		return -1;
+	}
+
+	vkBindBufferMemory(device->logical_device, *buffer, *memory, 0);
+
+	// Stays mapped until the buffer is destroyed:
+	if (vkMapMemory(device->logical_device, *memory, 0, size, 0, data) != VK_SUCCESS)
+	{
+		*data = NULL;
+		fprintf(stderr, "Error: Unable to map 3D SDF staging buffer!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Stop recalculating, and destroy the spare and staging buffers (after the device is idle):
+void destroy_vulkan_sdf_3d_rebake(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderVulkanSDF3DRebake *rebake)
+{
+	// Stop the worker threads first, as they write to the staging buffer:
+	stop_sdf_3d_rebake(&rebake->rebake);
+
+	if ((rebake->enabled == 1) && (rebake->num_swaps > 0))
+	{
+		printf("3D SDF recalculated %u times (%.3lf seconds each on average).\n\n",
+			rebake->num_swaps, rebake->total_seconds / rebake->num_swaps);
+	}
+
+	if (rebake->fence != VK_NULL_HANDLE)
+	{
+		vkDestroyFence(device->logical_device, rebake->fence, NULL);
+	}
+	if (rebake->command_buffer != VK_NULL_HANDLE)
+	{
+		vkFreeCommandBuffers(device->logical_device, commands->command_pool,
+						1, &rebake->command_buffer);
+	}
+	if (rebake->staging_data)
+	{
+		vkUnmapMemory(device->logical_device, rebake->staging_memory);
+	}
+	if (rebake->staging_buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(device->logical_device, rebake->staging_buffer, NULL);
+	}
+	if (rebake->staging_memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device->logical_device, rebake->staging_memory, NULL);
+	}
+
+	// The descriptor set is freed with the descriptor pool:
+	if (rebake->spare_buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(device->logical_device, rebake->spare_buffer, NULL);
+	}
+	if (rebake->spare_memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device->logical_device, rebake->spare_memory, NULL);
+	}
+
+	memset(rebake, 0, sizeof(FracRenderVulkanSDF3DRebake));
+}
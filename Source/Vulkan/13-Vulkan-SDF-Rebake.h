@@ -0,0 +1,108 @@
+#ifndef FRACRENDER_VULKAN_SDF_REBAKE_H
+#define FRACRENDER_VULKAN_SDF_REBAKE_H
+
+/*************************************************************************
+ * To keep the dense 3D SDF in step with the fractal parameter animation *
+ *************************************************************************/
+
+// Library includes:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Local includes:
+#include "../../Third-Party/volk/include/volk/volk.h"
+#include "01-Vulkan-Structs.h"
+#include "../SDF/SDF-3D.h"
+#include "../SDF/SDF-3D-Rebake.h"
+#include "../Utility/Animation.h"
+#include "../Utility/Program-State.h"
+
+/*
+ * The parameter animation changes the fractal every frame, but the 3D SDF is only calculated
+ * once, so the geometry pass would march through an SDF of a different fractal. Instead, the SDF
+ * is recalculated on CPU worker threads for the parameter the animation will reach a little
+ * ahead, into a mapped staging buffer. It is then copied into a spare buffer with its own
+ * descriptor set, and the two are swapped between frames once the animation gets there.
+ */
+
+// Frames ahead of the animation to calculate the first SDF for (afterwards this follows how
+// long recalculating actually takes):
+#define FRACRENDER_SDF_3D_REBAKE_FRAMES_AHEAD 30
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// Whether the SDF is recalculated at all:
+	int enabled;
+
+	// Background calculation on the CPU:
+	FracRenderSDF3DRebake rebake;
+
+	// Spare buffer and descriptor set, swapped with the ones being shown:
+	VkBuffer spare_buffer;
+	VkDeviceMemory spare_memory;
+	VkDescriptorSet spare_descriptor;
+
+	// Staging buffer the SDF is calculated into (persistently mapped):
+	VkBuffer staging_buffer;
+	VkDeviceMemory staging_memory;
+	void *staging_data;
+	VkDeviceSize size;
+
+	// Command buffer and fence for the copy:
+	VkCommandBuffer command_buffer;
+	VkFence fence;
+
+	// State. 0 = Idle, 1 = Calculating, 2 = Copying, 3 = Ready to swap:
+	int state;
+
+	// Parameter being calculated, and the one shown:
+	float parameter;
+	float active_parameter;
+
+	// Frames since the calculation started, frames it took to be ready, and frames ahead it
+	// is meant to be used:
+	uint64_t frames_waited;
+	uint64_t frames_taken;
+	uint64_t frames_ahead;
+
+	// Statistics:
+	uint32_t num_swaps;
+	double total_seconds;
+} FracRenderVulkanSDF3DRebake;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Set up recalculating the 3D SDF when the fractal parameter is animated:
+int initialize_vulkan_sdf_3d_rebake(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanCommands *commands,
+	FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d,
+					FracRenderVulkanSDF3DRebake *rebake);
+
+// Move the recalculation on by a frame, swapping in a new SDF when the animation reaches it:
+int update_vulkan_sdf_3d_rebake(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderProgramState *program_state,
+					FracRenderVulkanSDF3DRebake *rebake);
+
+// Record copying the staging buffer into the spare buffer, and submit it:
+int submit_sdf_3d_rebake_copy(FracRenderVulkanDevice *device,
+					FracRenderVulkanSDF3DRebake *rebake);
+
+// Create the spare buffer and its descriptor set:
+int create_sdf_3d_rebake_spare(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanSDF3DRebake *rebake);
+
+// Create a persistently mapped staging buffer, for the CPU to calculate 3D SDF voxels into:
+int create_sdf_3d_staging_buffer(FracRenderVulkanDevice *device, VkDeviceSize size,
+			VkBuffer *buffer, VkDeviceMemory *memory, void **data);
+
+// Stop recalculating, and destroy the spare and staging buffers (after the device is idle):
+void destroy_vulkan_sdf_3d_rebake(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderVulkanSDF3DRebake *rebake);
+
+#endif
@@ -0,0 +1,290 @@
+#include "14-Vulkan-SDF-Clipmap.h"
+
+// Set up moving the clipmap cascades with the camera:
+int initialize_vulkan_sdf_3d_clipmap(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderProgramState *program_state,
+			FracRenderSDF3D *sdf_3d, FracRenderVulkanSDF3DClipmap *clipmap)
+{
+	memset(clipmap, 0, sizeof(FracRenderVulkanSDF3DClipmap));
+	clipmap->enabled		= 0;
+	clipmap->staging_buffer		= VK_NULL_HANDLE;
+	clipmap->staging_memory		= VK_NULL_HANDLE;
+	clipmap->staging_data		= NULL;
+	clipmap->command_buffer		= VK_NULL_HANDLE;
+	clipmap->fence			= VK_NULL_HANDLE;
+	clipmap->state			= 0;
+
+	if ((program_state->optimize != 0) || (sdf_3d->layout != 2) || (!sdf_3d->voxels))
+	{
+		return 0;
+	}
+
+	printf("----------------------------------------");
+	printf("----------------------------------------\n");
+	printf("Initializing 3D SDF clipmap updates...\n");
+
+	set_up_sdf_3d_clipmap(sdf_3d, &clipmap->clipmap);
+	clipmap->size = get_sdf_3d_data_size(sdf_3d);
+
+	// Create staging buffer, starting with the voxels already uploaded:
+	printf(" ---> Creating staging buffer.\n");
+	if (create_sdf_3d_staging_buffer(device, clipmap->size, &clipmap->staging_buffer,
+			&clipmap->staging_memory, &clipmap->staging_data) != 0)
+	{
+		return -1;
+	}
+	memcpy(clipmap->staging_data, sdf_3d->voxels, clipmap->size);
+
+	// Allocate command buffer:
+	VkCommandBufferAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkCommandBufferAllocateInfo));
+	allocate_info.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocate_info.pNext			= NULL;
+	allocate_info.commandPool		= commands->command_pool;
+	allocate_info.level			= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount	= 1;
+
+	if (vkAllocateCommandBuffers(device->logical_device, &allocate_info,
+					&clipmap->command_buffer) != VK_SUCCESS)
+	{
+		clipmap->command_buffer = VK_NULL_HANDLE;
+		fprintf(stderr, "Error: Unable to allocate command buffer for "
+						"3D SDF clipmap updates!\n");
+		return -1;
+	}
+
+	// Create fence for submitting copies:
+	VkFenceCreateInfo fence_info;
+	memset(&fence_info, 0, sizeof(VkFenceCreateInfo));
+	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fence_info.pNext = NULL;
+	fence_info.flags = 0;
+
+	if (vkCreateFence(device->logical_device, &fence_info, NULL,
+					&clipmap->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create fence for 3D SDF clipmap updates!\n");
+		return -1;
+	}
+
+	clipmap->enabled = 1;
+
+	printf("      - Threads: %d.\n", clipmap->clipmap.sdf_3d.num_threads);
+	printf("      - Re-centred after: %d voxels.\n", (1 << sdf_3d->levels) /
+				FRACRENDER_SDF_3D_CLIPMAP_RECENTRE_FRACTION);
+	printf("... Done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Move the update on by a frame, starting one if the camera has moved far enough:
+int update_vulkan_sdf_3d_clipmap(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderProgramState *program_state,
+	FracRenderVulkanSceneUniform *scene_uniform, FracRenderVulkanSDF3DClipmap *clipmap)
+{
+	if (clipmap->enabled == 0) { return 0; }
+
+	// See if any cascade needs moving:
+	if (clipmap->state == 0)
+	{
+		int result = start_sdf_3d_clipmap_update(&clipmap->clipmap, clipmap->staging_data,
+							program_state->position);
+		if (result < 0) { return -1; }
+		if (result == 1) { clipmap->state = 1; }
+	}
+
+	// Copy changed cascades once calculated, and show them from the next frame:
+	else if (clipmap->state == 1)
+	{
+		int clipmap_state = get_sdf_3d_clipmap_state(&clipmap->clipmap);
+		if (clipmap_state == 1) { return 0; }
+		if (clipmap_state != 2)
+		{
+			fprintf(stderr, "Error: Unable to update 3D SDF clipmap!\n");
+			return -1;
+		}
+
+		if (submit_sdf_3d_clipmap_copy(device, descriptors, clipmap) != 0) { return -1; }
+
+		clipmap->num_updates++;
+		clipmap->total_voxels += clipmap->clipmap.update.num_voxels;
+		clipmap->total_seconds += clipmap->clipmap.seconds;
+
+		finish_sdf_3d_clipmap_update(&clipmap->clipmap);
+		set_sdf_3d_clipmap_uniform(&clipmap->clipmap.sdf_3d, scene_uniform);
+		clipmap->state = 2;
+	}
+
+	// Wait for the copy before touching the staging buffer again, without blocking the frame:
+	else if (clipmap->state == 2)
+	{
+		VkResult fence_status = vkGetFenceStatus(device->logical_device, clipmap->fence);
+		if (fence_status == VK_NOT_READY) { return 0; }
+		if (fence_status != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to copy 3D SDF clipmap cascades!\n");
+			return -1;
+		}
+
+		clipmap->state = 0;
+	}
+
+	return 0;
+}
+
+// Record copying the changed cascades into the 3D SDF buffer, and submit it:
+int submit_sdf_3d_clipmap_copy(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanSDF3DClipmap *clipmap)
+{
+	// Begin command recording:
+	VkCommandBufferBeginInfo begin_info;
+	memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
+	begin_info.sType		= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.pNext		= NULL;
+	begin_info.flags		= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	begin_info.pInheritanceInfo	= NULL;
+
+	if (vkBeginCommandBuffer(clipmap->command_buffer, &begin_info) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to begin recording commands for "
+						"3D SDF clipmap update!\n");
+		return -1;
+	}
+
+	// Frames already submitted still read the old voxels. Wait for them:
+	VkBufferMemoryBarrier buffer_barrier;
+	memset(&buffer_barrier, 0, sizeof(VkBufferMemoryBarrier));
+	buffer_barrier.sType			= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	buffer_barrier.pNext			= NULL;
+	buffer_barrier.srcAccessMask		= 0;
+	buffer_barrier.dstAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	buffer_barrier.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.buffer			= descriptors->sdf_3d_buffer;
+	buffer_barrier.offset			= 0;
+	buffer_barrier.size			= VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(clipmap->command_buffer,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 0, NULL, 1, &buffer_barrier, 0, NULL);
+
+	// Each cascade is one contiguous range. Copy the whole of each changed one:
+	FracRenderSDF3D *sdf_3d = &clipmap->clipmap.sdf_3d;
+	VkDeviceSize cascade_size = clipmap->size / sdf_3d->num_cascades;
+	VkBufferCopy copy_regions[FRACRENDER_SDF_3D_CLIPMAP_CASCADES];
+	memset(copy_regions, 0, FRACRENDER_SDF_3D_CLIPMAP_CASCADES * sizeof(VkBufferCopy));
+	uint32_t num_regions = 0;
+	for (uint32_t i = 0; i < sdf_3d->num_cascades; i++)
+	{
+		if ((clipmap->clipmap.update.changed_cascades & (1u << i)) == 0) { continue; }
+
+		copy_regions[num_regions].srcOffset	= i * cascade_size;
+		copy_regions[num_regions].dstOffset	= i * cascade_size;
+		copy_regions[num_regions].size		= cascade_size;
+		num_regions++;
+	}
+
+	vkCmdCopyBuffer(clipmap->command_buffer, clipmap->staging_buffer,
+			descriptors->sdf_3d_buffer, num_regions, copy_regions);
+
+	// Make the copy visible to the geometry pass:
+	buffer_barrier.srcAccessMask	= VK_ACCESS_TRANSFER_WRITE_BIT;
+	buffer_barrier.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(clipmap->command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 0, NULL, 1, &buffer_barrier, 0, NULL);
+
+	// Finish command recording:
+	if (vkEndCommandBuffer(clipmap->command_buffer) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to stop recording commands for "
+						"3D SDF clipmap update!\n");
+		return -1;
+	}
+
+	// Submit commands:
+	VkSubmitInfo submit_info;
+	memset(&submit_info, 0, sizeof(VkSubmitInfo));
+	submit_info.sType			= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.pNext			= NULL;
+	submit_info.waitSemaphoreCount		= 0;
+	submit_info.pWaitSemaphores		= NULL;
+	submit_info.pWaitDstStageMask		= NULL;
+	submit_info.commandBufferCount		= 1;
+	submit_info.pCommandBuffers		= &clipmap->command_buffer;
+	submit_info.signalSemaphoreCount	= 0;
+	submit_info.pSignalSemaphores		= NULL;
+
+	if (vkResetFences(device->logical_device, 1, &clipmap->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to reset fence for 3D SDF clipmap update!\n");
+		return -1;
+	}
+
+	if (vkQueueSubmit(device->graphics_queue, 1, &submit_info, clipmap->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to submit commands for 3D SDF clipmap update!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Put the cascade windows in the scene uniform:
+void set_sdf_3d_clipmap_uniform(FracRenderSDF3D *sdf_3d,
+				FracRenderVulkanSceneUniform *scene_uniform)
+{
+	// Rays are clipped to the biggest cascade:
+	scene_uniform->sdf_3d_centre		= sdf_3d->centre;
+	scene_uniform->sdf_3d_num_cascades	= sdf_3d->num_cascades;
+	memset(scene_uniform->sdf_3d_cascades, 0, sizeof(scene_uniform->sdf_3d_cascades));
+	for (uint32_t i = 0; i < sdf_3d->num_cascades; i++)
+	{
+		scene_uniform->sdf_3d_cascades[i][0] = sdf_3d->cascades[i].origin[0];
+		scene_uniform->sdf_3d_cascades[i][1] = sdf_3d->cascades[i].origin[1];
+		scene_uniform->sdf_3d_cascades[i][2] = sdf_3d->cascades[i].origin[2];
+	}
+}
+
+// Stop updating, and destroy the staging buffer (after the device is idle):
+void destroy_vulkan_sdf_3d_clipmap(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderVulkanSDF3DClipmap *clipmap)
+{
+	// Stop the worker threads first, as they write to the staging buffer:
+	stop_sdf_3d_clipmap(&clipmap->clipmap);
+
+	if ((clipmap->enabled == 1) && (clipmap->num_updates > 0))
+	{
+		printf("3D SDF clipmap moved %u times (%.0lf voxels and %.3lf seconds each on "
+			"average).\n\n", clipmap->num_updates,
+			(double)clipmap->total_voxels / clipmap->num_updates,
+			clipmap->total_seconds / clipmap->num_updates);
+	}
+
+	if (clipmap->fence != VK_NULL_HANDLE)
+	{
+		vkDestroyFence(device->logical_device, clipmap->fence, NULL);
+	}
+	if (clipmap->command_buffer != VK_NULL_HANDLE)
+	{
+		vkFreeCommandBuffers(device->logical_device, commands->command_pool,
+						1, &clipmap->command_buffer);
+	}
+	if (clipmap->staging_data)
+	{
+		vkUnmapMemory(device->logical_device, clipmap->staging_memory);
+	}
+	if (clipmap->staging_buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(device->logical_device, clipmap->staging_buffer, NULL);
+	}
+	if (clipmap->staging_memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device->logical_device, clipmap->staging_memory, NULL);
+	}
+
+	memset(clipmap, 0, sizeof(FracRenderVulkanSDF3DClipmap));
+}
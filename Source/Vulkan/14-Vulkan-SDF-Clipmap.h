@@ -0,0 +1,84 @@
+#ifndef FRACRENDER_VULKAN_SDF_CLIPMAP_H
+#define FRACRENDER_VULKAN_SDF_CLIPMAP_H
+
+/*******************************************************
+ * To move the 3D SDF clipmap cascades with the camera *
+ *******************************************************/
+
+// Library includes:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Local includes:
+#include "../../Third-Party/volk/include/volk/volk.h"
+#include "01-Vulkan-Structs.h"
+#include "13-Vulkan-SDF-Rebake.h"
+#include "../SDF/SDF-3D.h"
+#include "../SDF/SDF-3D-Clipmap.h"
+#include "../Utility/Program-State.h"
+
+/*
+ * Voxels a cascade's new window brings into view are calculated on CPU worker threads, straight
+ * into a persistently mapped staging buffer which holds a copy of the whole clipmap. The changed
+ * cascades are then copied into the 3D SDF buffer, and the scene uniform gets the new windows in
+ * the same frame, so the geometry pass never sees voxels and windows which don't match.
+ */
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// Whether the clipmap follows the camera at all:
+	int enabled;
+
+	// Background calculation on the CPU:
+	FracRenderSDF3DClipmap clipmap;
+
+	// Staging buffer holding a copy of all cascades (persistently mapped):
+	VkBuffer staging_buffer;
+	VkDeviceMemory staging_memory;
+	void *staging_data;
+	VkDeviceSize size;
+
+	// Command buffer and fence for the copy:
+	VkCommandBuffer command_buffer;
+	VkFence fence;
+
+	// State. 0 = Idle, 1 = Calculating, 2 = Copying:
+	int state;
+
+	// Statistics:
+	uint32_t num_updates;
+	uint64_t total_voxels;
+	double total_seconds;
+} FracRenderVulkanSDF3DClipmap;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Set up moving the clipmap cascades with the camera:
+int initialize_vulkan_sdf_3d_clipmap(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderProgramState *program_state,
+			FracRenderSDF3D *sdf_3d, FracRenderVulkanSDF3DClipmap *clipmap);
+
+// Move the update on by a frame, starting one if the camera has moved far enough:
+int update_vulkan_sdf_3d_clipmap(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderProgramState *program_state,
+	FracRenderVulkanSceneUniform *scene_uniform, FracRenderVulkanSDF3DClipmap *clipmap);
+
+// Record copying the changed cascades into the 3D SDF buffer, and submit it:
+int submit_sdf_3d_clipmap_copy(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanSDF3DClipmap *clipmap);
+
+// Put the cascade windows in the scene uniform:
+void set_sdf_3d_clipmap_uniform(FracRenderSDF3D *sdf_3d,
+				FracRenderVulkanSceneUniform *scene_uniform);
+
+// Stop updating, and destroy the staging buffer (after the device is idle):
+void destroy_vulkan_sdf_3d_clipmap(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderVulkanSDF3DClipmap *clipmap);
+
+#endif
@@ -0,0 +1,452 @@
+#include "15-Vulkan-SDF-Progressive.h"
+
+// Set up refining a coarse 3D SDF in the background:
+int initialize_vulkan_sdf_3d_progressive(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanCommands *commands,
+	FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d,
+				FracRenderVulkanSDF3DProgressive *progressive)
+{
+	memset(progressive, 0, sizeof(FracRenderVulkanSDF3DProgressive));
+	progressive->enabled		= 0;
+	progressive->next_buffer	= VK_NULL_HANDLE;
+	progressive->next_memory	= VK_NULL_HANDLE;
+	progressive->spare_descriptor	= VK_NULL_HANDLE;
+	progressive->retired_buffer	= VK_NULL_HANDLE;
+	progressive->retired_memory	= VK_NULL_HANDLE;
+	progressive->staging_buffer	= VK_NULL_HANDLE;
+	progressive->staging_memory	= VK_NULL_HANDLE;
+	progressive->staging_data	= NULL;
+	progressive->command_buffer	= VK_NULL_HANDLE;
+	progressive->fence		= VK_NULL_HANDLE;
+	progressive->state		= 0;
+
+	// Only if the SDF was started with fewer levels than asked for:
+	if ((program_state->optimize != 0) || (sdf_3d->final_levels <= sdf_3d->levels) ||
+		(sdf_3d->num_voxels == 0))
+	{
+		return 0;
+	}
+
+	printf("----------------------------------------");
+	printf("----------------------------------------\n");
+	printf("Initializing 3D SDF refinement...\n");
+
+	set_up_sdf_3d_rebake(sdf_3d, &progressive->rebake);
+	progressive->levels		= sdf_3d->levels;
+	progressive->final_levels	= sdf_3d->final_levels;
+	progressive->first_levels	= sdf_3d->levels;
+	progressive->cache		= program_state->sdf_cache;
+
+	// Staging buffer is sized for the last level, and reused for every level before it:
+	FracRenderSDF3D final_sdf_3d	= progressive->rebake.sdf_3d;
+	final_sdf_3d.levels		= progressive->final_levels;
+	final_sdf_3d.num_voxels		= 1u << (3 * progressive->final_levels);
+	progressive->size		= get_sdf_3d_data_size(&final_sdf_3d);
+
+	printf(" ---> Creating staging buffer.\n");
+	if (create_sdf_3d_staging_buffer(device, progressive->size, &progressive->staging_buffer,
+			&progressive->staging_memory, &progressive->staging_data) != 0)
+	{
+		return -1;
+	}
+
+	// Allocate spare descriptor set:
+	VkDescriptorSetAllocateInfo set_info;
+	memset(&set_info, 0, sizeof(VkDescriptorSetAllocateInfo));
+	set_info.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	set_info.pNext			= NULL;
+	set_info.descriptorPool		= descriptors->descriptor_pool;
+	set_info.descriptorSetCount	= 1;
+	set_info.pSetLayouts		= &descriptors->sdf_3d_descriptor_layout;
+
+	if (vkAllocateDescriptorSets(device->logical_device, &set_info,
+			&progressive->spare_descriptor) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to allocate spare 3D SDF descriptor set!\n");
+		return -1;
+	}
+
+	// Allocate command buffer:
+	VkCommandBufferAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkCommandBufferAllocateInfo));
+	allocate_info.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocate_info.pNext			= NULL;
+	allocate_info.commandPool		= commands->command_pool;
+	allocate_info.level			= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount	= 1;
+
+	if (vkAllocateCommandBuffers(device->logical_device, &allocate_info,
+					&progressive->command_buffer) != VK_SUCCESS)
+	{
+		progressive->command_buffer = VK_NULL_HANDLE;
+		fprintf(stderr, "Error: Unable to allocate command buffer for "
+						"3D SDF refinement!\n");
+		return -1;
+	}
+
+	// Create fence for submitting copies:
+	VkFenceCreateInfo fence_info;
+	memset(&fence_info, 0, sizeof(VkFenceCreateInfo));
+	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fence_info.pNext = NULL;
+	fence_info.flags = 0;
+
+	if (vkCreateFence(device->logical_device, &fence_info, NULL,
+					&progressive->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create fence for 3D SDF refinement!\n");
+		return -1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &progressive->start_time);
+	progressive->enabled = 1;
+
+	printf("      - Threads: %d.\n", progressive->rebake.sdf_3d.num_threads);
+	printf("      - Levels: %u, refined to %u.\n", progressive->levels,
+						progressive->final_levels);
+	printf("      - Staging memory: %lu bytes (%lu MB).\n", progressive->size,
+						progressive->size / (1024 * 1024));
+	printf("... Done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Move the refinement on by a frame, swapping in the next level once it is copied:
+int update_vulkan_sdf_3d_progressive(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanSceneUniform *scene_uniform,
+				FracRenderVulkanSDF3DProgressive *progressive)
+{
+	if ((progressive->enabled == 0) || (progressive->state == 3)) { return 0; }
+
+	// Start calculating the next level:
+	if (progressive->state == 0)
+	{
+		FracRenderSDF3D *sdf_3d = &progressive->rebake.sdf_3d;
+		progressive->levels++;
+		sdf_3d->levels		= progressive->levels;
+		sdf_3d->num_voxels	= 1u << (3 * progressive->levels);
+
+		if (start_sdf_3d_rebake(&progressive->rebake, progressive->staging_data,
+							sdf_3d->parameter) != 0)
+		{
+			return -1;
+		}
+		progressive->state = 1;
+	}
+
+	// Copy it to a new buffer once calculated:
+	else if (progressive->state == 1)
+	{
+		int rebake_state = get_sdf_3d_rebake_state(&progressive->rebake);
+		if (rebake_state == 1) { return 0; }
+		if (rebake_state != 2)
+		{
+			fprintf(stderr, "Error: Unable to refine 3D SDF!\n");
+			return -1;
+		}
+
+		// Save the last level for next time, while it is still in the staging buffer:
+		if ((progressive->levels == progressive->final_levels) && (progressive->cache == 1))
+		{
+			save_sdf_3d_cache(&progressive->rebake.sdf_3d);
+		}
+
+		if (submit_sdf_3d_progressive_copy(device, progressive) != 0) { return -1; }
+		progressive->state = 2;
+	}
+
+	// Swap it in once copied, without blocking the frame:
+	else if (progressive->state == 2)
+	{
+		VkResult fence_status = vkGetFenceStatus(device->logical_device,
+								progressive->fence);
+		if (fence_status == VK_NOT_READY) { return 0; }
+		if (fence_status != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to copy refined 3D SDF!\n");
+			return -1;
+		}
+
+		// Frames reading the buffer shown before the last swap came before the copy:
+		destroy_sdf_3d_progressive_retired(device, progressive);
+		swap_sdf_3d_progressive_buffers(device, descriptors, scene_uniform, progressive);
+
+		if (progressive->levels < progressive->final_levels) { progressive->state = 0; }
+		else
+		{
+			struct timespec end_time;
+			clock_gettime(CLOCK_MONOTONIC, &end_time);
+			progressive->final_seconds =
+				(double)(end_time.tv_sec - progressive->start_time.tv_sec) +
+				((double)(end_time.tv_nsec - progressive->start_time.tv_nsec) /
+										1000000000.0);
+			progressive->state = 3;
+		}
+	}
+
+	return 0;
+}
+
+// Create the buffer for the next level, record copying the staging buffer into it, and submit:
+int submit_sdf_3d_progressive_copy(FracRenderVulkanDevice *device,
+				FracRenderVulkanSDF3DProgressive *progressive)
+{
+	VkDeviceSize size = get_sdf_3d_data_size(&progressive->rebake.sdf_3d);
+
+	// Define buffer creation info (same as the 3D SDF buffer):
+	VkBufferCreateInfo buffer_info;
+	memset(&buffer_info, 0, sizeof(VkBufferCreateInfo));
+	buffer_info.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_info.pNext			= NULL;
+	buffer_info.flags			= 0;
+	buffer_info.size			= size;
+	buffer_info.usage			= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+						VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	buffer_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
+	buffer_info.queueFamilyIndexCount	= 0;
+	buffer_info.pQueueFamilyIndices		= NULL;
+
+	if (vkCreateBuffer(device->logical_device, &buffer_info, NULL,
+				&progressive->next_buffer) != VK_SUCCESS)
+	{
+		progressive->next_buffer = VK_NULL_HANDLE;
+		fprintf(stderr, "Error: Unable to create refined 3D SDF buffer!\n");
+		return -1;
+	}
+
+	// Get buffer memory requirements:
+	VkMemoryRequirements memory_requirements;
+	vkGetBufferMemoryRequirements(device->logical_device, progressive->next_buffer,
+							&memory_requirements);
+
+	VkMemoryAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkMemoryAllocateInfo));
+	allocate_info.sType		= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate_info.pNext		= NULL;
+	allocate_info.allocationSize	= memory_requirements.size;
+
+	// Find suitable memory type for buffer:
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	vkGetPhysicalDeviceMemoryProperties(device->physical_device, &memory_properties);
+
+	VkMemoryPropertyFlags required_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	int success_flag = -1;
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+	{
+		if ((memory_requirements.memoryTypeBits & (1 << i)) &&
+			((memory_properties.memoryTypes[i].propertyFlags &
+			required_properties) == required_properties))
+		{
+			allocate_info.memoryTypeIndex = i;
+			success_flag = 0;
+			break;
+		}
+	}
+	if (success_flag != 0)
+	{
+		fprintf(stderr, "Error: No suitable memory type found for "
+					"refined 3D SDF buffer!\n");
+		return -1;
+	}
+
+	// Allocate memory for buffer:
+	if (vkAllocateMemory(device->logical_device, &allocate_info, NULL,
+				&progressive->next_memory) != VK_SUCCESS)
+	{
+		progressive->next_memory = VK_NULL_HANDLE;
+		fprintf(stderr, "Error: Unable to allocate memory for refined 3D SDF buffer!\n");
+		return -1;
+	}
+
+	// Bind buffer memory:
+	vkBindBufferMemory(device->logical_device, progressive->next_buffer,
+						progressive->next_memory, 0);
+
+	// Begin command recording:
+	VkCommandBufferBeginInfo begin_info;
+	memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
+	begin_info.sType		= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.pNext		= NULL;
+	begin_info.flags		= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	begin_info.pInheritanceInfo	= NULL;
+
+	if (vkBeginCommandBuffer(progressive->command_buffer, &begin_info) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to begin recording commands for "
+						"3D SDF refinement!\n");
+		return -1;
+	}
+
+	// Nothing has read the new buffer yet, so only the copy needs to be made visible:
+	VkBufferCopy copy_region;
+	memset(&copy_region, 0, sizeof(VkBufferCopy));
+	copy_region.srcOffset	= 0;
+	copy_region.dstOffset	= 0;
+	copy_region.size	= size;
+
+	vkCmdCopyBuffer(progressive->command_buffer, progressive->staging_buffer,
+					progressive->next_buffer, 1, &copy_region);
+
+	VkBufferMemoryBarrier buffer_barrier;
+	memset(&buffer_barrier, 0, sizeof(VkBufferMemoryBarrier));
+	buffer_barrier.sType			= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	buffer_barrier.pNext			= NULL;
+	buffer_barrier.srcAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	buffer_barrier.dstAccessMask		= VK_ACCESS_SHADER_READ_BIT;
+	buffer_barrier.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.buffer			= progressive->next_buffer;
+	buffer_barrier.offset			= 0;
+	buffer_barrier.size			= VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(progressive->command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 0, NULL, 1, &buffer_barrier, 0, NULL);
+
+	// Finish command recording:
+	if (vkEndCommandBuffer(progressive->command_buffer) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to stop recording commands for "
+						"3D SDF refinement!\n");
+		return -1;
+	}
+
+	// Submit commands:
+	VkSubmitInfo submit_info;
+	memset(&submit_info, 0, sizeof(VkSubmitInfo));
+	submit_info.sType			= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.pNext			= NULL;
+	submit_info.waitSemaphoreCount		= 0;
+	submit_info.pWaitSemaphores		= NULL;
+	submit_info.pWaitDstStageMask		= NULL;
+	submit_info.commandBufferCount		= 1;
+	submit_info.pCommandBuffers		= &progressive->command_buffer;
+	submit_info.signalSemaphoreCount	= 0;
+	submit_info.pSignalSemaphores		= NULL;
+
+	if (vkResetFences(device->logical_device, 1, &progressive->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to reset fence for 3D SDF refinement!\n");
+		return -1;
+	}
+
+	if (vkQueueSubmit(device->graphics_queue, 1, &submit_info,
+					progressive->fence) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to submit commands for 3D SDF refinement!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Point the spare descriptor set at the next level's buffer, and swap it with the one shown:
+void swap_sdf_3d_progressive_buffers(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanSceneUniform *scene_uniform,
+				FracRenderVulkanSDF3DProgressive *progressive)
+{
+	// The spare set was last shown before the previous swap, so no frame is still using it:
+	VkDescriptorBufferInfo sdf_buffer_info;
+	memset(&sdf_buffer_info, 0, sizeof(VkDescriptorBufferInfo));
+	sdf_buffer_info.buffer	= progressive->next_buffer;
+	sdf_buffer_info.offset	= 0;
+	sdf_buffer_info.range	= VK_WHOLE_SIZE;
+
+	VkWriteDescriptorSet descriptor_write[1];
+	memset(descriptor_write, 0, 1 * sizeof(VkWriteDescriptorSet));
+	descriptor_write[0].sType		= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptor_write[0].pNext		= NULL;
+	descriptor_write[0].dstSet		= progressive->spare_descriptor;
+	descriptor_write[0].dstBinding		= 0;
+	descriptor_write[0].dstArrayElement	= 0;
+	descriptor_write[0].descriptorCount	= 1;
+	descriptor_write[0].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descriptor_write[0].pImageInfo		= NULL;
+	descriptor_write[0].pBufferInfo		= &sdf_buffer_info;
+	descriptor_write[0].pTexelBufferView	= NULL;
+
+	vkUpdateDescriptorSets(device->logical_device, 1, descriptor_write, 0, NULL);
+
+	// Swap, keeping the old buffer until frames reading it have finished:
+	VkDescriptorSet descriptor		= descriptors->sdf_3d_descriptor;
+	progressive->retired_buffer		= descriptors->sdf_3d_buffer;
+	progressive->retired_memory		= descriptors->sdf_3d_memory;
+	descriptors->sdf_3d_buffer		= progressive->next_buffer;
+	descriptors->sdf_3d_memory		= progressive->next_memory;
+	descriptors->sdf_3d_descriptor		= progressive->spare_descriptor;
+	descriptors->sdf_3d_memory_mapped	= 0;
+	progressive->spare_descriptor		= descriptor;
+	progressive->next_buffer		= VK_NULL_HANDLE;
+	progressive->next_memory		= VK_NULL_HANDLE;
+
+	// Shown from the next frame, along with the new buffer:
+	scene_uniform->sdf_3d_levels = progressive->levels;
+}
+
+// Destroy the buffer shown before the last swap:
+void destroy_sdf_3d_progressive_retired(FracRenderVulkanDevice *device,
+				FracRenderVulkanSDF3DProgressive *progressive)
+{
+	if (progressive->retired_buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(device->logical_device, progressive->retired_buffer, NULL);
+		progressive->retired_buffer = VK_NULL_HANDLE;
+	}
+	if (progressive->retired_memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device->logical_device, progressive->retired_memory, NULL);
+		progressive->retired_memory = VK_NULL_HANDLE;
+	}
+}
+
+// Stop refining, and destroy the buffers (after the device is idle):
+void destroy_vulkan_sdf_3d_progressive(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderVulkanSDF3DProgressive *progressive)
+{
+	// Stop the worker threads first, as they write to the staging buffer:
+	stop_sdf_3d_rebake(&progressive->rebake);
+
+	if ((progressive->enabled == 1) && (progressive->state == 3))
+	{
+		printf("3D SDF refined from %u to %u levels (%.3lf seconds).\n\n",
+			progressive->first_levels, progressive->final_levels,
+						progressive->final_seconds);
+	}
+
+	if (progressive->fence != VK_NULL_HANDLE)
+	{
+		vkDestroyFence(device->logical_device, progressive->fence, NULL);
+	}
+	if (progressive->command_buffer != VK_NULL_HANDLE)
+	{
+		vkFreeCommandBuffers(device->logical_device, commands->command_pool,
+						1, &progressive->command_buffer);
+	}
+	if (progressive->staging_data)
+	{
+		vkUnmapMemory(device->logical_device, progressive->staging_memory);
+	}
+	if (progressive->staging_buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(device->logical_device, progressive->staging_buffer, NULL);
+	}
+	if (progressive->staging_memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device->logical_device, progressive->staging_memory, NULL);
+	}
+
+	// The descriptor set is freed with the descriptor pool:
+	destroy_sdf_3d_progressive_retired(device, progressive);
+	if (progressive->next_buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(device->logical_device, progressive->next_buffer, NULL);
+	}
+	if (progressive->next_memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device->logical_device, progressive->next_memory, NULL);
+	}
+
+	memset(progressive, 0, sizeof(FracRenderVulkanSDF3DProgressive));
+}
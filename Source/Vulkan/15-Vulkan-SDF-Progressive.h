@@ -0,0 +1,112 @@
+#ifndef FRACRENDER_VULKAN_SDF_PROGRESSIVE_H
+#define FRACRENDER_VULKAN_SDF_PROGRESSIVE_H
+
+/******************************************************************
+ * Dense 3D SDF shown coarse first, and refined in the background *
+ ******************************************************************/
+
+// Library includes:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Local includes:
+#include "../../Third-Party/volk/include/volk/volk.h"
+#include "01-Vulkan-Structs.h"
+#include "13-Vulkan-SDF-Rebake.h"
+#include "../SDF/SDF-3D.h"
+#include "../SDF/SDF-3D-Cache.h"
+#include "../SDF/SDF-3D-Rebake.h"
+#include "../Utility/Program-State.h"
+
+/*
+ * Calculating every level of the SDF before the first frame keeps the window blank for seconds.
+ * Instead, the SDF starts with a few levels, and each deeper level is calculated on CPU worker
+ * threads into a mapped staging buffer (sized for the last level). It is copied into a new
+ * buffer, which is written into the spare descriptor set, and the two are swapped between frames
+ * along with the levels in the scene uniform.
+ *
+ * The buffer shown before a swap is destroyed once the next copy has finished, as every frame
+ * which could still read it was submitted before that copy.
+ */
+
+/**************
+ * Structures *
+ **************/
+
+typedef struct {
+	// Whether the SDF is still being refined:
+	int enabled;
+
+	// Background calculation on the CPU (the SDF copy's levels go up by one each time):
+	FracRenderSDF3DRebake rebake;
+
+	// Levels being calculated, and levels to stop at:
+	uint32_t levels;
+	uint32_t final_levels;
+
+	// Buffer being copied into for the next level, and the spare descriptor set it goes in:
+	VkBuffer next_buffer;
+	VkDeviceMemory next_memory;
+	VkDescriptorSet spare_descriptor;
+
+	// Buffer shown before the last swap, until no frame can still be reading it:
+	VkBuffer retired_buffer;
+	VkDeviceMemory retired_memory;
+
+	// Staging buffer the SDF is calculated into (persistently mapped):
+	VkBuffer staging_buffer;
+	VkDeviceMemory staging_memory;
+	void *staging_data;
+	VkDeviceSize size;
+
+	// Command buffer and fence for the copy:
+	VkCommandBuffer command_buffer;
+	VkFence fence;
+
+	// State. 0 = Idle, 1 = Calculating, 2 = Copying, 3 = Finished:
+	int state;
+
+	// Whether to save the last level in the on-disk cache:
+	int cache;
+
+	// Statistics (time until the last level was shown, since initialization):
+	uint32_t first_levels;
+	struct timespec start_time;
+	double final_seconds;
+} FracRenderVulkanSDF3DProgressive;
+
+/***********************
+ * Function Prototypes *
+ ***********************/
+
+// Set up refining a coarse 3D SDF in the background:
+int initialize_vulkan_sdf_3d_progressive(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanCommands *commands,
+	FracRenderProgramState *program_state, FracRenderSDF3D *sdf_3d,
+				FracRenderVulkanSDF3DProgressive *progressive);
+
+// Move the refinement on by a frame, swapping in the next level once it is copied:
+int update_vulkan_sdf_3d_progressive(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanSceneUniform *scene_uniform,
+				FracRenderVulkanSDF3DProgressive *progressive);
+
+// Create the buffer for the next level, record copying the staging buffer into it, and submit:
+int submit_sdf_3d_progressive_copy(FracRenderVulkanDevice *device,
+				FracRenderVulkanSDF3DProgressive *progressive);
+
+// Point the spare descriptor set at the next level's buffer, and swap it with the one shown:
+void swap_sdf_3d_progressive_buffers(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanSceneUniform *scene_uniform,
+				FracRenderVulkanSDF3DProgressive *progressive);
+
+// Destroy the buffer shown before the last swap:
+void destroy_sdf_3d_progressive_retired(FracRenderVulkanDevice *device,
+				FracRenderVulkanSDF3DProgressive *progressive);
+
+// Stop refining, and destroy the buffers (after the device is idle):
+void destroy_vulkan_sdf_3d_progressive(FracRenderVulkanDevice *device,
+	FracRenderVulkanCommands *commands, FracRenderVulkanSDF3DProgressive *progressive);
+
+#endif
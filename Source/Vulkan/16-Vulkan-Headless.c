@@ -0,0 +1,315 @@
+#include "16-Vulkan-Headless.h"
+
+// Get seconds on the monotonic clock, in place of glfwGetTime:
+double get_headless_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (double)time.tv_sec + ((double)time.tv_nsec / 1000000000.0);
+}
+
+// Copy an offscreen image out and write it to a PPM file, once its frame has finished:
+int dump_headless_image(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
+		FracRenderVulkanCommands *commands, uint32_t frame_slot, uint32_t image_index,
+		uint64_t frame)
+{
+	// Wait for the frame (the fence stays signalled for the next frame using the slot):
+	if (vkWaitForFences(device->logical_device, 1, &commands->fences[frame_slot],
+						VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to wait for frame %lu to dump it!\n", frame);
+		return -1;
+	}
+
+	if ((mkdir(FRACRENDER_HEADLESS_DUMP_DIRECTORY, 0755) != 0) && (errno != EEXIST))
+	{
+		fprintf(stderr, "Error: Unable to create directory for frame dumps!\n");
+		return -1;
+	}
+
+	uint32_t width = swapchain->swapchain_extent.width;
+	uint32_t height = swapchain->swapchain_extent.height;
+	VkDeviceSize size = (VkDeviceSize)width * height * 4;
+
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	void *data = NULL;
+	VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+
+	int result = create_headless_dump_buffer(device, size, &buffer, &memory, &data);
+
+	// Allocate a command buffer for the copy:
+	if (result == 0)
+	{
+		VkCommandBufferAllocateInfo allocate_info;
+		memset(&allocate_info, 0, sizeof(VkCommandBufferAllocateInfo));
+		allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocate_info.pNext			= NULL;
+		allocate_info.commandPool		= commands->command_pool;
+		allocate_info.level			= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocate_info.commandBufferCount	= 1;
+
+		if (vkAllocateCommandBuffers(device->logical_device, &allocate_info,
+						&command_buffer) != VK_SUCCESS)
+		{
+			fprintf(stderr, "Error: Unable to allocate commands for frame dump!\n");
+			command_buffer = VK_NULL_HANDLE;
+			result = -1;
+		}
+	}
+
+	// Record the copy:
+	if (result == 0)
+	{
+		result = record_headless_dump(swapchain, image_index, buffer, command_buffer);
+	}
+
+	// Submit the copy and wait for it:
+	if (result == 0)
+	{
+		VkSubmitInfo submit_info;
+		memset(&submit_info, 0, sizeof(VkSubmitInfo));
+		submit_info.sType			= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submit_info.pNext			= NULL;
+		submit_info.waitSemaphoreCount		= 0;
+		submit_info.pWaitSemaphores		= NULL;
+		submit_info.pWaitDstStageMask		= NULL;
+		submit_info.commandBufferCount		= 1;
+		submit_info.pCommandBuffers		= &command_buffer;
+		submit_info.signalSemaphoreCount	= 0;
+		submit_info.pSignalSemaphores		= NULL;
+
+		if ((vkQueueSubmit(device->graphics_queue, 1, &submit_info,
+			VK_NULL_HANDLE) != VK_SUCCESS) ||
+			(vkQueueWaitIdle(device->graphics_queue) != VK_SUCCESS))
+		{
+			fprintf(stderr, "Error: Unable to submit commands for frame dump!\n");
+			result = -1;
+		}
+	}
+
+	// Write the file:
+	if (result == 0)
+	{
+		char file_name[256];
+		snprintf(file_name, sizeof(file_name), "%s/Frame-%06lu.ppm",
+				FRACRENDER_HEADLESS_DUMP_DIRECTORY, frame);
+		result = write_headless_ppm(file_name, data, width, height);
+		if (result == 0) { printf("Dumped frame %lu to %s.\n", frame, file_name); }
+	}
+
+	// Clean up:
+	if (command_buffer != VK_NULL_HANDLE)
+	{
+		vkFreeCommandBuffers(device->logical_device, commands->command_pool,
+								1, &command_buffer);
+	}
+	if (buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(device->logical_device, buffer, NULL);
+	}
+	if (memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device->logical_device, memory, NULL);
+	}
+
+	return result;
+}
+
+// Record the copy of an offscreen image into the dump buffer:
+int record_headless_dump(FracRenderVulkanSwapchain *swapchain, uint32_t image_index,
+					VkBuffer buffer, VkCommandBuffer command_buffer)
+{
+	VkCommandBufferBeginInfo begin_info;
+	memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
+	begin_info.sType		= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.pNext		= NULL;
+	begin_info.flags		= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	begin_info.pInheritanceInfo	= NULL;
+
+	if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to begin recording commands for frame dump!\n");
+		return -1;
+	}
+
+	// The colour pass left the image ready to copy from. Wait for its writes:
+	VkImageMemoryBarrier image_barrier;
+	memset(&image_barrier, 0, sizeof(VkImageMemoryBarrier));
+	image_barrier.sType 			= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	image_barrier.pNext			= NULL;
+	image_barrier.srcAccessMask		= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	image_barrier.dstAccessMask		= VK_ACCESS_TRANSFER_READ_BIT;
+	image_barrier.oldLayout			= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	image_barrier.newLayout			= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	image_barrier.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.image			= swapchain->swapchain_images[image_index];
+
+	image_barrier.subresourceRange.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+	image_barrier.subresourceRange.baseMipLevel	= 0;
+	image_barrier.subresourceRange.levelCount	= 1;
+	image_barrier.subresourceRange.baseArrayLayer	= 0;
+	image_barrier.subresourceRange.layerCount	= 1;
+
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL,
+		0, NULL, 1, &image_barrier);
+
+	// Tightly packed rows:
+	VkBufferImageCopy copy_info;
+	memset(&copy_info, 0, sizeof(VkBufferImageCopy));
+	copy_info.bufferOffset				= 0;
+	copy_info.bufferRowLength			= 0;
+	copy_info.bufferImageHeight			= 0;
+	copy_info.imageSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	copy_info.imageSubresource.mipLevel		= 0;
+	copy_info.imageSubresource.baseArrayLayer	= 0;
+	copy_info.imageSubresource.layerCount		= 1;
+	copy_info.imageExtent.width			= swapchain->swapchain_extent.width;
+	copy_info.imageExtent.height			= swapchain->swapchain_extent.height;
+	copy_info.imageExtent.depth			= 1;
+
+	vkCmdCopyImageToBuffer(command_buffer, swapchain->swapchain_images[image_index],
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &copy_info);
+
+	// Make the copy visible to the host:
+	VkBufferMemoryBarrier buffer_barrier;
+	memset(&buffer_barrier, 0, sizeof(VkBufferMemoryBarrier));
+	buffer_barrier.sType			= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	buffer_barrier.pNext			= NULL;
+	buffer_barrier.srcAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	buffer_barrier.dstAccessMask		= VK_ACCESS_HOST_READ_BIT;
+	buffer_barrier.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	buffer_barrier.buffer			= buffer;
+	buffer_barrier.offset			= 0;
+	buffer_barrier.size			= VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+		0, 0, NULL, 1, &buffer_barrier, 0, NULL);
+
+	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to stop recording commands for frame dump!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Create a host-visible buffer to copy an offscreen image into, and map it:
+int create_headless_dump_buffer(FracRenderVulkanDevice *device, VkDeviceSize size,
+			VkBuffer *buffer, VkDeviceMemory *memory, void **data)
+{
+	VkBufferCreateInfo buffer_info;
+	memset(&buffer_info, 0, sizeof(VkBufferCreateInfo));
+	buffer_info.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_info.pNext			= NULL;
+	buffer_info.flags			= 0;
+	buffer_info.size			= size;
+	buffer_info.usage			= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	buffer_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
+	buffer_info.queueFamilyIndexCount	= 0;
+	buffer_info.pQueueFamilyIndices		= NULL;
+
+	if (vkCreateBuffer(device->logical_device, &buffer_info, NULL, buffer) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create frame dump buffer!\n");
+		*buffer = VK_NULL_HANDLE;
+		return -1;
+	}
+
+	VkMemoryRequirements memory_requirements;
+	vkGetBufferMemoryRequirements(device->logical_device, *buffer, &memory_requirements);
+
+	VkMemoryAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkMemoryAllocateInfo));
+	allocate_info.sType		= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocate_info.pNext		= NULL;
+	allocate_info.allocationSize	= memory_requirements.size;
+
+	// Host-visible and coherent, so it can be read straight after the copy:
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	vkGetPhysicalDeviceMemoryProperties(device->physical_device, &memory_properties);
+
+	VkMemoryPropertyFlags required_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+						VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	int success_flag = -1;
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+	{
+		if ((memory_requirements.memoryTypeBits & (1 << i)) &&
+			((memory_properties.memoryTypes[i].propertyFlags &
+			required_properties) == required_properties))
+		{
+			allocate_info.memoryTypeIndex = i;
+			success_flag = 0;
+			break;
+		}
+	}
+	if (success_flag != 0)
+	{
+		fprintf(stderr, "Error: No suitable memory type found for frame dump buffer!\n");
+		return -1;
+	}
+
+	if (vkAllocateMemory(device->logical_device, &allocate_info, NULL, memory) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to allocate memory for frame dump buffer!\n");
+		*memory = VK_NULL_HANDLE;
+		return -1;
+	}
+
+	vkBindBufferMemory(device->logical_device, *buffer, *memory, 0);
+
+	// Unmapped when the memory is freed:
+	if (vkMapMemory(device->logical_device, *memory, 0, size, 0, data) != VK_SUCCESS)
+	{
+		*data = NULL;
+		fprintf(stderr, "Error: Unable to map frame dump buffer!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Write RGBA pixels to a binary PPM file:
+int write_headless_ppm(const char *file_name, const uint8_t *pixels, uint32_t width,
+								uint32_t height)
+{
+	FILE *file = fopen(file_name, "wb");
+	if (!file)
+	{
+		fprintf(stderr, "Error: Unable to open \"%s\" to dump frame!\n", file_name);
+		return -1;
+	}
+
+	fprintf(file, "P6\n%u %u\n255\n", width, height);
+
+	// One row at a time, without the alpha:
+	uint8_t *row = malloc((size_t)width * 3);
+	int result = 0;
+	for (uint32_t y = 0; (y < height) && (result == 0); y++)
+	{
+		const uint8_t *source = &pixels[(size_t)y * width * 4];
+		for (uint32_t x = 0; x < width; x++)
+		{
+			row[(x * 3)] = source[(x * 4)];
+			row[(x * 3) + 1] = source[(x * 4) + 1];
+			row[(x * 3) + 2] = source[(x * 4) + 2];
+		}
+		if (fwrite(row, 3, width, file) != width) { result = -1; }
+	}
+
+	free(row);
+	if ((fclose(file) != 0) || (result != 0))
+	{
+		fprintf(stderr, "Error: Unable to write frame dump \"%s\"!\n", file_name);
+		return -1;
+	}
+
+	return 0;
+}
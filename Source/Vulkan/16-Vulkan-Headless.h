@@ -0,0 +1,62 @@
+#ifndef FRACRENDER_VULKAN_HEADLESS_H
+#define FRACRENDER_VULKAN_HEADLESS_H
+
+/************************************************************
+ * Rendering without a window, and dumping frames to a file *
+ ************************************************************/
+
+// Library includes:
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+// Local includes:
+#include "../../Third-Party/volk/include/volk/volk.h"
+#include "01-Vulkan-Structs.h"
+
+/*
+ * Headless, the main loop has no window to close, events to poll or images to present. It
+ * renders into the offscreen images in turn (see 05-Vulkan-Swapchain.h), one frame per step,
+ * until the frames asked for are done or the performance measurements finish. Frame times come
+ * from the monotonic clock instead of GLFW's.
+ *
+ * Dumped frames are copied from their offscreen image into a host-visible buffer once the frame
+ * has finished, and written as binary PPM files (8-bit sRGB, alpha dropped). Dumping waits for
+ * the GPU, so frames around a dump are slower.
+ */
+
+// Frames rendered when nothing else stops the loop:
+#define FRACRENDER_HEADLESS_DEFAULT_FRAMES 1000
+
+// Where dumped frames go:
+#define FRACRENDER_HEADLESS_DUMP_DIRECTORY "./Frame-Dumps"
+
+/***********************
+ * Function Prototypes *
+************************/
+
+// Get seconds on the monotonic clock, in place of glfwGetTime:
+double get_headless_time();
+
+// Copy an offscreen image out and write it to a PPM file, once its frame has finished:
+int dump_headless_image(FracRenderVulkanDevice *device, FracRenderVulkanSwapchain *swapchain,
+		FracRenderVulkanCommands *commands, uint32_t frame_slot, uint32_t image_index,
+		uint64_t frame);
+
+// Record the copy of an offscreen image into the dump buffer:
+int record_headless_dump(FracRenderVulkanSwapchain *swapchain, uint32_t image_index,
+					VkBuffer buffer, VkCommandBuffer command_buffer);
+
+// Create a host-visible buffer to copy an offscreen image into, and map it:
+int create_headless_dump_buffer(FracRenderVulkanDevice *device, VkDeviceSize size,
+			VkBuffer *buffer, VkDeviceMemory *memory, void **data);
+
+// Write RGBA pixels to a binary PPM file:
+int write_headless_ppm(const char *file_name, const uint8_t *pixels, uint32_t width,
+								uint32_t height);
+
+#endif
@@ -0,0 +1,285 @@
+#include "17-Vulkan-Compute-Geometry.h"
+
+// Create the compute geometry pass's descriptor and pipeline (after creating the descriptors):
+int initialize_vulkan_compute_geometry(FracRenderVulkanDevice *device,
+	FracRenderVulkanFramebuffers *framebuffers, FracRenderVulkanDescriptors *descriptors,
+					FracRenderVulkanPipeline *pipeline)
+{
+	printf("----------------------------------------");
+	printf("----------------------------------------\n");
+	printf("Initializing Vulkan compute geometry pass...\n");
+
+	// Create G-buffer storage image descriptor layout:
+	printf(" ---> Creating G-buffer storage image descriptor layout.\n");
+	if (create_g_buffer_storage_descriptor_layout(device, descriptors) != 0)
+	{
+		return -1;
+	}
+
+	// Create G-buffer storage image descriptor:
+	printf(" ---> Creating G-buffer storage image descriptor.\n");
+	if (create_g_buffer_storage_descriptor(device, framebuffers, descriptors) != 0)
+	{
+		return -1;
+	}
+
+	// Create compute pipeline:
+	printf(" ---> Creating compute geometry pipeline (%dx%d pixel tiles).\n",
+		FRACRENDER_COMPUTE_GEOMETRY_TILE_SIZE, FRACRENDER_COMPUTE_GEOMETRY_TILE_SIZE);
+	if (create_compute_geometry_pipeline(device, descriptors, pipeline) != 0)
+	{
+		return -1;
+	}
+
+	printf("... Done.\n");
+	printf("----------------------------------------");
+	printf("----------------------------------------\n\n");
+
+	return 0;
+}
+
+// Destroy the compute geometry pass's descriptor layout, pipeline and shader module:
+void destroy_vulkan_compute_geometry(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline)
+{
+	printf(" ---> Destroying Vulkan compute geometry pass.\n");
+
+	// Destroy compute pipeline and layout:
+	if (pipeline->geometry_compute_pipeline != VK_NULL_HANDLE)
+	{
+		vkDestroyPipeline(device->logical_device,
+			pipeline->geometry_compute_pipeline, NULL);
+	}
+	if (pipeline->geometry_compute_pipeline_layout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(device->logical_device,
+			pipeline->geometry_compute_pipeline_layout, NULL);
+	}
+
+	// Destroy shader module:
+	if (pipeline->geometry_compute_shader != VK_NULL_HANDLE)
+	{
+		vkDestroyShaderModule(device->logical_device,
+			pipeline->geometry_compute_shader, NULL);
+	}
+
+	// Destroy G-buffer storage image descriptor layout (the set goes with the pool):
+	if (descriptors->g_buffer_storage_descriptor_layout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(device->logical_device,
+			descriptors->g_buffer_storage_descriptor_layout, NULL);
+	}
+}
+
+// Create G-buffer storage image descriptor layout:
+int create_g_buffer_storage_descriptor_layout(FracRenderVulkanDevice *device,
+				FracRenderVulkanDescriptors *descriptors)
+{
+	// Create array of descriptor set layout bindings:
+	VkDescriptorSetLayoutBinding bindings[1];
+	memset(bindings, 0, 1 * sizeof(VkDescriptorSetLayoutBinding));
+	bindings[0].binding		= 0;
+	bindings[0].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	bindings[0].descriptorCount	= 1;
+	bindings[0].stageFlags		= VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[0].pImmutableSamplers	= NULL;
+
+	// Create descriptor set layout:
+	VkDescriptorSetLayoutCreateInfo layout_info;
+	memset(&layout_info, 0, sizeof(VkDescriptorSetLayoutCreateInfo));
+	layout_info.sType		= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layout_info.pNext		= NULL;
+	layout_info.flags		= 0;
+	layout_info.bindingCount	= 1;
+	layout_info.pBindings		= bindings;
+
+	if (vkCreateDescriptorSetLayout(device->logical_device, &layout_info,
+		NULL, &descriptors->g_buffer_storage_descriptor_layout) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create G-buffer storage image descriptor set"
+								" layout!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Create G-buffer storage image descriptor:
+int create_g_buffer_storage_descriptor(FracRenderVulkanDevice *device,
+	FracRenderVulkanFramebuffers *framebuffers, FracRenderVulkanDescriptors *descriptors)
+{
+	// Allocate descriptor set:
+	VkDescriptorSetAllocateInfo allocate_info;
+	memset(&allocate_info, 0, sizeof(VkDescriptorSetAllocateInfo));
+	allocate_info.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocate_info.pNext			= NULL;
+	allocate_info.descriptorPool		= descriptors->descriptor_pool;
+	allocate_info.descriptorSetCount	= 1;
+	allocate_info.pSetLayouts		= &descriptors->g_buffer_storage_descriptor_layout;
+
+	if (vkAllocateDescriptorSets(device->logical_device, &allocate_info,
+			&descriptors->g_buffer_storage_descriptor) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to allocate G-buffer storage image descriptor"
+								" set!\n");
+		return -1;
+	}
+
+	// Write the G-buffer image into it:
+	update_g_buffer_storage_descriptor(device, framebuffers, descriptors);
+
+	return 0;
+}
+
+// Update G-buffer storage image descriptor (after recreating the G-buffer images):
+void update_g_buffer_storage_descriptor(FracRenderVulkanDevice *device,
+	FracRenderVulkanFramebuffers *framebuffers, FracRenderVulkanDescriptors *descriptors)
+{
+	// Storage images are written in the general layout:
+	VkDescriptorImageInfo image_info;
+	memset(&image_info, 0, sizeof(VkDescriptorImageInfo));
+	image_info.sampler	= VK_NULL_HANDLE;
+	image_info.imageView	= framebuffers->g_buffer_image_views[0];
+	image_info.imageLayout	= VK_IMAGE_LAYOUT_GENERAL;
+
+	// Create descriptor set writing info:
+	VkWriteDescriptorSet descriptor_write[1];
+	memset(descriptor_write, 0, 1 * sizeof(VkWriteDescriptorSet));
+	descriptor_write[0].sType		= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptor_write[0].pNext		= NULL;
+	descriptor_write[0].dstSet		= descriptors->g_buffer_storage_descriptor;
+	descriptor_write[0].dstBinding		= 0;
+	descriptor_write[0].dstArrayElement	= 0;
+	descriptor_write[0].descriptorCount	= 1;
+	descriptor_write[0].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	descriptor_write[0].pImageInfo		= &image_info;
+	descriptor_write[0].pBufferInfo		= NULL;
+	descriptor_write[0].pTexelBufferView	= NULL;
+
+	// Update the descriptor set:
+	vkUpdateDescriptorSets(device->logical_device, 1, descriptor_write, 0, NULL);
+}
+
+// Create compute pipeline for the geometry pass:
+int create_compute_geometry_pipeline(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline)
+{
+	// Load shader module:
+	pipeline->geometry_compute_shader = load_shader_module(device,
+				pipeline->geometry_compute_shader_path);
+	if (pipeline->geometry_compute_shader == VK_NULL_HANDLE)
+	{
+		return -1;
+	}
+
+	// Define pipeline layout creation info. Set 0 is the scene, set 1 the G-buffer image:
+	VkDescriptorSetLayout set_layouts[2] = {
+		descriptors->scene_descriptor_layout,
+		descriptors->g_buffer_storage_descriptor_layout
+	};
+
+	VkPipelineLayoutCreateInfo layout_info;
+	memset(&layout_info, 0, sizeof(VkPipelineLayoutCreateInfo));
+	layout_info.sType			= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layout_info.pNext			= NULL;
+	layout_info.flags			= 0;
+	layout_info.setLayoutCount		= 2;
+	layout_info.pSetLayouts			= set_layouts;
+	layout_info.pushConstantRangeCount	= 0;
+	layout_info.pPushConstantRanges		= NULL;
+
+	// Create the pipeline layout:
+	if (vkCreatePipelineLayout(device->logical_device, &layout_info, NULL,
+		&pipeline->geometry_compute_pipeline_layout) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create compute geometry pipeline layout!\n");
+		return -1;
+	}
+
+	// Define pipeline creation info:
+	VkComputePipelineCreateInfo pipeline_info;
+	memset(&pipeline_info, 0, sizeof(VkComputePipelineCreateInfo));
+	pipeline_info.sType			= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipeline_info.pNext			= NULL;
+	pipeline_info.flags			= 0;
+	pipeline_info.layout			= pipeline->geometry_compute_pipeline_layout;
+	pipeline_info.basePipelineHandle	= VK_NULL_HANDLE;
+	pipeline_info.basePipelineIndex		= -1;
+
+	pipeline_info.stage.sType		=
+				VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipeline_info.stage.pNext		= NULL;
+	pipeline_info.stage.flags		= 0;
+	pipeline_info.stage.stage		= VK_SHADER_STAGE_COMPUTE_BIT;
+	pipeline_info.stage.module		= pipeline->geometry_compute_shader;
+	pipeline_info.stage.pName		= "main";
+	pipeline_info.stage.pSpecializationInfo	= NULL;
+
+	// Create the pipeline:
+	if (vkCreateComputePipelines(device->logical_device, VK_NULL_HANDLE, 1,
+		&pipeline_info, NULL, &pipeline->geometry_compute_pipeline) != VK_SUCCESS)
+	{
+		fprintf(stderr, "Error: Unable to create compute geometry pipeline!\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+// Record the compute geometry pass, leaving the G-buffer ready for the colour pass to sample:
+void record_compute_geometry(FracRenderVulkanSwapchain *swapchain,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline,
+	FracRenderVulkanFramebuffers *framebuffers, VkCommandBuffer command_buffer,
+						uint32_t scene_offset)
+{
+	// Every pixel is written, so the last frame's contents can be dropped. The colour pass of
+	// the frame before has to finish reading first:
+	VkImageMemoryBarrier image_barrier;
+	memset(&image_barrier, 0, sizeof(VkImageMemoryBarrier));
+	image_barrier.sType 			= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	image_barrier.pNext			= NULL;
+	image_barrier.srcAccessMask		= 0;
+	image_barrier.dstAccessMask		= VK_ACCESS_SHADER_WRITE_BIT;
+	image_barrier.oldLayout			= VK_IMAGE_LAYOUT_UNDEFINED;
+	image_barrier.newLayout			= VK_IMAGE_LAYOUT_GENERAL;
+	image_barrier.srcQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.dstQueueFamilyIndex	= VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.image			= framebuffers->g_buffer_images[0];
+
+	image_barrier.subresourceRange.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+	image_barrier.subresourceRange.baseMipLevel	= 0;
+	image_barrier.subresourceRange.levelCount	= 1;
+	image_barrier.subresourceRange.baseArrayLayer	= 0;
+	image_barrier.subresourceRange.layerCount	= 1;
+
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 0, NULL, 0, NULL, 1, &image_barrier);
+
+	// Bind compute pipeline and descriptors:
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+					pipeline->geometry_compute_pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+		pipeline->geometry_compute_pipeline_layout, 0, 1,
+		&descriptors->scene_descriptor, 1, &scene_offset);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+		pipeline->geometry_compute_pipeline_layout, 1, 1,
+		&descriptors->g_buffer_storage_descriptor, 0, NULL);
+
+	// One workgroup per tile, with the last row and column of tiles cut off at the edges:
+	uint32_t num_groups_x = (swapchain->swapchain_extent.width +
+		FRACRENDER_COMPUTE_GEOMETRY_TILE_SIZE - 1) / FRACRENDER_COMPUTE_GEOMETRY_TILE_SIZE;
+	uint32_t num_groups_y = (swapchain->swapchain_extent.height +
+		FRACRENDER_COMPUTE_GEOMETRY_TILE_SIZE - 1) / FRACRENDER_COMPUTE_GEOMETRY_TILE_SIZE;
+	vkCmdDispatch(command_buffer, num_groups_x, num_groups_y, 1);
+
+	// Make shader writes visible to the colour pass:
+	image_barrier.srcAccessMask		= VK_ACCESS_SHADER_WRITE_BIT;
+	image_barrier.dstAccessMask		= VK_ACCESS_SHADER_READ_BIT;
+	image_barrier.oldLayout			= VK_IMAGE_LAYOUT_GENERAL;
+	image_barrier.newLayout			= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 0, NULL, 0, NULL, 1, &image_barrier);
+}
@@ -0,0 +1,69 @@
+#ifndef FRACRENDER_VULKAN_COMPUTE_GEOMETRY_H
+#define FRACRENDER_VULKAN_COMPUTE_GEOMETRY_H
+
+/************************************************************************
+ * To trace the geometry pass with a compute shader, in tiles of pixels *
+ ************************************************************************/
+
+// Library includes:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Local includes:
+#include "../../Third-Party/volk/include/volk/volk.h"
+#include "01-Vulkan-Structs.h"
+#include "07-Vulkan-Pipeline.h"
+
+/*
+ * Instead of drawing a fullscreen triangle into the G-buffer, the compute shader
+ * (Geometry-<Fractal>.comp) writes positions and iterations straight into the G-buffer image,
+ * as a storage image, with one workgroup per tile of pixels. The first invocation of a tile
+ * cone traces its centre ray, with the cone wide enough to take in every ray of the tile, and
+ * shares how far the cone got (and the steps it took) through shared memory. Every pixel of the
+ * tile then sphere traces from there, instead of from the eye.
+ *
+ * The image is moved to the general layout for the dispatch, and on to the shader read-only
+ * layout after it, so the colour pass samples it as before. Only the fractals without
+ * optimization have compute shaders.
+ */
+
+// Pixels along each side of a tile (the workgroup size in the compute shaders):
+#define FRACRENDER_COMPUTE_GEOMETRY_TILE_SIZE 8
+
+/***********************
+ * Function Prototypes *
+************************/
+
+// Create the compute geometry pass's descriptor and pipeline (after creating the descriptors):
+int initialize_vulkan_compute_geometry(FracRenderVulkanDevice *device,
+	FracRenderVulkanFramebuffers *framebuffers, FracRenderVulkanDescriptors *descriptors,
+					FracRenderVulkanPipeline *pipeline);
+
+// Destroy the compute geometry pass's descriptor layout, pipeline and shader module:
+void destroy_vulkan_compute_geometry(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline);
+
+// Create G-buffer storage image descriptor layout:
+int create_g_buffer_storage_descriptor_layout(FracRenderVulkanDevice *device,
+				FracRenderVulkanDescriptors *descriptors);
+
+// Create G-buffer storage image descriptor:
+int create_g_buffer_storage_descriptor(FracRenderVulkanDevice *device,
+	FracRenderVulkanFramebuffers *framebuffers, FracRenderVulkanDescriptors *descriptors);
+
+// Update G-buffer storage image descriptor (after recreating the G-buffer images):
+void update_g_buffer_storage_descriptor(FracRenderVulkanDevice *device,
+	FracRenderVulkanFramebuffers *framebuffers, FracRenderVulkanDescriptors *descriptors);
+
+// Create compute pipeline for the geometry pass:
+int create_compute_geometry_pipeline(FracRenderVulkanDevice *device,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline);
+
+// Record the compute geometry pass, leaving the G-buffer ready for the colour pass to sample:
+void record_compute_geometry(FracRenderVulkanSwapchain *swapchain,
+	FracRenderVulkanDescriptors *descriptors, FracRenderVulkanPipeline *pipeline,
+	FracRenderVulkanFramebuffers *framebuffers, VkCommandBuffer command_buffer,
+						uint32_t scene_offset);
+
+#endif